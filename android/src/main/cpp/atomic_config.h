@@ -0,0 +1,102 @@
+//
+// Configuration published by pointer swap and read without locks.
+//
+
+#ifndef ANDROID_ATOMIC_CONFIG_H
+#define ANDROID_ATOMIC_CONFIG_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Readers pin the current value for as long as a Snapshot lives, typically one frame, with two
+// atomic increments and a load. Writers copy the current value, edit the copy and swap it in.
+// Replaced values are freed once no reader is left, so a reader never sees a torn or freed value
+// and never waits on a writer.
+template<typename T>
+class AtomicConfig {
+public:
+    class Snapshot {
+    public:
+        Snapshot(Snapshot &&other) noexcept: owner_(other.owner_), value_(other.value_) {
+            other.owner_ = nullptr;
+        }
+
+        Snapshot(const Snapshot &) = delete;
+
+        Snapshot &operator=(const Snapshot &) = delete;
+
+        ~Snapshot() {
+            if (owner_ != nullptr)
+                owner_->unpin();
+        }
+
+        const T &operator*() const { return *value_; }
+
+        const T *operator->() const { return value_; }
+
+    private:
+        friend class AtomicConfig;
+
+        Snapshot(const AtomicConfig *owner, const T *value) : owner_(owner), value_(value) {}
+
+        const AtomicConfig *owner_;
+        const T *value_;
+    };
+
+    AtomicConfig() : current_(new T()) {}
+
+    AtomicConfig(const AtomicConfig &) = delete;
+
+    AtomicConfig &operator=(const AtomicConfig &) = delete;
+
+    ~AtomicConfig() {
+        delete current_.load();
+        for (T *value: retired_)
+            delete value;
+    }
+
+    Snapshot read() const {
+        // counted before loading, so a writer that sees no readers knows nobody holds an old value
+        readers_.fetch_add(1);
+        return Snapshot(this, current_.load());
+    }
+
+    // Publishes a copy of the current value changed by edit(T &).
+    template<typename Edit>
+    void update(Edit &&edit) {
+        std::lock_guard<std::mutex> guard(writer_);
+        T *next = new T(*current_.load());
+        edit(*next);
+        retired_.push_back(current_.exchange(next));
+        pending_.store(true);
+        reclaim();
+    }
+
+private:
+    void unpin() const {
+        // the last reader out frees what was replaced meanwhile, unless a writer is busy
+        if (readers_.fetch_sub(1) == 1 && pending_.load() && writer_.try_lock()) {
+            const_cast<AtomicConfig *>(this)->reclaim();
+            writer_.unlock();
+        }
+    }
+
+    // with writer_ held
+    void reclaim() {
+        if (readers_.load() != 0)
+            return;
+        for (T *value: retired_)
+            delete value;
+        retired_.clear();
+        pending_.store(false);
+    }
+
+    std::atomic<T *> current_;
+    mutable std::atomic<int> readers_{0};
+    std::atomic<bool> pending_{false};
+    mutable std::mutex writer_;
+    std::vector<T *> retired_;
+};
+
+#endif //ANDROID_ATOMIC_CONFIG_H
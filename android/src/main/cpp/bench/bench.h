@@ -0,0 +1,51 @@
+//
+// Tiny benchmark harness for the native core, host builds only.
+//
+
+#ifndef ANDROID_BENCH_H
+#define ANDROID_BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "perf_counters.h"
+
+// Runs `fn` `iterations` times after a short warm-up and prints the mean time per call, followed
+// by the hardware counters per call when they are available.
+template<typename Fn>
+static double run_benchmark(const char *name, int iterations, Fn fn) {
+    for (int i = 0; i < iterations / 10 + 1; i++)
+        fn();
+
+    PerfCounters &counters = PerfCounters::instance();
+    counters.start();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        fn();
+    auto end = std::chrono::steady_clock::now();
+    counters.stop();
+
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    std::string events = counters.format(iterations);
+    printf("%-48s %12.3f us%s%s\n", name, us, events.empty() ? "" : "  ", events.c_str());
+    return us;
+}
+
+// prevents the compiler from dropping results
+template<typename T>
+static inline void do_not_optimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void bench_log();
+
+void bench_postprocess();
+
+void bench_predictor();
+
+void bench_preprocess();
+
+void bench_reid();
+
+#endif //ANDROID_BENCH_H
@@ -0,0 +1,45 @@
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "detection_log.h"
+
+// Time added to a frame by logging its detections, including segment rotations.
+void bench_log() {
+    char directory[] = "/tmp/ultralytics_bench_log_XXXXXX";
+    if (mkdtemp(directory) == nullptr)
+        return;
+
+    const int counts[] = {1, 10, 30, 100};
+
+    printf("detection log append\n");
+    for (int count: counts) {
+        std::vector<DetectedObject> objects(count);
+        for (int i = 0; i < count; i++) {
+            objects[i].rect = Box(0.01f * i, 0.2f, 0.1f, 0.3f);
+            objects[i].index = i % 80;
+            objects[i].confidence = 0.5f;
+            objects[i].track_id = i;
+        }
+
+        DetectionLog log;
+        // small segments so rotations are part of the measurement
+        log.open(directory, 4096, 4);
+
+        uint32_t frame = 0;
+        char name[64];
+        snprintf(name, sizeof(name), "append objects=%d", count);
+        run_benchmark(name, 20000, [&]() {
+            log.append(frame, (int64_t) frame * 33333333, objects);
+            frame++;
+        });
+        log.close();
+    }
+
+    for (const std::string &segment: DetectionLogReader::segments(directory))
+        unlink(segment.c_str());
+    rmdir(directory);
+}
@@ -0,0 +1,27 @@
+#include <cstring>
+
+#include "bench.h"
+#include "cpu_features.h"
+
+int main(int argc, char **argv) {
+    // optional filter, runs the suites whose name contains it
+    const char *filter = argc > 1 ? argv[1] : "";
+    // ULTRALYTICS_CPU_BASELINE=1 measures the baseline kernels
+    printf("cpu extensions: %s\n", cpu_extensions_string().c_str());
+    const PerfCounters &counters = PerfCounters::instance();
+    if (!counters.any_available())
+        printf("perf counters: unavailable, %s\n", counters.error().c_str());
+
+    if (strstr("log", filter))
+        bench_log();
+    if (strstr("postprocess", filter))
+        bench_postprocess();
+    if (strstr("predictor", filter))
+        bench_predictor();
+    if (strstr("preprocess", filter))
+        bench_preprocess();
+    if (strstr("reid", filter))
+        bench_reid();
+
+    return 0;
+}
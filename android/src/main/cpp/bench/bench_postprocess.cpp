@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <vector>
+
+#include "bench.h"
+#include "postprocess.h"
+
+// A [4 + classes][anchors] output where `hits` anchors pass a 0.25 threshold, in clusters of five
+// overlapping boxes of one class, and every other score is below it.
+static std::vector<float> synthetic_output(int anchors, int classes, int hits) {
+    std::vector<float> output((size_t) (4 + classes) * anchors, 0.f);
+    uint32_t state = 12345;
+    auto random = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.f / 16777216.f);
+    };
+
+    for (int i = 0; i < anchors; i++) {
+        output[i] = random();
+        output[anchors + i] = random();
+        output[2 * anchors + i] = 0.05f + 0.1f * random();
+        output[3 * anchors + i] = 0.05f + 0.1f * random();
+        for (int c = 0; c < classes; c++)
+            output[(size_t) (4 + c) * anchors + i] = 0.2f * random();
+    }
+
+    int step = anchors / hits;
+    for (int h = 0; h < hits; h++) {
+        int i = h * step;
+        int first = h / 5 * 5 * step;
+        output[i] = output[first] + 0.005f * (h % 5);
+        output[anchors + i] = output[anchors + first];
+        output[2 * anchors + i] = output[2 * anchors + first];
+        output[3 * anchors + i] = output[3 * anchors + first];
+        output[(size_t) (4 + (h / 5) % classes) * anchors + i] = 0.3f + 0.6f * random();
+    }
+    return output;
+}
+
+// Generic against specialized decoding for each class count with a specialized decoder.
+static void bench_decode_kernels(int anchors) {
+    const int class_counts[] = {1, 2, 80, 365, 600};
+
+    printf("decode kernels anchors=%d proposals=1000\n", anchors);
+    for (int classes: class_counts) {
+        std::vector<float> output = synthetic_output(anchors, classes, 1000);
+        Detections proposals;
+        double us[2];
+        for (int specialized = 0; specialized < 2; specialized++) {
+            DecodeKernel kernel = decode_kernel(classes, specialized != 0);
+            char name[64];
+            snprintf(name, sizeof(name), "decode classes=%d %s", classes, specialized ? "specialized" : "generic");
+            us[specialized] = run_benchmark(name, classes > 100 ? 50 : 200, [&]() {
+                proposals.clear();
+                kernel(output.data(), anchors, classes, 0.25f, nullptr, proposals);
+            });
+        }
+        printf("%-48s %12.2f x\n", "  speedup", us[0] / us[1]);
+    }
+}
+
+// Decoding and NMS of a 640 input, 80 class model as the number of proposals grows.
+void bench_postprocess() {
+    const int anchors = 8400;
+    const int classes = 80;
+    const int hits[] = {100, 1000, 5000};
+
+    printf("postprocess anchors=%d classes=%d\n", anchors, classes);
+    for (int count: hits) {
+        std::vector<float> output = synthetic_output(anchors, classes, count);
+        Detections proposals;
+        Detections selected;
+        PostprocessConfig config;
+        config.max_detections = 100;
+
+        char name[64];
+        snprintf(name, sizeof(name), "decode proposals=%d", count);
+        run_benchmark(name, 200, [&]() {
+            proposals.clear();
+            generate_proposals(output.data(), anchors, classes, config.confidence_threshold, nullptr, proposals);
+        });
+
+        for (NmsMode mode: {NMS_AGNOSTIC, NMS_PER_CLASS}) {
+            config.nms_mode = mode;
+            snprintf(name, sizeof(name), "select proposals=%d %s", count,
+                     mode == NMS_AGNOSTIC ? "agnostic" : "per class");
+            run_benchmark(name, 200, [&]() {
+                select_detections(proposals, config, selected);
+                do_not_optimize(selected.size());
+            });
+        }
+    }
+
+    bench_decode_kernels(anchors);
+}
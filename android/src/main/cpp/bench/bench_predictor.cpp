@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "bench.h"
+#include "predictor.h"
+
+// Hands out a fixed output, so only the native stages are measured.
+class ReplayBackend : public InferenceBackend {
+public:
+    explicit ReplayBackend(std::vector<float> output) : output_(std::move(output)) {}
+
+    bool invoke(const float * /* input */, float *output) override {
+        std::copy(output_.begin(), output_.end(), output);
+        return true;
+    }
+
+private:
+    std::vector<float> output_;
+};
+
+static uint32_t next_random(uint32_t &state) {
+    state = state * 1664525u + 1013904223u;
+    return state;
+}
+
+// `score_rows` rows of scores from `first_score`, below 0.2 but for every `stride`-th anchor. Rows
+// before them are boxes of about a tenth of the input, rows after them uniform in [0, 1].
+static std::vector<float> synthetic_output(int rows, int anchors, int first_score, int score_rows, int stride) {
+    std::vector<float> output((size_t) rows * anchors);
+    uint32_t state = 12345;
+    for (int r = 0; r < rows; r++) {
+        for (int i = 0; i < anchors; i++) {
+            float v = (next_random(state) >> 8) * (1.f / 16777216.f);
+            if (r == 2 || r == 3)
+                v = 0.05f + 0.1f * v;
+            else if (r >= first_score && r < first_score + score_rows)
+                v = i % stride == 0 ? 0.3f + 0.6f * v : 0.2f * v;
+            output[(size_t) r * anchors + i] = v;
+        }
+    }
+    return output;
+}
+
+// Every task end to end on a 1280x720 portrait camera frame: preprocessing, a backend that costs
+// nothing, postprocessing.
+void bench_predictor() {
+    const int width = 1280;
+    const int height = 720;
+    const int size = 640;
+    const int anchors = 8400;
+
+    std::vector<uint8_t> luma((size_t) width * height);
+    std::vector<uint8_t> chroma((size_t) width * height / 2);
+    uint32_t state = 1;
+    for (uint8_t &v: luma)
+        v = (uint8_t) (next_random(state) >> 24);
+    for (uint8_t &v: chroma)
+        v = (uint8_t) (next_random(state) >> 24);
+
+    Frame frame{};
+    frame.planes = {luma.data(), chroma.data() + 1, chroma.data(), width, height, width, width, 2};
+    frame.rotation = 90;
+    const Box roi(0.f, 0.f, 1.f, 1.f);
+
+    printf("predictor %dx%d frame, %d input\n", width, height, size);
+
+    Detector detector(size, 80, anchors);
+    ReplayBackend detections(synthetic_output(4 + 80, anchors, 4, 80, 8));
+    run_benchmark("detector classes=80", 100, [&]() {
+        detector.predict(detections, frame, roi);
+        do_not_optimize(detector.objects().size());
+    });
+
+    const int classes = 1000;
+    Classifier classifier(224, classes);
+    classifier.set_top_k(5);
+    ReplayBackend probabilities(synthetic_output(1, classes, 0, 1, 1));
+    run_benchmark("classifier classes=1000 top=5", 200, [&]() {
+        classifier.predict(probabilities, frame, roi);
+        do_not_optimize(classifier.classes().size());
+    });
+}
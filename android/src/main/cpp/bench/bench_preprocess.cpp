@@ -0,0 +1,39 @@
+#include <cstdint>
+#include <vector>
+
+#include "bench.h"
+#include "preprocess.h"
+
+// A 1280x720 NV21 camera frame into a 640x640 model input, the rotations of a portrait phone.
+void bench_preprocess() {
+    const int width = 1280;
+    const int height = 720;
+    const int size = 640;
+
+    std::vector<uint8_t> luma((size_t) width * height);
+    std::vector<uint8_t> chroma((size_t) width * height / 2);
+    uint32_t state = 12345;
+    for (uint8_t &v: luma) {
+        state = state * 1664525u + 1013904223u;
+        v = (uint8_t) (state >> 24);
+    }
+    for (uint8_t &v: chroma) {
+        state = state * 1664525u + 1013904223u;
+        v = (uint8_t) (state >> 24);
+    }
+
+    Frame frame{};
+    frame.planes = {luma.data(), chroma.data() + 1, chroma.data(), width, height, width, width, 2};
+    std::vector<float> input((size_t) size * size * 3);
+
+    printf("preprocess %dx%d to %dx%d\n", width, height, size, size);
+    for (int rotation: {0, 90}) {
+        frame.rotation = rotation;
+        char name[64];
+        snprintf(name, sizeof(name), "yuv420 crop resize rotation=%d", rotation);
+        run_benchmark(name, 200, [&]() {
+            yuv420_crop_resize_rgb(frame, Box(0.f, 0.f, 1.f, 1.f), input.data(), size, size);
+            do_not_optimize(input[0]);
+        });
+    }
+}
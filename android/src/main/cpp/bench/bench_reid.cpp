@@ -0,0 +1,41 @@
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "embedding_gallery.h"
+
+// Query latency against gallery size, exact scan below the approximate threshold and LSH above.
+void bench_reid() {
+    const int dim = 128;
+    const int sizes[] = {256, 1024, 2047, 2048, 4096, 16384, 65536};
+
+    std::mt19937 rng(42);
+    std::normal_distribution<float> normal(0.f, 1.f);
+
+    std::vector<float> embedding(dim);
+    std::vector<int> exclude;
+
+    printf("reid gallery query, dim %d\n", dim);
+    for (int size: sizes) {
+        EmbeddingGallery gallery;
+        gallery.reset(dim, size);
+        for (int i = 0; i < size; i++) {
+            for (float &v: embedding)
+                v = normal(rng);
+            gallery.add(i, embedding.data());
+        }
+
+        for (float &v: embedding)
+            v = normal(rng);
+
+        char name[64];
+        snprintf(name, sizeof(name), "query size=%d%s", size,
+                 size >= gallery.approximate_threshold ? " (lsh)" : "");
+        run_benchmark(name, 200, [&]() {
+            GalleryMatch match;
+            bool found = gallery.query(embedding.data(), exclude, match);
+            do_not_optimize(found);
+            do_not_optimize(match);
+        });
+    }
+}
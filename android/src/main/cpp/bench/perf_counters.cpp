@@ -0,0 +1,136 @@
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        fds_[i] = -1;
+        values_[i] = -1;
+    }
+
+#if defined(__linux__)
+    const uint64_t configs[PERF_COUNTER_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    int open_errno = 0;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        // user space only, which perf_event_paranoid 2 still allows
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fds_[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds_[i] < 0)
+            open_errno = errno;
+    }
+
+    if (!any_available())
+        error_ = std::string("perf_event_open: ") + strerror(open_errno);
+#else
+    error_ = "perf_event_open is Linux only";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+    for (int fd: fds_) {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+}
+
+PerfCounters &PerfCounters::instance() {
+    static PerfCounters counters;
+    return counters;
+}
+
+bool PerfCounters::any_available() const {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (fds_[i] >= 0)
+            return true;
+    }
+    return false;
+}
+
+void PerfCounters::start() {
+#if defined(__linux__)
+    for (int fd: fds_) {
+        if (fd < 0)
+            continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::stop() {
+#if defined(__linux__)
+    for (int fd: fds_) {
+        if (fd >= 0)
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        values_[i] = -1;
+        uint64_t data[3];  // value, time enabled, time running
+        if (fds_[i] < 0 || read(fds_[i], data, sizeof(data)) != (ssize_t) sizeof(data))
+            continue;
+        if (data[2] == 0)
+            continue;  // never scheduled on the PMU
+        values_[i] = data[2] < data[1] ? (double) data[0] * data[1] / data[2] : (double) data[0];
+    }
+#endif
+}
+
+// a count with a k, M or G suffix
+static std::string format_count(double count) {
+    char text[32];
+    if (count < 0)
+        return "-";
+    if (count < 1e3)
+        snprintf(text, sizeof(text), "%.0f", count);
+    else if (count < 1e6)
+        snprintf(text, sizeof(text), "%.1fk", count / 1e3);
+    else if (count < 1e9)
+        snprintf(text, sizeof(text), "%.2fM", count / 1e6);
+    else
+        snprintf(text, sizeof(text), "%.2fG", count / 1e9);
+    return text;
+}
+
+std::string PerfCounters::format(int calls) const {
+    if (!any_available() || calls <= 0)
+        return "";
+
+    auto per_call = [this, calls](PerfCounter counter) {
+        return values_[counter] < 0 ? -1. : values_[counter] / calls;
+    };
+
+    char ipc[16] = "-";
+    if (values_[PERF_CYCLES] > 0 && values_[PERF_INSTRUCTIONS] >= 0)
+        snprintf(ipc, sizeof(ipc), "%.2f", values_[PERF_INSTRUCTIONS] / values_[PERF_CYCLES]);
+
+    return "cycles " + format_count(per_call(PERF_CYCLES)) + "  ipc " + ipc +
+           "  cache-misses " + format_count(per_call(PERF_CACHE_MISSES)) +
+           "  branch-misses " + format_count(per_call(PERF_BRANCH_MISSES));
+}
@@ -0,0 +1,60 @@
+//
+// Hardware performance counters for the benchmarks, through perf_event_open on Linux.
+//
+
+#ifndef ANDROID_PERF_COUNTERS_H
+#define ANDROID_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+
+enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+};
+
+// Counts user space events of the calling thread between start() and stop(). Every counter is
+// opened on its own, so a kernel or VM that lacks one still reports the others, and a denied
+// perf_event_open (perf_event_paranoid, seccomp, not Linux) leaves all of them unavailable.
+class PerfCounters {
+public:
+    PerfCounters();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // the counters shared by the benchmarks, opened on first use
+    static PerfCounters &instance();
+
+    bool available(PerfCounter counter) const { return fds_[counter] >= 0; }
+
+    bool any_available() const;
+
+    // why nothing could be opened, empty when something was
+    const std::string &error() const { return error_; }
+
+    void start();
+
+    void stop();
+
+    // events counted by the last start() / stop(), scaled up when the kernel multiplexed the
+    // counter, -1 when unavailable
+    double value(PerfCounter counter) const { return values_[counter]; }
+
+    // the last values per call, e.g. "cycles 812k  ipc 2.41  cache-misses 1.2k  branch-misses 35",
+    // empty when no counter is available
+    std::string format(int calls) const;
+
+private:
+    int fds_[PERF_COUNTER_COUNT];
+    double values_[PERF_COUNTER_COUNT];
+    std::string error_;
+};
+
+#endif //ANDROID_PERF_COUNTERS_H
@@ -0,0 +1,45 @@
+#include "cpu_features.h"
+
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+static CpuExtensions detect() {
+    CpuExtensions features;
+    if (getenv("ULTRALYTICS_CPU_BASELINE") != nullptr)
+        return features;
+
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    // AVX state must also be enabled by the OS
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_OSXSAVE) != 0 && (ecx & bit_AVX) != 0) {
+        unsigned int xcr0_low, xcr0_high;
+        __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+        bool os_avx = (xcr0_low & 0x6) == 0x6;
+        if (os_avx && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            features.avx2 = (ebx & bit_AVX2) != 0;
+    }
+#endif
+    return features;
+}
+
+const CpuExtensions &cpu_extensions() {
+    static const CpuExtensions features = detect();
+    return features;
+}
+
+std::string cpu_extensions_string() {
+    const CpuExtensions &f = cpu_extensions();
+    std::string names;
+    auto add = [&names](bool present, const char *name) {
+        if (!present)
+            return;
+        if (!names.empty())
+            names += ' ';
+        names += name;
+    };
+    add(f.avx2, "avx2");
+    return names.empty() ? "baseline" : names;
+}
@@ -0,0 +1,35 @@
+//
+// Runtime CPU feature detection for kernels built in several instruction set variants.
+//
+
+#ifndef ANDROID_CPU_FEATURES_H
+#define ANDROID_CPU_FEATURES_H
+
+#include <string>
+
+// Extensions beyond the baseline the build targets, ARMv8-A with NEON or x86-64 with SSE2. Only
+// those some kernel has a variant for are detected, ARM builds run the NEON baseline everywhere.
+struct CpuExtensions {
+    bool avx2 = false;
+};
+
+// Detected once from cpuid. Setting ULTRALYTICS_CPU_BASELINE in the environment
+// reports none, which selects the baseline variant of every kernel.
+const CpuExtensions &cpu_extensions();
+
+// the detected extensions, e.g. "avx2", for logs and benchmarks
+std::string cpu_extensions_string();
+
+// Variants are separate functions compiled for their instruction set with a target attribute,
+// the rest of the translation unit keeps the baseline. No variant enables FMA, so a variant does
+// the same IEEE operations in the same order as the baseline and produces bit identical results.
+#define ULTRALYTICS_ALWAYS_INLINE inline __attribute__((always_inline))
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define ULTRALYTICS_DISPATCH_AVX2 1
+#define ULTRALYTICS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ULTRALYTICS_DISPATCH_AVX2 0
+#endif
+
+#endif //ANDROID_CPU_FEATURES_H
@@ -0,0 +1,144 @@
+#include "custom_postprocessor.h"
+
+#include <dlfcn.h>
+
+#include <cstring>
+#include <mutex>
+
+#include "thread_pool.h"
+
+// postprocessors by name, registered for the lifetime of the process
+static std::mutex registry_lock;
+
+static std::vector<const UltralyticsPostprocessor *> &registry() {
+    static std::vector<const UltralyticsPostprocessor *> postprocessors;
+    return postprocessors;
+}
+
+static const UltralyticsPostprocessor *find_postprocessor(const std::string &name) {
+    std::lock_guard<std::mutex> guard(registry_lock);
+    for (const UltralyticsPostprocessor *postprocessor: registry()) {
+        if (name == postprocessor->name)
+            return postprocessor;
+    }
+    return nullptr;
+}
+
+int32_t ultralytics_register_postprocessor(const UltralyticsPostprocessor *postprocessor) {
+    if (postprocessor == nullptr || postprocessor->abi_version == 0
+        || postprocessor->abi_version > ULTRALYTICS_POSTPROCESSOR_ABI_VERSION
+        || postprocessor->name == nullptr || postprocessor->init == nullptr
+        || postprocessor->process == nullptr || postprocessor->destroy == nullptr)
+        return -1;
+
+    std::lock_guard<std::mutex> guard(registry_lock);
+    std::vector<const UltralyticsPostprocessor *> &postprocessors = registry();
+    for (const UltralyticsPostprocessor *&existing: postprocessors) {
+        if (strcmp(existing->name, postprocessor->name) == 0) {
+            existing = postprocessor;
+            return 0;
+        }
+    }
+    postprocessors.push_back(postprocessor);
+    return 0;
+}
+
+static void *host_scratch(void *context, size_t bytes) {
+    return ((ScratchArena *) context)->allocate(bytes);
+}
+
+static void host_parallel_for(void * /* context */, int32_t n, void (*fn)(void *, int32_t), void *user) {
+    ThreadPool::shared().parallel_for(n, [fn, user](int i) { fn(user, i); });
+}
+
+CustomPostprocessor::CustomPostprocessor() {
+    host_.abi_version = ULTRALYTICS_POSTPROCESSOR_ABI_VERSION;
+    host_.context = &scratch_;
+    host_.scratch = host_scratch;
+    host_.parallel_for = host_parallel_for;
+    host_.num_threads = ThreadPool::shared().size();
+}
+
+CustomPostprocessor::~CustomPostprocessor() {
+    if (plugin_ != nullptr)
+        plugin_->destroy(state_);
+}
+
+std::shared_ptr<CustomPostprocessor> CustomPostprocessor::create(const std::string &name, const std::string &library,
+                                                                 int rows, int cols) {
+    if (!library.empty()) {
+        // libraries stay loaded, their postprocessors may be selected again later
+        void *handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr)
+            return nullptr;
+        auto get = (UltralyticsGetPostprocessor) dlsym(handle, "ultralytics_get_postprocessor");
+        if (get != nullptr)
+            ultralytics_register_postprocessor(get());
+    }
+
+    const UltralyticsPostprocessor *plugin = find_postprocessor(name);
+    if (plugin == nullptr)
+        return nullptr;
+
+    UltralyticsTensorDesc output = {};
+    output.name = "output0";
+    output.type = ULTRALYTICS_FLOAT32;
+    output.rank = 3;
+    output.shape[0] = 1;
+    output.shape[1] = rows;
+    output.shape[2] = cols;
+
+    // the host is passed by address and must not move once the plugin holds it
+    std::shared_ptr<CustomPostprocessor> postprocessor(new CustomPostprocessor());
+    void *state = plugin->init(&output, 1, &postprocessor->host_);
+    if (state == nullptr)
+        return nullptr;
+
+    postprocessor->plugin_ = plugin;
+    postprocessor->state_ = state;
+    return postprocessor;
+}
+
+void CustomPostprocessor::shed() {
+    // a frame being decoded keeps its memory, the next shed frees it
+    std::unique_lock<std::mutex> guard(lock_, std::try_to_lock);
+    if (guard.owns_lock())
+        scratch_.release();
+}
+
+bool CustomPostprocessor::process(const float *output, const PostprocessConfig &config, int input_size,
+                                  std::vector<DetectedObject> &objects) {
+    objects.clear();
+    if (config.max_detections <= 0)
+        return false;
+
+    std::lock_guard<std::mutex> guard(lock_);
+    scratch_.reset();
+
+    UltralyticsPostprocessParams params;
+    params.confidence_threshold = config.confidence_threshold;
+    params.iou_threshold = config.iou_threshold;
+    params.max_detections = config.max_detections;
+    params.input_width = input_size;
+    params.input_height = input_size;
+
+    results_.resize(config.max_detections);
+    const void *outputs[] = {output};
+    int32_t count = plugin_->process(state_, outputs, &params, results_.data(), (int32_t) results_.size());
+    if (count < 0)
+        return false;
+
+    count = std::min(count, (int32_t) results_.size());
+    for (int32_t i = 0; i < count; i++) {
+        const UltralyticsDetection &d = results_[i];
+        if (!config.classes.empty() && (d.class_index < 0 || d.class_index >= (int) config.classes.size()
+                                        || config.classes[d.class_index] == 0))
+            continue;
+        DetectedObject obj;
+        obj.rect = Box(d.x, d.y, d.width, d.height);
+        obj.index = d.class_index;
+        obj.confidence = d.confidence;
+        objects.push_back(obj);
+    }
+    return true;
+}
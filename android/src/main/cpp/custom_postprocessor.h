@@ -0,0 +1,54 @@
+//
+// Runs postprocessors registered through the C ABI of ultralytics_postprocessor.h.
+//
+
+#ifndef ANDROID_CUSTOM_POSTPROCESSOR_H
+#define ANDROID_CUSTOM_POSTPROCESSOR_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "postprocess.h"
+#include "scratch_arena.h"
+#include "ultralytics.h"
+#include "ultralytics_postprocessor.h"
+
+// One selected postprocessor and its state. Frames in flight keep their own reference, so the
+// state is only destroyed once the last of them is done with it.
+class CustomPostprocessor {
+public:
+    // Creates the postprocessor registered as `name`, loading `library` first unless it is empty,
+    // for a single [rows][cols] float output. Returns null if it is unknown or rejects the model.
+    static std::shared_ptr<CustomPostprocessor> create(const std::string &name, const std::string &library,
+                                                       int rows, int cols);
+
+    CustomPostprocessor(const CustomPostprocessor &) = delete;
+
+    CustomPostprocessor &operator=(const CustomPostprocessor &) = delete;
+
+    ~CustomPostprocessor();
+
+    // Decodes one output into objects normalized to the model input. Frames are decoded one at
+    // a time, the plugin state and its scratch memory are not shared between them.
+    bool process(const float *output, const PostprocessConfig &config, int input_size,
+                 std::vector<DetectedObject> &objects);
+
+    // Frees the scratch memory when memory is short, unless a frame is being decoded. The next
+    // frame allocates it again.
+    void shed();
+
+private:
+    CustomPostprocessor();
+
+    std::mutex lock_;
+    // temporary memory of the current frame, handed out to the plugin
+    ScratchArena scratch_;
+    UltralyticsHost host_;
+    const UltralyticsPostprocessor *plugin_ = nullptr;
+    void *state_ = nullptr;
+    std::vector<UltralyticsDetection> results_;
+};
+
+#endif //ANDROID_CUSTOM_POSTPROCESSOR_H
@@ -0,0 +1,270 @@
+#include "detection_log.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static std::string segment_path(const std::string &directory, uint32_t sequence) {
+    char name[32];
+    snprintf(name, sizeof(name), "/detections_%08u.ulog", sequence);
+    return directory + name;
+}
+
+// sequence of a segment file name, or -1
+static int64_t parse_sequence(const char *name) {
+    unsigned sequence;
+    char ext[8];
+    if (sscanf(name, "detections_%8u.%7s", &sequence, ext) != 2 || strcmp(ext, "ulog") != 0)
+        return -1;
+    return sequence;
+}
+
+static uint16_t quantize(float v) {
+    return (uint16_t) std::lround(std::min(std::max(v, 0.f), 1.f) * 65535.f);
+}
+
+DetectionLog::~DetectionLog() {
+    close();
+}
+
+bool DetectionLog::open(const std::string &directory, int records_per_segment, int max_segments) {
+    close();
+
+    directory_ = directory;
+    records_per_segment_ = std::max(records_per_segment, 1);
+    max_segments_ = std::max(max_segments, 0);
+
+    // continue after the segments already in the directory
+    std::vector<std::string> existing = DetectionLogReader::segments(directory);
+    uint32_t sequence = 0;
+    first_sequence_ = 0;
+    if (!existing.empty()) {
+        first_sequence_ = (uint32_t) parse_sequence(strrchr(existing.front().c_str(), '/') + 1);
+        sequence = (uint32_t) parse_sequence(strrchr(existing.back().c_str(), '/') + 1) + 1;
+    }
+
+    current_ = create_segment(sequence);
+    if (current_.data == nullptr)
+        return false;
+    if (existing.empty())
+        first_sequence_ = sequence;
+    remove_old_segments(sequence);
+
+    stopping_ = false;
+    flusher_ = std::thread(&DetectionLog::run, this);
+    return true;
+}
+
+void DetectionLog::close() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (flusher_.joinable())
+        flusher_.join();
+
+    for (Segment &segment: retired_)
+        finish_segment(segment);
+    retired_.clear();
+    if (current_.data != nullptr) {
+        remove_old_segments(current_.sequence);
+        finish_segment(current_);
+    }
+    if (next_.data != nullptr) {
+        // never written, removed again
+        munmap(next_.data, next_.capacity);
+        ::close(next_.fd);
+        unlink(segment_path(directory_, next_.sequence).c_str());
+        next_ = Segment();
+    }
+}
+
+DetectionLog::Segment DetectionLog::create_segment(uint32_t sequence) const {
+    Segment segment;
+    segment.sequence = sequence;
+    segment.capacity = sizeof(LogHeader) + (size_t) records_per_segment_ * sizeof(LogRecord);
+
+    std::string path = segment_path(directory_, sequence);
+    segment.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (segment.fd < 0)
+        return Segment();
+
+    if (ftruncate(segment.fd, (off_t) segment.capacity) != 0) {
+        ::close(segment.fd);
+        return Segment();
+    }
+
+    void *data = mmap(nullptr, segment.capacity, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(segment.fd);
+        return Segment();
+    }
+    segment.data = (uint8_t *) data;
+
+    LogHeader *header = (LogHeader *) segment.data;
+    header->magic = LOG_MAGIC;
+    header->version = LOG_VERSION;
+    header->record_size = sizeof(LogRecord);
+    header->sequence = sequence;
+    header->record_count = 0;
+    header->reserved = 0;
+    return segment;
+}
+
+void DetectionLog::finish_segment(Segment &segment) {
+    size_t used = sizeof(LogHeader) + ((LogHeader *) segment.data)->record_count * sizeof(LogRecord);
+    msync(segment.data, segment.capacity, MS_SYNC);
+    munmap(segment.data, segment.capacity);
+    if (ftruncate(segment.fd, (off_t) used) != 0)
+        perror("ftruncate");
+    ::close(segment.fd);
+    segment = Segment();
+}
+
+void DetectionLog::remove_old_segments(uint32_t current_sequence) {
+    if (max_segments_ <= 0)
+        return;
+    while (current_sequence - first_sequence_ + 1 > (uint32_t) max_segments_) {
+        unlink(segment_path(directory_, first_sequence_).c_str());
+        first_sequence_++;
+    }
+}
+
+void DetectionLog::append(uint32_t frame_id, int64_t timestamp, const std::vector<DetectedObject> &objects) {
+    if (current_.data == nullptr)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const DetectedObject &obj: objects) {
+        LogHeader *h = header();
+        if (h->record_count == (uint64_t) records_per_segment_) {
+            // rotate to the prepared segment, or create one here if the flusher fell behind
+            Segment next = next_;
+            next_ = Segment();
+            if (next.data == nullptr)
+                next = create_segment(current_.sequence + 1);
+            if (next.data == nullptr)
+                return;
+            retired_.push_back(current_);
+            current_ = next;
+            h = header();
+            wake_.notify_one();
+        }
+
+        LogRecord &record = ((LogRecord *) (current_.data + sizeof(LogHeader)))[h->record_count];
+        record.timestamp = timestamp;
+        record.frame_id = frame_id;
+        record.track_id = obj.track_id;
+        record.x = quantize(obj.rect.x);
+        record.y = quantize(obj.rect.y);
+        record.w = quantize(obj.rect.width);
+        record.h = quantize(obj.rect.height);
+        record.index = (uint16_t) obj.index;
+        record.score = quantize(obj.confidence);
+        record.reserved = 0;
+        h->record_count++;
+    }
+}
+
+void DetectionLog::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (next_.data == nullptr) {
+            uint32_t sequence = current_.sequence + 1;
+            lock.unlock();
+            Segment next = create_segment(sequence);
+            lock.lock();
+            next_ = next;
+        }
+
+        std::vector<Segment> retired;
+        retired.swap(retired_);
+        uint8_t *data = current_.data;
+        size_t capacity = current_.capacity;
+        uint32_t sequence = current_.sequence;
+        lock.unlock();
+
+        for (Segment &segment: retired)
+            finish_segment(segment);
+        remove_old_segments(sequence);
+        // pushes the written pages towards storage without blocking the writer
+        msync(data, capacity, MS_ASYNC);
+
+        lock.lock();
+        wake_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms),
+                       [this] { return stopping_ || !retired_.empty(); });
+    }
+}
+
+DetectionLogReader::~DetectionLogReader() {
+    close();
+}
+
+bool DetectionLogReader::open(const std::string &path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(LogHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    data_ = data;
+    length_ = st.st_size;
+
+    const LogHeader *header = (const LogHeader *) data;
+    if (header->magic != LOG_MAGIC || header->version != LOG_VERSION || header->record_size != sizeof(LogRecord)) {
+        close();
+        return false;
+    }
+
+    // a segment that is still being written may hold fewer records than its file size allows
+    records_ = (const LogRecord *) ((const uint8_t *) data + sizeof(LogHeader));
+    count_ = std::min<size_t>(header->record_count, (length_ - sizeof(LogHeader)) / sizeof(LogRecord));
+    return true;
+}
+
+void DetectionLogReader::close() {
+    if (data_ != nullptr)
+        munmap(data_, length_);
+    data_ = nullptr;
+    length_ = 0;
+    records_ = nullptr;
+    count_ = 0;
+}
+
+std::vector<std::string> DetectionLogReader::segments(const std::string &directory) {
+    std::vector<std::pair<int64_t, std::string>> found;
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return {};
+    while (struct dirent *entry = readdir(dir)) {
+        int64_t sequence = parse_sequence(entry->d_name);
+        if (sequence >= 0)
+            found.emplace_back(sequence, directory + "/" + entry->d_name);
+    }
+    closedir(dir);
+
+    std::sort(found.begin(), found.end());
+    std::vector<std::string> paths;
+    for (auto &f: found)
+        paths.push_back(f.second);
+    return paths;
+}
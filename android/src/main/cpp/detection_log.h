@@ -0,0 +1,132 @@
+//
+// Append-only binary log of detections in memory-mapped, fixed size segment files.
+//
+// A segment is a LogHeader followed by LogRecords, all little endian. Segments are named
+// detections_<sequence>.ulog and are truncated to the records they hold once full.
+//
+
+#ifndef ANDROID_DETECTION_LOG_H
+#define ANDROID_DETECTION_LOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ultralytics.h"
+
+static const uint32_t LOG_MAGIC = 0x474f4c55; // "ULOG"
+static const uint32_t LOG_VERSION = 1;
+
+struct LogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t sequence;
+    // records written, incremented after each record is complete so that a reader never sees a
+    // partly written one
+    uint64_t record_count;
+    uint64_t reserved;
+};
+
+struct LogRecord {
+    // System.nanoTime() clock
+    int64_t timestamp;
+    uint32_t frame_id;
+    int32_t track_id;
+    // normalized box scaled to [0, 65535]
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint16_t index;
+    // confidence scaled to [0, 65535]
+    uint16_t score;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(LogHeader) == 32, "LogHeader layout is part of the file format");
+static_assert(sizeof(LogRecord) == 32, "LogRecord layout is part of the file format");
+
+class DetectionLog {
+public:
+    ~DetectionLog();
+
+    // Starts a new segment in `directory`, which must exist. Once there are more than
+    // `max_segments` segments the oldest is deleted, zero keeps them all.
+    bool open(const std::string &directory, int records_per_segment, int max_segments);
+
+    void close();
+
+    bool is_open() const { return current_.data != nullptr; }
+
+    // Appends one record per object. Only copies into the mapped segment; files are created,
+    // synced and closed by the flusher thread.
+    void append(uint32_t frame_id, int64_t timestamp, const std::vector<DetectedObject> &objects);
+
+    // time between two asynchronous syncs of the current segment
+    int64_t flush_interval_ms = 1000;
+
+private:
+    struct Segment {
+        int fd = -1;
+        uint32_t sequence = 0;
+        uint8_t *data = nullptr;
+        size_t capacity = 0;
+    };
+
+    Segment create_segment(uint32_t sequence) const;
+
+    // syncs, unmaps and truncates a full segment to its records
+    static void finish_segment(Segment &segment);
+
+    // deletes the oldest segments, from the flusher thread once it runs
+    void remove_old_segments(uint32_t current_sequence);
+
+    void run();
+
+    LogHeader *header() const { return (LogHeader *) current_.data; }
+
+    std::string directory_;
+    int records_per_segment_ = 0;
+    int max_segments_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread flusher_;
+    bool stopping_ = false;
+
+    Segment current_;
+    // prepared ahead by the flusher so rotating never opens a file on the hot path
+    Segment next_;
+    std::vector<Segment> retired_;
+    // oldest segment still on disk
+    uint32_t first_sequence_ = 0;
+};
+
+// Read-only view of one segment.
+class DetectionLogReader {
+public:
+    ~DetectionLogReader();
+
+    bool open(const std::string &path);
+
+    void close();
+
+    size_t size() const { return count_; }
+
+    const LogRecord &operator[](size_t i) const { return records_[i]; }
+
+    // The segments in `directory`, oldest first.
+    static std::vector<std::string> segments(const std::string &directory);
+
+private:
+    void *data_ = nullptr;
+    size_t length_ = 0;
+    const LogRecord *records_ = nullptr;
+    size_t count_ = 0;
+};
+
+#endif //ANDROID_DETECTION_LOG_H
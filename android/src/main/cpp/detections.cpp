@@ -0,0 +1,92 @@
+#include "detections.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Capacities are multiples of 16 rows so every column starts 64 byte aligned.
+static size_t round_capacity(size_t capacity) {
+    return (capacity + 15) & ~(size_t) 15;
+}
+
+Detections::Detections(int extra_columns) : extra_columns_(extra_columns) {}
+
+Detections::~Detections() {
+    free(memory_);
+}
+
+void Detections::assign_columns(uint8_t *memory, size_t capacity) {
+    float *base = (float *) memory;
+    x1_ = base;
+    y1_ = base + capacity;
+    x2_ = base + 2 * capacity;
+    y2_ = base + 3 * capacity;
+    score_ = base + 4 * capacity;
+    class_ = (int32_t *) (base + 5 * capacity);
+    extra_ = base + FIXED_COLUMNS * capacity;
+}
+
+void Detections::clear(int extra_columns) {
+    size_ = 0;
+    if (extra_columns == extra_columns_)
+        return;
+    free(memory_);
+    memory_ = nullptr;
+    capacity_ = 0;
+    extra_columns_ = extra_columns;
+}
+
+void Detections::reserve(size_t capacity) {
+    capacity = round_capacity(capacity);
+    if (capacity <= capacity_)
+        return;
+
+    void *memory = nullptr;
+    size_t columns = FIXED_COLUMNS + extra_columns_;
+    if (posix_memalign(&memory, ALIGNMENT, columns * capacity * sizeof(float)) != 0)
+        throw std::bad_alloc();
+
+    // the first size_ values of each column move to the same column of the new block
+    if (size_ > 0) {
+        for (size_t c = 0; c < columns; c++)
+            memcpy((float *) memory + c * capacity, (float *) memory_ + c * capacity_, size_ * sizeof(float));
+    }
+
+    free(memory_);
+    memory_ = (uint8_t *) memory;
+    capacity_ = capacity;
+    assign_columns(memory_, capacity_);
+}
+
+void Detections::gather(const int *rows, size_t count, Detections &out) const {
+    out.clear(extra_columns_);
+    out.reserve(count);
+    out.size_ = count;
+
+    for (size_t i = 0; i < count; i++) {
+        int r = rows[i];
+        out.x1_[i] = x1_[r];
+        out.y1_[i] = y1_[r];
+        out.x2_[i] = x2_[r];
+        out.y2_[i] = y2_[r];
+        out.score_[i] = score_[r];
+        out.class_[i] = class_[r];
+    }
+    for (int c = 0; c < extra_columns_; c++) {
+        const float *src = extra(c);
+        float *dst = out.extra(c);
+        for (size_t i = 0; i < count; i++)
+            dst[i] = src[rows[i]];
+    }
+}
+
+void Detections::append_objects(std::vector<DetectedObject> &objects) const {
+    size_t first = objects.size();
+    objects.resize(first + size_);
+    for (size_t i = 0; i < size_; i++) {
+        DetectedObject &obj = objects[first + i];
+        obj.rect = Box(x1_[i], y1_[i], x2_[i] - x1_[i], y2_[i] - y1_[i]);
+        obj.index = class_[i];
+        obj.confidence = score_[i];
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Detections in structure of arrays layout for the postprocess hot path.
+//
+
+#ifndef ANDROID_DETECTIONS_H
+#define ANDROID_DETECTIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ultralytics.h"
+
+// Every field is a separate column in one 64 byte aligned allocation, so loops over a field read
+// contiguous memory and vectorize. Boxes are corners, x1 y1 x2 y2. Optional extra columns carry
+// per detection values such as keypoints or mask coefficients. Rows are reordered through index
+// arrays and gather(), never by moving records.
+class Detections {
+public:
+    static const size_t ALIGNMENT = 64;
+
+    explicit Detections(int extra_columns = 0);
+
+    Detections(const Detections &) = delete;
+
+    Detections &operator=(const Detections &) = delete;
+
+    ~Detections();
+
+    // Drops all rows. Changing the number of extra columns also drops the capacity.
+    void clear(int extra_columns);
+
+    void clear() { size_ = 0; }
+
+    void reserve(size_t capacity);
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    int extra_columns() const { return extra_columns_; }
+
+    // Appends a row and returns its index, extra columns are left uninitialized.
+    size_t push_back(float x1, float y1, float x2, float y2, float score, int class_index) {
+        if (size_ == capacity_)
+            reserve(capacity_ < 64 ? 64 : capacity_ * 2);
+        size_t i = size_++;
+        x1_[i] = x1;
+        y1_[i] = y1;
+        x2_[i] = x2;
+        y2_[i] = y2;
+        score_[i] = score;
+        class_[i] = class_index;
+        return i;
+    }
+
+    float *x1() { return x1_; }
+    float *y1() { return y1_; }
+    float *x2() { return x2_; }
+    float *y2() { return y2_; }
+    float *score() { return score_; }
+    int32_t *class_index() { return class_; }
+    float *extra(int column) { return extra_ + (size_t) column * capacity_; }
+
+    const float *x1() const { return x1_; }
+    const float *y1() const { return y1_; }
+    const float *x2() const { return x2_; }
+    const float *y2() const { return y2_; }
+    const float *score() const { return score_; }
+    const int32_t *class_index() const { return class_; }
+    const float *extra(int column) const { return extra_ + (size_t) column * capacity_; }
+
+    // Replaces the contents of `out` with the listed rows of this container, in that order.
+    void gather(const int *rows, size_t count, Detections &out) const;
+
+    // Appends the rows as objects with corner boxes converted to x, y, width, height.
+    void append_objects(std::vector<DetectedObject> &objects) const;
+
+private:
+    // columns before the extras
+    static const int FIXED_COLUMNS = 6;
+
+    void assign_columns(uint8_t *memory, size_t capacity);
+
+    uint8_t *memory_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    int extra_columns_ = 0;
+
+    float *x1_ = nullptr;
+    float *y1_ = nullptr;
+    float *x2_ = nullptr;
+    float *y2_ = nullptr;
+    float *score_ = nullptr;
+    int32_t *class_ = nullptr;
+    float *extra_ = nullptr;
+};
+
+#endif //ANDROID_DETECTIONS_H
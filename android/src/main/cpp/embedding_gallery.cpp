@@ -0,0 +1,139 @@
+#include "embedding_gallery.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "simd.h"
+
+static void l2_normalize(const float *src, float *dst, int n) {
+    float norm = std::sqrt(dot_product(src, src, n));
+    float scale = norm > 0.f ? 1.f / norm : 0.f;
+    for (int i = 0; i < n; i++)
+        dst[i] = src[i] * scale;
+}
+
+void EmbeddingGallery::reset(int dim, int capacity) {
+    dim_ = dim;
+    capacity_ = capacity;
+    size_ = 0;
+    next_ = 0;
+
+    embeddings_.assign((size_t) dim * capacity, 0.f);
+    labels_.assign(capacity, -1);
+    codes_.assign(capacity, 0);
+
+    // fixed seed, codes stay comparable across resets
+    std::mt19937 rng(0x5eed);
+    std::normal_distribution<float> normal(0.f, 1.f);
+    hyperplanes_.resize((size_t) HASH_BITS * dim);
+    for (float &v: hyperplanes_)
+        v = normal(rng);
+
+    buckets_.assign(1 << HASH_BITS, CountedVector<int, MEMORY_CACHES>());
+}
+
+uint32_t EmbeddingGallery::hash(const float *embedding) const {
+    uint32_t code = 0;
+    for (int b = 0; b < HASH_BITS; b++) {
+        if (dot_product(&hyperplanes_[(size_t) b * dim_], embedding, dim_) > 0.f)
+            code |= 1u << b;
+    }
+    return code;
+}
+
+void EmbeddingGallery::add(int label, const float *embedding) {
+    if (capacity_ == 0)
+        return;
+
+    const int slot = next_;
+    next_ = (next_ + 1) % capacity_;
+
+    // evict the previous occupant from its bucket
+    if (size_ == capacity_) {
+        CountedVector<int, MEMORY_CACHES> &bucket = buckets_[codes_[slot]];
+        bucket.erase(std::find(bucket.begin(), bucket.end(), slot));
+    } else {
+        size_++;
+    }
+
+    float *dst = &embeddings_[(size_t) slot * dim_];
+    l2_normalize(embedding, dst, dim_);
+    labels_[slot] = label;
+    codes_[slot] = hash(dst);
+    buckets_[codes_[slot]].push_back(slot);
+}
+
+void EmbeddingGallery::consider(const float *query, int slot, const std::vector<int> &exclude,
+                                GalleryMatch &match, bool &found) const {
+    float similarity = dot_product(query, &embeddings_[(size_t) slot * dim_], dim_);
+    if (found && similarity <= match.similarity)
+        return;
+
+    // exclusions are few, only checked for improving candidates
+    if (std::find(exclude.begin(), exclude.end(), labels_[slot]) != exclude.end())
+        return;
+
+    match.label = labels_[slot];
+    match.similarity = similarity;
+    found = true;
+}
+
+bool EmbeddingGallery::query(const float *embedding, const std::vector<int> &exclude, GalleryMatch &match) const {
+    if (size_ == 0)
+        return false;
+
+    std::vector<float> query(dim_);
+    l2_normalize(embedding, query.data(), dim_);
+
+    bool found = false;
+    if (size_ >= approximate_threshold) {
+        // multi-probe, the query bucket and every bucket one bit away
+        const uint32_t code = hash(query.data());
+        for (int b = -1; b < HASH_BITS; b++) {
+            for (int slot: buckets_[b < 0 ? code : code ^ (1u << b)])
+                consider(query.data(), slot, exclude, match, found);
+        }
+        if (found)
+            return true;
+    }
+
+    // exact scan over the contiguous storage
+    for (int slot = 0; slot < size_; slot++)
+        consider(query.data(), slot, exclude, match, found);
+    return found;
+}
+
+void EmbeddingGallery::shrink() {
+    if (capacity_ <= 1)
+        return;
+
+    // the newest entries, oldest first
+    const int capacity = capacity_ / 2;
+    const int count = std::min(size_, capacity);
+    std::vector<float> embeddings((size_t) count * dim_);
+    std::vector<int> labels(count);
+    for (int i = 0; i < count; i++) {
+        int slot = (next_ - count + i + capacity_) % capacity_;
+        std::copy_n(&embeddings_[(size_t) slot * dim_], dim_, &embeddings[(size_t) i * dim_]);
+        labels[i] = labels_[slot];
+    }
+
+    // assign() keeps the old allocation, fresh vectors give the memory back
+    CountedVector<float, MEMORY_CACHES>().swap(embeddings_);
+    CountedVector<int, MEMORY_CACHES>().swap(labels_);
+    CountedVector<uint32_t, MEMORY_CACHES>().swap(codes_);
+    CountedVector<CountedVector<int, MEMORY_CACHES>, MEMORY_CACHES>().swap(buckets_);
+    reset(dim_, capacity);
+
+    // already normalized, stored as they are
+    for (int slot = 0; slot < count; slot++) {
+        float *dst = &embeddings_[(size_t) slot * dim_];
+        std::copy_n(&embeddings[(size_t) slot * dim_], dim_, dst);
+        labels_[slot] = labels[slot];
+        codes_[slot] = hash(dst);
+        buckets_[codes_[slot]].push_back(slot);
+    }
+    size_ = count;
+    next_ = count % capacity;
+}
@@ -0,0 +1,65 @@
+//
+// Fixed capacity store of L2-normalized appearance embeddings, searched by
+// cosine similarity. Large galleries are searched through a random hyperplane
+// LSH index instead of a full scan.
+//
+
+#ifndef ANDROID_EMBEDDING_GALLERY_H
+#define ANDROID_EMBEDDING_GALLERY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "memory_budget.h"
+
+struct GalleryMatch {
+    int label;
+    float similarity;
+};
+
+class EmbeddingGallery {
+public:
+    // Clears the gallery and sets the embedding size and the number of entries kept.
+    void reset(int dim, int capacity);
+
+    // Normalizes and stores `embedding`, overwriting the oldest entry once full.
+    void add(int label, const float *embedding);
+
+    // Finds the most similar entry whose label is not in `exclude`. Returns false when the
+    // gallery holds no such entry.
+    bool query(const float *embedding, const std::vector<int> &exclude, GalleryMatch &match) const;
+
+    // Halves the capacity when memory is short, keeping the newest entries.
+    void shrink();
+
+    int size() const { return size_; }
+
+    int dim() const { return dim_; }
+
+    // galleries at least this large are searched through the LSH index
+    int approximate_threshold = 2048;
+
+private:
+    static const int HASH_BITS = 12;
+
+    uint32_t hash(const float *embedding) const;
+
+    void consider(const float *query, int slot, const std::vector<int> &exclude,
+                  GalleryMatch &match, bool &found) const;
+
+    int dim_ = 0;
+    int capacity_ = 0;
+    int size_ = 0;
+    int next_ = 0;
+
+    // row-major [capacity][dim]
+    CountedVector<float, MEMORY_CACHES> embeddings_;
+    CountedVector<int, MEMORY_CACHES> labels_;
+    CountedVector<uint32_t, MEMORY_CACHES> codes_;
+
+    // [HASH_BITS][dim] hyperplanes and the slots falling into each bucket
+    CountedVector<float, MEMORY_CACHES> hyperplanes_;
+    CountedVector<CountedVector<int, MEMORY_CACHES>, MEMORY_CACHES> buckets_;
+};
+
+#endif //ANDROID_EMBEDDING_GALLERY_H
@@ -0,0 +1,267 @@
+#include "frame_buffer.h"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#if ULTRALYTICS_WITH_OPENCV
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+#endif
+
+static const int STAGING_SLOTS = 2;
+
+// nice value of the encoder thread, below the camera and inference threads
+static const int WORKER_PRIORITY = 10;
+
+FrameBuffer::~FrameBuffer() {
+    stop();
+}
+
+void FrameBuffer::configure(size_t memory_budget, int max_side, int quality) {
+    stop();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return writers_ == 0; });
+    memory_budget_ = memory_budget;
+    max_side_ = std::max(max_side, 16);
+    quality_ = std::min(std::max(quality, 1), 100);
+
+    staging_.assign(STAGING_SLOTS, Staged());
+    free_slots_.clear();
+    for (int i = 0; i < STAGING_SLOTS; i++)
+        free_slots_.push_back(i);
+    pending_.clear();
+    frames_.clear();
+    encoded_bytes_ = 0;
+    detections_.clear();
+
+    if (memory_budget_ > 0 && ULTRALYTICS_WITH_OPENCV)
+        start();
+}
+
+void FrameBuffer::start() {
+    stopping_ = false;
+    worker_ = std::thread(&FrameBuffer::run, this);
+    enabled_ = true;
+}
+
+void FrameBuffer::stop() {
+    enabled_ = false;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+void FrameBuffer::push(const Frame &source) {
+    if (!enabled_)
+        return;
+
+    // the lock is only held to take a slot and to queue it, the copy runs outside of it
+    int slot;
+    int max_side;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!enabled_ || free_slots_.empty())
+            return;
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        max_side = max_side_;
+        writers_++;
+    }
+
+    const YuvPlanes &frame = source.planes;
+    float scale = std::min(1.f, (float) max_side / std::max(frame.width, frame.height));
+    int w = std::max(2, (int) (frame.width * scale) & ~1);
+    int h = std::max(2, (int) (frame.height * scale) & ~1);
+
+    Staged &staged = staging_[slot];
+    staged.timestamp = source.timestamp;
+    staged.rotation = source.rotation;
+    staged.width = w;
+    staged.height = h;
+    staged.pixels.resize((size_t) w * h * 3 / 2);
+
+    // luma is area averaged, chroma is sampled
+#if ULTRALYTICS_WITH_OPENCV
+    cv::Mat y_src(frame.height, frame.width, CV_8UC1, (void *) frame.y, frame.y_row_stride);
+    cv::Mat y_dst(h, w, CV_8UC1, staged.pixels.data());
+    cv::resize(y_src, y_dst, y_dst.size(), 0, 0, cv::INTER_AREA);
+#endif
+
+    uint8_t *u_dst = staged.pixels.data() + (size_t) w * h;
+    uint8_t *v_dst = u_dst + (size_t) (w / 2) * (h / 2);
+    for (int y = 0; y < h / 2; y++) {
+        int sy = y * frame.height / h;
+        const uint8_t *u_row = frame.u + (size_t) sy * frame.uv_row_stride;
+        const uint8_t *v_row = frame.v + (size_t) sy * frame.uv_row_stride;
+        for (int x = 0; x < w / 2; x++) {
+            int sx = (x * frame.width / w) * frame.uv_pixel_stride;
+            *u_dst++ = u_row[sx];
+            *v_dst++ = v_row[sx];
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        pending_.push_back(slot);
+        writers_--;
+    }
+    idle_.notify_all();
+    wake_.notify_one();
+}
+
+void FrameBuffer::add_detections(int64_t timestamp, const std::vector<DetectedObject> &objects) {
+    if (!enabled_)
+        return;
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    detections_.push_back({timestamp, objects});
+
+    // kept only as far back as the oldest frame, or one frame when there is none yet
+    int64_t oldest = frames_.empty() ? timestamp : frames_.front().timestamp;
+    while (detections_.size() > 1 && detections_.front().timestamp < oldest)
+        detections_.pop_front();
+}
+
+int FrameBuffer::dump(int64_t from, int64_t to, const std::string &directory) {
+    DumpJob job;
+    job.directory = directory;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        for (const Encoded &frame: frames_)
+            if (frame.timestamp >= from && frame.timestamp <= to)
+                job.frames.push_back(frame);
+        for (const Detections &detections: detections_)
+            if (detections.timestamp >= from && detections.timestamp <= to)
+                job.detections.push_back(detections);
+
+        if (job.frames.empty() || !enabled_)
+            return 0;
+    }
+
+    int count = (int) job.frames.size();
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+    return count;
+}
+
+size_t FrameBuffer::memory_usage() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_t bytes = encoded_bytes_ + detections_.size() * sizeof(Detections);
+    for (const Staged &staged: staging_)
+        bytes += staged.pixels.capacity();
+    return bytes;
+}
+
+void FrameBuffer::shed() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_t target = encoded_bytes_ / 2;
+    while (encoded_bytes_ > target && frames_.size() > 1) {
+        encoded_bytes_ -= frames_.front().jpeg->size();
+        frames_.pop_front();
+    }
+    memory_budget_ = std::min(memory_budget_, std::max(encoded_bytes_, (size_t) 1));
+}
+
+std::shared_ptr<const std::vector<uint8_t>> FrameBuffer::encode(const Staged &staged) const {
+#if ULTRALYTICS_WITH_OPENCV
+    cv::Mat i420(staged.height * 3 / 2, staged.width, CV_8UC1, (void *) staged.pixels.data());
+    cv::Mat bgr;
+    cv::cvtColor(i420, bgr, cv::COLOR_YUV2BGR_I420);
+
+    if (staged.rotation == 90)
+        cv::rotate(bgr, bgr, cv::ROTATE_90_CLOCKWISE);
+    else if (staged.rotation == 180)
+        cv::rotate(bgr, bgr, cv::ROTATE_180);
+    else if (staged.rotation == 270)
+        cv::rotate(bgr, bgr, cv::ROTATE_90_COUNTERCLOCKWISE);
+
+    // imencode fills a plain vector, charged by hand for as long as a buffer or dump holds it
+    auto *jpeg = new std::vector<uint8_t>();
+    cv::imencode(".jpg", bgr, *jpeg, {cv::IMWRITE_JPEG_QUALITY, quality_});
+    memory_charge(MEMORY_FRAMES, jpeg->capacity());
+    return std::shared_ptr<const std::vector<uint8_t>>(jpeg, [](const std::vector<uint8_t> *data) {
+        memory_release(MEMORY_FRAMES, data->capacity());
+        delete data;
+    });
+#else
+    return std::make_shared<const std::vector<uint8_t>>();
+#endif
+}
+
+void FrameBuffer::write(const DumpJob &job) {
+    mkdir(job.directory.c_str(), 0755);
+
+    for (const Encoded &frame: job.frames) {
+        std::string path = job.directory + "/frame_" + std::to_string(frame.timestamp / 1000000) + ".jpg";
+        FILE *fp = fopen(path.c_str(), "wb");
+        if (!fp)
+            return;
+        fwrite(frame.jpeg->data(), 1, frame.jpeg->size(), fp);
+        fclose(fp);
+    }
+
+    std::string path = job.directory + "/detections.csv";
+    FILE *fp = fopen(path.c_str(), "w");
+    if (!fp)
+        return;
+    fprintf(fp, "timestamp_ms,x,y,width,height,confidence,index,track_id\n");
+    for (const Detections &detections: job.detections) {
+        for (const DetectedObject &obj: detections.objects) {
+            fprintf(fp, "%" PRId64 ",%.5f,%.5f,%.5f,%.5f,%.4f,%d,%d\n", detections.timestamp / 1000000,
+                    obj.rect.x, obj.rect.y, obj.rect.width, obj.rect.height, obj.confidence, obj.index,
+                    obj.track_id);
+        }
+    }
+    fclose(fp);
+}
+
+void FrameBuffer::run() {
+    setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), WORKER_PRIORITY);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !pending_.empty() || !jobs_.empty(); });
+
+        // dumps already queued are still written when stopping, pending frames are not encoded
+        if (!jobs_.empty()) {
+            DumpJob job = std::move(jobs_.front());
+            jobs_.pop_front();
+            lock.unlock();
+            write(job);
+            lock.lock();
+            continue;
+        }
+        if (stopping_)
+            return;
+
+        int slot = pending_.front();
+        pending_.pop_front();
+        lock.unlock();
+        auto jpeg = encode(staging_[slot]);
+        int64_t timestamp = staging_[slot].timestamp;
+        lock.lock();
+
+        free_slots_.push_back(slot);
+        frames_.push_back({timestamp, jpeg});
+        encoded_bytes_ += jpeg->size();
+        while (encoded_bytes_ > memory_budget_ && frames_.size() > 1) {
+            encoded_bytes_ -= frames_.front().jpeg->size();
+            frames_.pop_front();
+        }
+    }
+}
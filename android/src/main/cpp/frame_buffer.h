@@ -0,0 +1,115 @@
+//
+// Recent camera frames kept for evidence snapshots: downscaled, JPEG encoded on a low priority
+// worker thread, bounded by a memory budget and dumped to disk with their detections on demand.
+//
+
+#ifndef ANDROID_FRAME_BUFFER_H
+#define ANDROID_FRAME_BUFFER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_source.h"
+#include "memory_budget.h"
+#include "ultralytics.h"
+
+// JPEG encoding needs OpenCV. Without it the buffer stays disabled whatever its budget.
+#ifndef ULTRALYTICS_WITH_OPENCV
+#define ULTRALYTICS_WITH_OPENCV 1
+#endif
+
+class FrameBuffer {
+public:
+    ~FrameBuffer();
+
+    // Keeps frames scaled to at most `max_side` pixels until their encoded size reaches
+    // `memory_budget`. A zero budget, or a build without OpenCV, disables the buffer and stops the
+    // worker.
+    void configure(size_t memory_budget, int max_side, int quality);
+
+    bool enabled() const { return enabled_; }
+
+    // Downscales a frame and queues it for encoding. The frame is dropped when the worker is still
+    // busy with the previous ones. Safe to call while another thread reconfigures the buffer.
+    void push(const Frame &frame);
+
+    void add_detections(int64_t timestamp, const std::vector<DetectedObject> &objects);
+
+    // Queues writing the frames between `from` and `to` and their detections into `directory`,
+    // and returns the number of frames that will be written.
+    int dump(int64_t from, int64_t to, const std::string &directory);
+
+    size_t memory_usage();
+
+    // Drops the older half of the encoded frames when memory is short and keeps the buffer at
+    // the smaller size from then on.
+    void shed();
+
+private:
+    struct Staged {
+        int64_t timestamp;
+        int rotation;
+        int width;
+        int height;
+        // planar I420
+        CountedVector<uint8_t, MEMORY_FRAMES> pixels;
+    };
+
+    struct Encoded {
+        int64_t timestamp;
+        std::shared_ptr<const std::vector<uint8_t>> jpeg;
+    };
+
+    struct Detections {
+        int64_t timestamp;
+        std::vector<DetectedObject> objects;
+    };
+
+    struct DumpJob {
+        std::string directory;
+        std::vector<Encoded> frames;
+        std::vector<Detections> detections;
+    };
+
+    void start();
+
+    void stop();
+
+    void run();
+
+    std::shared_ptr<const std::vector<uint8_t>> encode(const Staged &staged) const;
+
+    static void write(const DumpJob &job);
+
+    size_t memory_budget_ = 0;
+    int max_side_ = 320;
+    int quality_ = 75;
+    std::atomic<bool> enabled_{false};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread worker_;
+    bool stopping_ = false;
+    // pushes filling a staging slot outside the lock, configure() waits for them
+    int writers_ = 0;
+    std::condition_variable idle_;
+
+    // frames are staged in a small pool so capture never waits for the encoder
+    std::vector<Staged> staging_;
+    std::vector<int> free_slots_;
+    std::deque<int> pending_;
+
+    std::deque<Encoded> frames_;
+    size_t encoded_bytes_ = 0;
+    std::deque<Detections> detections_;
+    std::deque<DumpJob> jobs_;
+};
+
+#endif //ANDROID_FRAME_BUFFER_H
@@ -0,0 +1,239 @@
+#include "frame_recording.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+static const int STAGING_SLOTS = 4;
+
+static size_t padded(size_t size) {
+    return (size + 7) & ~(size_t) 7;
+}
+
+FrameRecorder::~FrameRecorder() {
+    close();
+}
+
+bool FrameRecorder::open(const std::string &path) {
+    close();
+
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (fp == nullptr)
+        return false;
+
+    RecordingHeader header = {RECORDING_MAGIC, RECORDING_VERSION, 0, 0};
+    fwrite(&header, sizeof(header), 1, fp);
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    fp_ = fp;
+    frame_count_ = 0;
+    dropped_ = 0;
+    staging_.assign(STAGING_SLOTS, Staged());
+    free_slots_.clear();
+    for (int i = 0; i < STAGING_SLOTS; i++)
+        free_slots_.push_back(i);
+    pending_.clear();
+
+    stopping_ = false;
+    writer_ = std::thread(&FrameRecorder::run, this);
+    return true;
+}
+
+void FrameRecorder::close() {
+    {
+        // frames being copied are still queued, and written before the writer exits
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+        idle_.wait(lock, [this] { return writers_ == 0; });
+    }
+    wake_.notify_all();
+    if (writer_.joinable())
+        writer_.join();
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (fp_ == nullptr)
+        return;
+
+    RecordingHeader header = {RECORDING_MAGIC, RECORDING_VERSION, frame_count_, dropped_};
+    fseek(fp_, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fp_);
+    fclose(fp_);
+    fp_ = nullptr;
+}
+
+void FrameRecorder::record(const Frame &frame) {
+    // the lock is only held to take a slot and to queue it, the copy runs outside of it
+    int slot;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (stopping_)
+            return;
+        if (free_slots_.empty()) {
+            dropped_++;
+            return;
+        }
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        writers_++;
+    }
+
+    const YuvPlanes &p = frame.planes;
+    const int w = p.width;
+    const int h = p.height;
+    const int cw = w / 2;
+    const int ch = h / 2;
+
+    Staged &staged = staging_[slot];
+    staged.header.timestamp = frame.timestamp;
+    staged.header.width = w;
+    staged.header.height = h;
+    staged.header.rotation = frame.rotation;
+    staged.header.y_row_stride = w;
+    staged.header.uv_row_stride = cw;
+    staged.header.uv_pixel_stride = 1;
+    staged.header.size = (uint32_t) ((size_t) w * h + (size_t) cw * ch * 2);
+    staged.header.reserved = 0;
+    staged.pixels.resize(padded(staged.header.size));
+
+    uint8_t *dst = staged.pixels.data();
+    for (int y = 0; y < h; y++, dst += w)
+        memcpy(dst, p.y + (size_t) y * p.y_row_stride, w);
+
+    const uint8_t *planes[2] = {p.u, p.v};
+    for (const uint8_t *plane: planes) {
+        for (int y = 0; y < ch; y++) {
+            const uint8_t *row = plane + (size_t) y * p.uv_row_stride;
+            if (p.uv_pixel_stride == 1) {
+                memcpy(dst, row, cw);
+                dst += cw;
+            } else {
+                for (int x = 0; x < cw; x++)
+                    *dst++ = row[x * p.uv_pixel_stride];
+            }
+        }
+    }
+    memset(dst, 0, staged.pixels.size() - staged.header.size);
+
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        pending_.push_back(slot);
+        writers_--;
+    }
+    idle_.notify_all();
+    wake_.notify_one();
+}
+
+void FrameRecorder::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        // frames already staged are still written when stopping
+        if (pending_.empty())
+            return;
+
+        int slot = pending_.front();
+        pending_.pop_front();
+        lock.unlock();
+
+        const Staged &staged = staging_[slot];
+        fwrite(&staged.header, sizeof(staged.header), 1, fp_);
+        fwrite(staged.pixels.data(), 1, staged.pixels.size(), fp_);
+
+        lock.lock();
+        frame_count_++;
+        free_slots_.push_back(slot);
+    }
+}
+
+RecordingFrameSource::~RecordingFrameSource() {
+    close();
+}
+
+bool RecordingFrameSource::open(const std::string &path, bool realtime) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(RecordingHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    data_ = (const uint8_t *) data;
+    length_ = st.st_size;
+
+    const RecordingHeader *header = (const RecordingHeader *) data_;
+    if (header->magic != RECORDING_MAGIC || header->version != RECORDING_VERSION) {
+        close();
+        return false;
+    }
+    dropped_ = header->dropped;
+
+    // index the frames, up to a frame cut short if the recording was not closed
+    size_t offset = sizeof(RecordingHeader);
+    while (offset + sizeof(RecordedFrame) <= length_) {
+        const RecordedFrame *frame = (const RecordedFrame *) (data_ + offset);
+        size_t next = offset + sizeof(RecordedFrame) + padded(frame->size);
+        if (next > length_)
+            break;
+        offsets_.push_back(offset);
+        offset = next;
+    }
+
+    realtime_ = realtime;
+    position_ = 0;
+    return true;
+}
+
+void RecordingFrameSource::close() {
+    if (data_ != nullptr)
+        munmap((void *) data_, length_);
+    data_ = nullptr;
+    length_ = 0;
+    offsets_.clear();
+    position_ = 0;
+}
+
+bool RecordingFrameSource::next(Frame &frame) {
+    if (position_ >= offsets_.size())
+        return false;
+
+    const RecordedFrame *header = (const RecordedFrame *) (data_ + offsets_[position_]);
+    const uint8_t *pixels = (const uint8_t *) (header + 1);
+    const size_t y_size = (size_t) header->y_row_stride * header->height;
+    const size_t uv_size = (size_t) header->uv_row_stride * (header->height / 2);
+
+    frame.planes.y = pixels;
+    frame.planes.u = pixels + y_size;
+    frame.planes.v = pixels + y_size + uv_size;
+    frame.planes.width = header->width;
+    frame.planes.height = header->height;
+    frame.planes.y_row_stride = header->y_row_stride;
+    frame.planes.uv_row_stride = header->uv_row_stride;
+    frame.planes.uv_pixel_stride = header->uv_pixel_stride;
+    frame.rotation = header->rotation;
+    frame.timestamp = header->timestamp;
+
+    if (realtime_) {
+        // keep the recorded spacing between frames
+        if (position_ == 0) {
+            start_ = std::chrono::steady_clock::now();
+            first_timestamp_ = header->timestamp;
+        } else {
+            std::this_thread::sleep_until(start_ + std::chrono::nanoseconds(header->timestamp - first_timestamp_));
+        }
+    }
+
+    position_++;
+    return true;
+}
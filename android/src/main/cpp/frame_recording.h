@@ -0,0 +1,121 @@
+//
+// Raw YUV420 recordings of camera sessions.
+//
+// A recording is a RecordingHeader followed by frames, each a RecordedFrame and its planes (Y,
+// then U, then V, with the recorded strides) padded to 8 bytes, all little endian.
+//
+
+#ifndef ANDROID_FRAME_RECORDING_H
+#define ANDROID_FRAME_RECORDING_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_source.h"
+#include "memory_budget.h"
+
+static const uint32_t RECORDING_MAGIC = 0x56555955; // "UYUV"
+static const uint32_t RECORDING_VERSION = 1;
+
+struct RecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+    // written when the recording is closed, zero if it was not
+    uint32_t frame_count;
+    // frames dropped because the writer fell behind
+    uint32_t dropped;
+};
+
+struct RecordedFrame {
+    int64_t timestamp;
+    int32_t width;
+    int32_t height;
+    int32_t rotation;
+    int32_t y_row_stride;
+    int32_t uv_row_stride;
+    int32_t uv_pixel_stride;
+    // bytes of plane data that follow, before padding
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(RecordingHeader) == 16, "RecordingHeader layout is part of the file format");
+static_assert(sizeof(RecordedFrame) == 40, "RecordedFrame layout is part of the file format");
+
+// Writes frames on a background thread. Frames are repacked as planar I420.
+class FrameRecorder {
+public:
+    ~FrameRecorder();
+
+    bool open(const std::string &path);
+
+    void close();
+
+    bool is_open() const { return fp_ != nullptr; }
+
+    // Copies the frame for the writer thread, or drops it when the writer is still busy. Safe to
+    // call while another thread opens or closes the recording.
+    void record(const Frame &frame);
+
+private:
+    struct Staged {
+        RecordedFrame header;
+        CountedVector<uint8_t, MEMORY_FRAMES> pixels;
+    };
+
+    void run();
+
+    FILE *fp_ = nullptr;
+    uint32_t frame_count_ = 0;
+    uint32_t dropped_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread writer_;
+    bool stopping_ = true;
+    // records filling a staging slot outside the lock, close() waits for them
+    int writers_ = 0;
+    std::condition_variable idle_;
+
+    std::vector<Staged> staging_;
+    std::vector<int> free_slots_;
+    std::deque<int> pending_;
+};
+
+// Replays a recording from a read-only mapping, at its original pace or as fast as possible.
+class RecordingFrameSource : public FrameSource {
+public:
+    ~RecordingFrameSource() override;
+
+    bool open(const std::string &path, bool realtime);
+
+    void close();
+
+    size_t size() const { return offsets_.size(); }
+
+    uint32_t dropped() const { return dropped_; }
+
+    bool next(Frame &frame) override;
+
+    void rewind() { position_ = 0; }
+
+private:
+    const uint8_t *data_ = nullptr;
+    size_t length_ = 0;
+    std::vector<size_t> offsets_;
+    uint32_t dropped_ = 0;
+    size_t position_ = 0;
+
+    bool realtime_ = false;
+    std::chrono::steady_clock::time_point start_;
+    int64_t first_timestamp_ = 0;
+};
+
+#endif //ANDROID_FRAME_RECORDING_H
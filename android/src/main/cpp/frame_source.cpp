@@ -0,0 +1,98 @@
+#include "frame_source.h"
+
+#include <algorithm>
+#include <cstring>
+
+SyntheticFrameSource::SyntheticFrameSource(int width, int height, int num_objects, int fps,
+                                           int64_t num_frames, uint32_t seed)
+        : width_(width & ~1), height_(height & ~1), frame_interval_ns_(1000000000LL / std::max(fps, 1)),
+          num_frames_(num_frames), state_(seed ? seed : 1) {
+    for (int i = 0; i < num_objects; i++) {
+        Mover m;
+        m.w = 0.05f + 0.15f * random();
+        m.h = 0.05f + 0.25f * random();
+        m.x = random() * (1.f - m.w);
+        m.y = random() * (1.f - m.h);
+        m.vx = (random() - 0.5f) * 0.02f;
+        m.vy = (random() - 0.5f) * 0.02f;
+        m.index = i % 80;
+        movers_.push_back(m);
+    }
+
+    background_.resize((size_t) width_ * height_);
+    for (int y = 0; y < height_; y++)
+        for (int x = 0; x < width_; x++)
+            background_[(size_t) y * width_ + x] = (uint8_t) (16 + (x + y) * 160 / (width_ + height_));
+
+    pixels_.resize((size_t) width_ * height_ * 3 / 2);
+}
+
+// xorshift32, the same sequence on every platform
+float SyntheticFrameSource::random() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return (state_ >> 8) * (1.f / 16777216.f);
+}
+
+bool SyntheticFrameSource::next(Frame &frame) {
+    if (num_frames_ >= 0 && frame_ >= num_frames_)
+        return false;
+
+    uint8_t *y_plane = pixels_.data();
+    uint8_t *u_plane = y_plane + (size_t) width_ * height_;
+    uint8_t *v_plane = u_plane + (size_t) (width_ / 2) * (height_ / 2);
+    memcpy(y_plane, background_.data(), background_.size());
+    memset(u_plane, 128, (size_t) (width_ / 2) * (height_ / 2) * 2);
+
+    objects_.clear();
+    for (Mover &m: movers_) {
+        if (frame_ > 0) {
+            m.x += m.vx;
+            m.y += m.vy;
+            if (m.x < 0.f || m.x + m.w > 1.f) {
+                m.vx = -m.vx;
+                m.x = std::min(std::max(m.x, 0.f), 1.f - m.w);
+            }
+            if (m.y < 0.f || m.y + m.h > 1.f) {
+                m.vy = -m.vy;
+                m.y = std::min(std::max(m.y, 0.f), 1.f - m.h);
+            }
+        }
+
+        int x0 = (int) (m.x * width_) & ~1;
+        int y0 = (int) (m.y * height_) & ~1;
+        int x1 = std::min(width_, (int) ((m.x + m.w) * width_));
+        int y1 = std::min(height_, (int) ((m.y + m.h) * height_));
+        for (int y = y0; y < y1; y++)
+            memset(y_plane + (size_t) y * width_ + x0, 200, x1 - x0);
+
+        // a distinct color per class
+        uint8_t u = (uint8_t) (64 + (m.index * 37) % 128);
+        uint8_t v = (uint8_t) (64 + (m.index * 71) % 128);
+        for (int y = y0 / 2; y < y1 / 2; y++) {
+            memset(u_plane + (size_t) y * (width_ / 2) + x0 / 2, u, (x1 - x0) / 2);
+            memset(v_plane + (size_t) y * (width_ / 2) + x0 / 2, v, (x1 - x0) / 2);
+        }
+
+        DetectedObject obj;
+        obj.rect = Box(m.x, m.y, m.w, m.h);
+        obj.index = m.index;
+        obj.confidence = 1.f;
+        objects_.push_back(obj);
+    }
+
+    frame.planes.y = y_plane;
+    frame.planes.u = u_plane;
+    frame.planes.v = v_plane;
+    frame.planes.width = width_;
+    frame.planes.height = height_;
+    frame.planes.y_row_stride = width_;
+    frame.planes.uv_row_stride = width_ / 2;
+    frame.planes.uv_pixel_stride = 1;
+    frame.rotation = 0;
+    frame.timestamp = frame_ * frame_interval_ns_;
+
+    frame_++;
+    return true;
+}
@@ -0,0 +1,77 @@
+//
+// Sources of camera frames for the native pipeline: the live camera, recordings and synthetic
+// patterns, so that a session can be replayed frame for frame on a host.
+//
+
+#ifndef ANDROID_FRAME_SOURCE_H
+#define ANDROID_FRAME_SOURCE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ultralytics.h"
+
+// One YUV_420_888 camera image, chroma planes subsampled by two
+struct YuvPlanes {
+    const uint8_t *y;
+    const uint8_t *u;
+    const uint8_t *v;
+    int width;
+    int height;
+    int y_row_stride;
+    int uv_row_stride;
+    int uv_pixel_stride;
+};
+
+struct Frame {
+    YuvPlanes planes;
+    // clockwise rotation to the display orientation, in degrees
+    int rotation;
+    // System.nanoTime() clock for live frames
+    int64_t timestamp;
+};
+
+// Pull based source. The planes of a frame stay valid until the next call.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // Returns false once the source is exhausted.
+    virtual bool next(Frame &frame) = 0;
+};
+
+// Deterministic frames of objects moving over a gradient, with their ground truth boxes.
+class SyntheticFrameSource : public FrameSource {
+public:
+    SyntheticFrameSource(int width, int height, int num_objects, int fps, int64_t num_frames,
+                         uint32_t seed = 1);
+
+    bool next(Frame &frame) override;
+
+    // boxes of the last frame, normalized
+    const std::vector<DetectedObject> &objects() const { return objects_; }
+
+private:
+    struct Mover {
+        float x, y, w, h;
+        float vx, vy;
+        int index;
+    };
+
+    float random();
+
+    int width_;
+    int height_;
+    int64_t frame_interval_ns_;
+    int64_t num_frames_;
+    int64_t frame_ = 0;
+    uint32_t state_;
+
+    std::vector<Mover> movers_;
+    std::vector<DetectedObject> objects_;
+    std::vector<uint8_t> background_;
+    // planar I420
+    std::vector<uint8_t> pixels_;
+};
+
+#endif //ANDROID_FRAME_SOURCE_H
@@ -0,0 +1,83 @@
+//
+// Points, boxes and polygon helpers of the core, free of OpenCV so the decode and NMS path links
+// without it. Same layout and semantics as cv::Point2f and cv::Rect_<float>.
+//
+
+#ifndef ANDROID_GEOMETRY_H
+#define ANDROID_GEOMETRY_H
+
+#include <algorithm>
+#include <vector>
+
+struct Point2f {
+    float x = 0.f;
+    float y = 0.f;
+
+    Point2f() = default;
+
+    Point2f(float x, float y) : x(x), y(y) {}
+};
+
+// top left corner and size, normalized or in pixels depending on the caller
+struct Box {
+    float x = 0.f;
+    float y = 0.f;
+    float width = 0.f;
+    float height = 0.f;
+
+    Box() = default;
+
+    Box(float x, float y, float width, float height) : x(x), y(y), width(width), height(height) {}
+
+    float area() const { return width * height; }
+
+    bool empty() const { return width <= 0.f || height <= 0.f; }
+};
+
+static inline bool operator==(const Box &a, const Box &b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static inline bool operator!=(const Box &a, const Box &b) {
+    return !(a == b);
+}
+
+// the overlap of two boxes, an all zero box when they are disjoint
+static inline Box operator&(const Box &a, const Box &b) {
+    float x1 = std::max(a.x, b.x);
+    float y1 = std::max(a.y, b.y);
+    float x2 = std::min(a.x + a.width, b.x + b.width);
+    float y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1)
+        return Box();
+    return Box(x1, y1, x2 - x1, y2 - y1);
+}
+
+// the smallest box holding both, an empty box counts for nothing
+static inline Box operator|(const Box &a, const Box &b) {
+    if (a.empty())
+        return b;
+    if (b.empty())
+        return a;
+    float x1 = std::min(a.x, b.x);
+    float y1 = std::min(a.y, b.y);
+    float x2 = std::max(a.x + a.width, b.x + b.width);
+    float y2 = std::max(a.y + a.height, b.y + b.height);
+    return Box(x1, y1, x2 - x1, y2 - y1);
+}
+
+// even-odd test, points on the boundary may fall on either side
+static inline bool point_in_polygon(const std::vector<Point2f> &polygon, const Point2f &p) {
+    bool inside = false;
+    const int n = polygon.size();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const Point2f &a = polygon[i];
+        const Point2f &b = polygon[j];
+        if ((a.y > p.y) != (b.y > p.y) &&
+            p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+            inside = !inside;
+    }
+    return inside;
+}
+
+#endif //ANDROID_GEOMETRY_H
@@ -0,0 +1,81 @@
+#include "heatmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd.h"
+
+// rescale the cells once the gain passes 2^20
+static const float MAX_GAIN = 1048576.f;
+
+void Heatmap::configure(int width, int height, int64_t half_life_ns) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    half_life_ns_ = (double) std::max<int64_t>(half_life_ns, 0);
+    cells_.assign((size_t) width_ * height_, 0.f);
+    started_ = false;
+}
+
+float Heatmap::gain(int64_t timestamp) const {
+    if (half_life_ns_ <= 0)
+        return 1.f;
+    return (float) std::exp2((double) (timestamp - epoch_) / half_life_ns_);
+}
+
+void Heatmap::accumulate(const std::vector<DetectedObject> &objects, int64_t timestamp) {
+    if (cells_.empty())
+        return;
+
+    if (!started_) {
+        epoch_ = timestamp;
+        last_timestamp_ = timestamp;
+        started_ = true;
+        return;
+    }
+
+    int64_t dt = std::min(std::max<int64_t>(timestamp - last_timestamp_, 0), max_frame_gap_ns);
+    last_timestamp_ = timestamp;
+    if (dt == 0 || objects.empty())
+        return;
+
+    float g = gain(timestamp);
+    if (g > MAX_GAIN) {
+        scale_inplace(cells_.data(), 1.f / g, (int) cells_.size());
+        epoch_ = timestamp;
+        g = 1.f;
+    }
+    const float weight = (float) (dt * 1e-9) * g;
+
+    for (const DetectedObject &obj: objects) {
+        float top = obj.rect.y + obj.rect.height * (1.f - footprint);
+        float bottom = obj.rect.y + obj.rect.height;
+
+        int x0 = std::max(0, (int) std::floor(obj.rect.x * width_));
+        int x1 = std::min(width_, (int) std::ceil((obj.rect.x + obj.rect.width) * width_));
+        int y0 = std::max(0, (int) std::floor(top * height_));
+        int y1 = std::min(height_, (int) std::ceil(bottom * height_));
+
+        // every object covers at least one cell
+        x1 = std::max(x1, std::min(x0 + 1, width_));
+        y1 = std::max(y1, std::min(y0 + 1, height_));
+
+        for (int y = y0; y < y1; y++)
+            add_scalar(&cells_[(size_t) y * width_ + x0], weight, x1 - x0);
+    }
+}
+
+float Heatmap::snapshot(int64_t timestamp, std::vector<uint8_t> &out) const {
+    out.assign(cells_.size(), 0);
+    if (cells_.empty())
+        return 0.f;
+
+    float peak = *std::max_element(cells_.begin(), cells_.end());
+    if (peak <= 0.f)
+        return 0.f;
+
+    const float scale = 255.f / peak;
+    for (size_t i = 0; i < cells_.size(); i++)
+        out[i] = (uint8_t) std::lround(cells_[i] * scale);
+
+    return peak / gain(timestamp);
+}
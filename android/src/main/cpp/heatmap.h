@@ -0,0 +1,53 @@
+//
+// Occupancy heatmap of detection footprints with exponential decay.
+//
+
+#ifndef ANDROID_HEATMAP_H
+#define ANDROID_HEATMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ultralytics.h"
+
+class Heatmap {
+public:
+    // A zero sized grid disables the heatmap. A zero half life keeps the heat forever.
+    void configure(int width, int height, int64_t half_life_ns);
+
+    bool enabled() const { return !cells_.empty(); }
+
+    int width() const { return width_; }
+
+    int height() const { return height_; }
+
+    // Adds the time since the previous frame to the cells under the footprint of every object.
+    void accumulate(const std::vector<DetectedObject> &objects, int64_t timestamp);
+
+    // Writes the heat decayed to `timestamp` scaled so the hottest cell is 255, and returns the
+    // heat of the hottest cell in seconds.
+    float snapshot(int64_t timestamp, std::vector<uint8_t> &out) const;
+
+    // the lower part of the box the object stands on
+    float footprint = 0.2f;
+
+    // longest gap between two frames that is counted as presence
+    int64_t max_frame_gap_ns = 200000000;
+
+private:
+    // 2^((timestamp - epoch_) / half_life_ns_)
+    float gain(int64_t timestamp) const;
+
+    int width_ = 0;
+    int height_ = 0;
+    double half_life_ns_ = 0;
+
+    // Heat is stored multiplied by gain(), so decaying every cell is a single multiplication at
+    // read time instead of a per-cell update. The cells are rescaled before the gain overflows.
+    std::vector<float> cells_;
+    int64_t epoch_ = 0;
+    int64_t last_timestamp_ = 0;
+    bool started_ = false;
+};
+
+#endif //ANDROID_HEATMAP_H
@@ -0,0 +1,31 @@
+//
+// Camera frames handed over from Java as the direct buffers of an ImageProxy.
+//
+
+#ifndef ANDROID_JNI_FRAME_H
+#define ANDROID_JNI_FRAME_H
+
+#include <jni.h>
+
+#include "frame_source.h"
+
+// Wraps the planes without copying, false when a buffer is not direct.
+static inline bool frame_from_planes(JNIEnv *env, jobject y_buffer, jobject u_buffer, jobject v_buffer,
+                                     jint y_row_stride, jint uv_row_stride, jint uv_pixel_stride,
+                                     jint width, jint height, jint rotation, jlong timestamp, Frame &frame) {
+    frame.planes.y = (const uint8_t *) env->GetDirectBufferAddress(y_buffer);
+    frame.planes.u = (const uint8_t *) env->GetDirectBufferAddress(u_buffer);
+    frame.planes.v = (const uint8_t *) env->GetDirectBufferAddress(v_buffer);
+    if (frame.planes.y == NULL || frame.planes.u == NULL || frame.planes.v == NULL)
+        return false;
+    frame.planes.width = width;
+    frame.planes.height = height;
+    frame.planes.y_row_stride = y_row_stride;
+    frame.planes.uv_row_stride = uv_row_stride;
+    frame.planes.uv_pixel_stride = uv_pixel_stride;
+    frame.rotation = rotation;
+    frame.timestamp = timestamp;
+    return true;
+}
+
+#endif //ANDROID_JNI_FRAME_H
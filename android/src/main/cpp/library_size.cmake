@@ -0,0 +1,10 @@
+# Prints the size of the built library, run after linking with -DLIBRARY and -DWITH_OPENCV
+file(SIZE ${LIBRARY} size)
+math(EXPR kilobytes "${size} / 1024")
+if (WITH_OPENCV)
+    set(variant "with OpenCV")
+else ()
+    set(variant "without OpenCV")
+endif ()
+get_filename_component(name ${LIBRARY} NAME)
+message(STATUS "${name} ${variant}: ${kilobytes} KB")
@@ -0,0 +1,57 @@
+#include "memory_budget.h"
+
+#include <atomic>
+
+static std::atomic<size_t> used[MEMORY_SUBSYSTEM_COUNT];
+static std::atomic<size_t> budget{0};
+
+const char *memory_subsystem_name(MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case MEMORY_FRAMES:
+            return "frames";
+        case MEMORY_TENSORS:
+            return "tensors";
+        case MEMORY_SCRATCH:
+            return "scratch";
+        case MEMORY_TRACKER:
+            return "tracker";
+        case MEMORY_HISTORY:
+            return "history";
+        case MEMORY_CACHES:
+            return "caches";
+        default:
+            return "unknown";
+    }
+}
+
+void memory_charge(MemorySubsystem subsystem, size_t bytes) {
+    used[subsystem].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void memory_release(MemorySubsystem subsystem, size_t bytes) {
+    used[subsystem].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+size_t memory_used(MemorySubsystem subsystem) {
+    return used[subsystem].load(std::memory_order_relaxed);
+}
+
+size_t memory_used_total() {
+    size_t total = 0;
+    for (const std::atomic<size_t> &bytes: used)
+        total += bytes.load(std::memory_order_relaxed);
+    return total;
+}
+
+void set_memory_budget(size_t bytes) {
+    budget.store(bytes, std::memory_order_relaxed);
+}
+
+size_t memory_budget() {
+    return budget.load(std::memory_order_relaxed);
+}
+
+bool memory_over_budget() {
+    size_t limit = memory_budget();
+    return limit > 0 && memory_used_total() > limit;
+}
@@ -0,0 +1,82 @@
+//
+// Native memory held by each subsystem, counted by its allocators, and a global budget the
+// subsystems shed memory to stay under.
+//
+
+#ifndef ANDROID_MEMORY_BUDGET_H
+#define ANDROID_MEMORY_BUDGET_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+enum MemorySubsystem {
+    // evidence frames and recording staging
+    MEMORY_FRAMES,
+    // raw model outputs shared with Dart
+    MEMORY_TENSORS,
+    // per-frame scratch arenas
+    MEMORY_SCRATCH,
+    MEMORY_TRACKER,
+    MEMORY_HISTORY,
+    // re-identification galleries
+    MEMORY_CACHES,
+    MEMORY_SUBSYSTEM_COUNT
+};
+
+const char *memory_subsystem_name(MemorySubsystem subsystem);
+
+void memory_charge(MemorySubsystem subsystem, size_t bytes);
+
+void memory_release(MemorySubsystem subsystem, size_t bytes);
+
+// bytes held by a subsystem across all detectors
+size_t memory_used(MemorySubsystem subsystem);
+
+size_t memory_used_total();
+
+// Sets the bytes all subsystems together should stay under, 0 for no limit. Only checked
+// between frames, so it is a target that may be exceeded briefly rather than a hard cap.
+void set_memory_budget(size_t bytes);
+
+size_t memory_budget();
+
+bool memory_over_budget();
+
+// std allocator charging every allocation to subsystem S
+template<typename T, MemorySubsystem S>
+struct CountingAllocator {
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+        typedef CountingAllocator<U, S> other;
+    };
+
+    CountingAllocator() = default;
+
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U, S> &) {}
+
+    T *allocate(size_t n) {
+        T *p = std::allocator<T>().allocate(n);
+        memory_charge(S, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T *p, size_t n) {
+        memory_release(S, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U, S> &) const { return true; }
+
+    template<typename U>
+    bool operator!=(const CountingAllocator<U, S> &) const { return false; }
+};
+
+template<typename T, MemorySubsystem S>
+using CountedVector = std::vector<T, CountingAllocator<T, S>>;
+
+#endif //ANDROID_MEMORY_BUDGET_H
@@ -0,0 +1,127 @@
+//
+// Raw model outputs shared with Dart through dart:ffi without copying.
+//
+
+#include "output_exchange.h"
+
+#include <map>
+#include <mutex>
+
+// One lock for every exchange, it is taken a few times per frame at most
+struct OutputRegistry {
+    std::mutex lock;
+    int64_t next_id = 1;
+    std::map<int64_t, OutputExchange *> exchanges;
+    // acquired slots by token, which keeps their memory alive
+    std::map<int64_t, std::shared_ptr<OutputExchange::Slot>> held;
+
+    static OutputRegistry &instance() {
+        static OutputRegistry registry;
+        return registry;
+    }
+
+    static UltralyticsOutput acquire(int64_t exchange_id) {
+        OutputRegistry &registry = instance();
+        std::lock_guard<std::mutex> guard(registry.lock);
+
+        UltralyticsOutput output = {};
+        auto it = registry.exchanges.find(exchange_id);
+        if (it == registry.exchanges.end() || it->second->ready_ < 0)
+            return output;
+
+        OutputExchange *exchange = it->second;
+        std::shared_ptr<OutputExchange::Slot> slot = exchange->slots_[exchange->ready_];
+        exchange->ready_ = -1;
+        slot->held = true;
+
+        output.data = slot->data.data();
+        output.token = registry.next_id++;
+        output.frame_id = slot->frame_id;
+        output.timestamp = slot->timestamp;
+        output.rows = exchange->rows_;
+        output.cols = exchange->cols_;
+        registry.held[output.token] = std::move(slot);
+        return output;
+    }
+
+    static void release(int64_t token) {
+        OutputRegistry &registry = instance();
+        std::lock_guard<std::mutex> guard(registry.lock);
+
+        auto it = registry.held.find(token);
+        if (it == registry.held.end())
+            return;
+        it->second->held = false;
+        registry.held.erase(it);
+    }
+};
+
+OutputExchange::~OutputExchange() {
+    OutputRegistry &registry = OutputRegistry::instance();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.exchanges.erase(id_);
+}
+
+int64_t OutputExchange::configure(int rows, int cols) {
+    OutputRegistry &registry = OutputRegistry::instance();
+    std::lock_guard<std::mutex> guard(registry.lock);
+
+    if (id_ == 0) {
+        id_ = registry.next_id++;
+        registry.exchanges[id_] = this;
+    }
+
+    if (rows != rows_ || cols != cols_ || slots_.empty()) {
+        // slots still held by Dart live on in the registry
+        slots_.clear();
+        for (int i = 0; i < NUM_SLOTS; i++) {
+            slots_.push_back(std::make_shared<Slot>());
+            slots_.back()->data.resize((size_t) rows * cols);
+        }
+        rows_ = rows;
+        cols_ = cols;
+        writing_ = -1;
+        ready_ = -1;
+    }
+    return id_;
+}
+
+float *OutputExchange::slot_data(int slot) {
+    std::lock_guard<std::mutex> guard(OutputRegistry::instance().lock);
+    if (slot < 0 || slot >= (int) slots_.size())
+        return nullptr;
+    return slots_[slot]->data.data();
+}
+
+int OutputExchange::begin_write() {
+    std::lock_guard<std::mutex> guard(OutputRegistry::instance().lock);
+    writing_ = -1;
+    // an unread output is only overwritten once a newer one is published
+    for (int i = 0; i < (int) slots_.size(); i++) {
+        if (i != ready_ && !slots_[i]->held) {
+            writing_ = i;
+            break;
+        }
+    }
+    return writing_;
+}
+
+void OutputExchange::publish(const float *data, uint32_t frame_id, int64_t timestamp) {
+    std::lock_guard<std::mutex> guard(OutputRegistry::instance().lock);
+    if (writing_ < 0 || slots_[writing_]->data.data() != data)
+        return;
+
+    Slot &slot = *slots_[writing_];
+    slot.frame_id = frame_id;
+    slot.timestamp = timestamp;
+    ready_ = writing_;
+    writing_ = -1;
+}
+
+UltralyticsOutput ultralytics_output_acquire(int64_t exchange_id) {
+    return OutputRegistry::acquire(exchange_id);
+}
+
+void ultralytics_output_release(int64_t token) {
+    OutputRegistry::release(token);
+}
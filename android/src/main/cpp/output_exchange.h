@@ -0,0 +1,77 @@
+//
+// Raw model outputs shared with Dart through dart:ffi without copying.
+//
+
+#ifndef ANDROID_OUTPUT_EXCHANGE_H
+#define ANDROID_OUTPUT_EXCHANGE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "memory_budget.h"
+
+// The model writes straight into one of a few native slots. Once the frame is postprocessed the
+// slot is published, and Dart can acquire the latest one, view it as an external Float32List and
+// release it when done. A held slot is never written, unreleased slots are simply skipped.
+class OutputExchange {
+public:
+    static const int NUM_SLOTS = 3;
+
+    struct Slot {
+        CountedVector<float, MEMORY_TENSORS> data;
+        uint32_t frame_id = 0;
+        int64_t timestamp = 0;
+        bool held = false;
+    };
+
+    ~OutputExchange();
+
+    // Allocates the slots for a [rows][cols] output, and returns the id Dart passes to
+    // ultralytics_output_acquire().
+    int64_t configure(int rows, int cols);
+
+    // the memory of a slot, stable until the next configure() with a different shape
+    float *slot_data(int slot);
+
+    size_t slot_size() const { return (size_t) rows_ * cols_; }
+
+    // Picks the slot the next output is written into, -1 if none is free.
+    int begin_write();
+
+    // Makes the output at `data` the latest one, if it is the slot from begin_write().
+    void publish(const float *data, uint32_t frame_id, int64_t timestamp);
+
+private:
+    friend struct OutputRegistry;
+
+    int64_t id_ = 0;
+    int rows_ = 0;
+    int cols_ = 0;
+    std::vector<std::shared_ptr<Slot>> slots_;
+    int writing_ = -1;
+    int ready_ = -1;
+};
+
+extern "C" {
+
+struct UltralyticsOutput {
+    // null when no new output was published since the last acquire
+    const float *data;
+    // passed back to ultralytics_output_release()
+    int64_t token;
+    int64_t frame_id;
+    int64_t timestamp;
+    int32_t rows;
+    int32_t cols;
+};
+
+// Takes the latest published output of an exchange. It stays valid until released, even if the
+// detector is disposed in the meantime.
+__attribute__((visibility("default"))) UltralyticsOutput ultralytics_output_acquire(int64_t exchange_id);
+
+__attribute__((visibility("default"))) void ultralytics_output_release(int64_t token);
+
+}
+
+#endif //ANDROID_OUTPUT_EXCHANGE_H
@@ -0,0 +1,56 @@
+//
+// Per-detector native state kept alive between frames.
+//
+
+#ifndef ANDROID_PIPELINE_H
+#define ANDROID_PIPELINE_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "atomic_config.h"
+#include "custom_postprocessor.h"
+#include "detection_log.h"
+#include "frame_buffer.h"
+#include "frame_recording.h"
+#include "heatmap.h"
+#include "output_exchange.h"
+#include "postprocess.h"
+#include "predictor.h"
+#include "reid.h"
+#include "roi_mask.h"
+#include "rule_engine.h"
+#include "smoothing.h"
+#include "track_history.h"
+#include "tracker.h"
+#include "zoom_controller.h"
+
+struct Pipeline {
+    // settings read by every frame, changed without taking the lock
+    AtomicConfig<PostprocessConfig> config;
+    std::mutex lock;
+    RoiMask roi_mask;
+    Tracker tracker;
+    Smoother smoother;
+    RuleEngine rule_engine;
+    ZoomController zoom_controller;
+    ReIdentifier reid;
+    TrackHistory history;
+    Heatmap heatmap;
+    FrameBuffer frames;
+    FrameRecorder recorder;
+    DetectionLog log;
+    OutputExchange outputs;
+    // the selected custom postprocessor, null for the built-in decoding. Frames in flight keep
+    // their own reference and call it without the lock.
+    std::shared_ptr<CustomPostprocessor> postprocessor;
+    // preprocessing and decoding of the loaded model, frames in flight keep their own reference
+    std::shared_ptr<const Detector> detector;
+    // live frames postprocessed so far
+    uint32_t frame_id = 0;
+    // rule events waiting to be drained by the Java side
+    std::vector<RuleEvent> events;
+};
+
+#endif //ANDROID_PIPELINE_H
@@ -0,0 +1,196 @@
+#include "postprocess.h"
+
+#include <algorithm>
+
+// Indices into `sorted`, which is ordered by confidence, of the boxes that survive NMS. Stops
+// once `max_picked` are found, later boxes could only come after them.
+static void nms_sorted_bboxes(const Detections &sorted, std::vector<int> &picked, float nms_threshold,
+                              NmsMode mode, int max_picked) {
+    picked.clear();
+
+    const int n = (int) sorted.size();
+    const float *x1 = sorted.x1();
+    const float *y1 = sorted.y1();
+    const float *x2 = sorted.x2();
+    const float *y2 = sorted.y2();
+    const int32_t *classes = sorted.class_index();
+
+    // the picked boxes in their own columns, so the overlap test is one branch free loop
+    static thread_local std::vector<float> px1, py1, px2, py2, parea;
+    static thread_local std::vector<int32_t> pclass;
+    for (std::vector<float> *column: {&px1, &py1, &px2, &py2, &parea})
+        column->clear();
+    pclass.clear();
+
+    for (int i = 0; i < n && (int) picked.size() < max_picked; i++) {
+        const float ax1 = x1[i], ay1 = y1[i], ax2 = x2[i], ay2 = y2[i];
+        const float area = (ax2 - ax1) * (ay2 - ay1);
+        const int32_t c = classes[i];
+        const int count = (int) px1.size();
+
+        int suppressed = 0;
+        for (int j = 0; j < count; j++) {
+            float w = std::max(0.f, std::min(ax2, px2[j]) - std::max(ax1, px1[j]));
+            float h = std::max(0.f, std::min(ay2, py2[j]) - std::max(ay1, py1[j]));
+            float inter = w * h;
+            // intersection over union above the threshold, without the division
+            int overlap = inter > nms_threshold * (area + parea[j] - inter);
+            if (mode == NMS_PER_CLASS)
+                overlap &= pclass[j] == c;
+            suppressed |= overlap;
+        }
+
+        if (!suppressed) {
+            picked.push_back(i);
+            px1.push_back(ax1);
+            py1.push_back(ay1);
+            px2.push_back(ax2);
+            py2.push_back(ay2);
+            parea.push_back(area);
+            pclass.push_back(c);
+        }
+    }
+}
+
+// Anchors decoded together, one word of the anchor mask.
+static const int DECODE_BLOCK = 64;
+
+// Finds the best class of `count` consecutive anchors from `first` and appends those above the
+// threshold whose mask bit is set. The class loop runs over contiguous scores of the block with
+// a branch free update, so with NC and COUNT known at compile time it unrolls and vectorizes.
+// Ties keep the lowest class, like a scan of each anchor.
+template<int NC, int COUNT>
+static inline void decode_block(const float *output, int num_anchors, int runtime_classes, int first,
+                                int runtime_count, float threshold, uint64_t bits, Detections &proposals) {
+    const int num_classes = NC > 0 ? NC : runtime_classes;
+    const int count = COUNT > 0 ? COUNT : runtime_count;
+    const float *scores = output + (size_t) 4 * num_anchors + first;
+
+    float best[DECODE_BLOCK];
+    int32_t best_class[DECODE_BLOCK];
+    for (int j = 0; j < count; j++) {
+        best[j] = scores[j];
+        best_class[j] = 0;
+    }
+    for (int c = 1; c < num_classes; c++) {
+        const float *row = scores + (size_t) c * num_anchors;
+        for (int j = 0; j < count; j++) {
+            float score = row[j];
+            int32_t higher = -(int32_t) (score > best[j]);
+            best[j] = score > best[j] ? score : best[j];
+            best_class[j] = (c & higher) | (best_class[j] & ~higher);
+        }
+    }
+
+    for (int j = 0; j < count; j++) {
+        if (!((bits >> j) & 1) || !(best[j] > threshold))
+            continue;
+        int i = first + j;
+        float cx = output[i];
+        float cy = output[num_anchors + i];
+        float w = output[2 * num_anchors + i];
+        float h = output[3 * num_anchors + i];
+        proposals.push_back(cx - w / 2, cy - h / 2, cx + w / 2, cy + h / 2, best[j], best_class[j]);
+    }
+}
+
+// NC is the class count the kernel is specialized for, 0 for any
+template<int NC>
+static void decode(const float *output, int num_anchors, int num_classes, float threshold,
+                   const std::vector<uint64_t> *anchor_mask, Detections &proposals) {
+    if (num_classes <= 0)
+        return;
+
+    const int num_blocks = (num_anchors + DECODE_BLOCK - 1) / DECODE_BLOCK;
+    for (int b = 0; b < num_blocks; b++) {
+        // blocks without a single anchor in the mask are skipped whole
+        uint64_t bits = ~0ull;
+        if (anchor_mask != nullptr)
+            bits = b < (int) anchor_mask->size() ? (*anchor_mask)[b] : 0;
+        if (bits == 0)
+            continue;
+
+        int first = b * DECODE_BLOCK;
+        int count = std::min(DECODE_BLOCK, num_anchors - first);
+        if (count == DECODE_BLOCK)
+            decode_block<NC, DECODE_BLOCK>(output, num_anchors, num_classes, first, count, threshold, bits, proposals);
+        else
+            decode_block<NC, 0>(output, num_anchors, num_classes, first, count, threshold, bits, proposals);
+    }
+}
+
+DecodeKernel decode_kernel(int num_classes, bool specialized) {
+#if ULTRALYTICS_DECODE_SPECIALIZATIONS
+    if (specialized) {
+        switch (num_classes) {
+            case 1:
+                return decode<1>;
+            case 2:
+                return decode<2>;
+            case 80:
+                return decode<80>;
+            case 365:
+                return decode<365>;
+            case 600:
+                return decode<600>;
+            default:
+                break;
+        }
+    }
+#endif
+    return decode<0>;
+}
+
+void generate_proposals(const float *output, int num_anchors, int num_classes,
+                        float confidence_threshold, const std::vector<uint64_t> *anchor_mask,
+                        Detections &proposals) {
+    decode_kernel(num_classes)(output, num_anchors, num_classes, confidence_threshold, anchor_mask, proposals);
+}
+
+void select_detections(const Detections &proposals, const PostprocessConfig &config, Detections &selected) {
+    static thread_local std::vector<int> order;
+    static thread_local std::vector<int> picked;
+    static thread_local Detections sorted;
+
+    const float *scores = proposals.score();
+    const int32_t *classes = proposals.class_index();
+
+    order.clear();
+    if (config.classes.empty()) {
+        for (int i = 0; i < (int) proposals.size(); i++)
+            order.push_back(i);
+    } else {
+        const std::vector<uint8_t> &filter = config.classes;
+        for (int i = 0; i < (int) proposals.size(); i++) {
+            if (classes[i] >= 0 && classes[i] < (int) filter.size() && filter[classes[i]])
+                order.push_back(i);
+        }
+    }
+
+    // by confidence, ties by position so the order does not depend on the sort
+    auto higher = [scores](int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    };
+
+    if (config.max_proposals > 0 && (int) order.size() > config.max_proposals) {
+        // only the kept proposals need sorting
+        std::nth_element(order.begin(), order.begin() + config.max_proposals, order.end(), higher);
+        order.resize(config.max_proposals);
+    }
+    std::sort(order.begin(), order.end(), higher);
+
+    proposals.gather(order.data(), order.size(), sorted);
+    nms_sorted_bboxes(sorted, picked, config.iou_threshold, config.nms_mode, config.max_detections);
+    sorted.gather(picked.data(), picked.size(), selected);
+
+    float *x1 = selected.x1();
+    float *y1 = selected.y1();
+    float *x2 = selected.x2();
+    float *y2 = selected.y2();
+    for (size_t i = 0; i < selected.size(); i++) {
+        x1[i] = std::max(0.f, x1[i]);
+        y1[i] = std::max(0.f, y1[i]);
+        x2[i] = std::min(1.f, x2[i]);
+        y2[i] = std::min(1.f, y2[i]);
+    }
+}
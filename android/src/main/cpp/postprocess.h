@@ -0,0 +1,56 @@
+//
+// Decoding of the YOLO detection output and non maximum suppression.
+//
+
+#ifndef ANDROID_POSTPROCESS_H
+#define ANDROID_POSTPROCESS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "detections.h"
+
+enum NmsMode {
+    // boxes suppress each other whatever their class
+    NMS_AGNOSTIC = 0,
+    // boxes only suppress boxes of the same class
+    NMS_PER_CLASS = 1,
+};
+
+struct PostprocessConfig {
+    float confidence_threshold = 0.25f;
+    float iou_threshold = 0.45f;
+    int max_detections = 30;
+    // proposals kept for NMS, highest confidence first, zero keeps all
+    int max_proposals = 0;
+    NmsMode nms_mode = NMS_AGNOSTIC;
+    // non zero for the classes reported, indexed by class, empty reports all
+    std::vector<uint8_t> classes;
+};
+
+// Decoders specialized for the class counts of common models: single class, two classes, COCO,
+// Objects365 and Open Images V7. Other counts use the generic decoder.
+#ifndef ULTRALYTICS_DECODE_SPECIALIZATIONS
+#define ULTRALYTICS_DECODE_SPECIALIZATIONS 1
+#endif
+
+// Decodes proposals like generate_proposals().
+typedef void (*DecodeKernel)(const float *output, int num_anchors, int num_classes, float confidence_threshold,
+                             const std::vector<uint64_t> *anchor_mask, Detections &proposals);
+
+// The decoder for a class count, picked once per model. Without `specialized` it is the generic
+// one, for comparisons.
+DecodeKernel decode_kernel(int num_classes, bool specialized = true);
+
+// Appends the anchors of a row-major [4 + num_classes][num_anchors] output whose best class
+// score passes the threshold, as corner boxes normalized to the model input. With
+// `anchor_mask`, only anchors whose bit is set are decoded.
+void generate_proposals(const float *output, int num_anchors, int num_classes,
+                        float confidence_threshold, const std::vector<uint64_t> *anchor_mask,
+                        Detections &proposals);
+
+// Drops proposals of filtered classes, orders the rest by confidence, caps them, suppresses
+// overlaps and writes at most max_detections rows clamped to [0, 1], most confident first.
+void select_detections(const Detections &proposals, const PostprocessConfig &config, Detections &selected);
+
+#endif //ANDROID_POSTPROCESS_H
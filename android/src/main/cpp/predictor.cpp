@@ -0,0 +1,92 @@
+#include "predictor.h"
+
+#include <algorithm>
+
+#include "preprocess.h"
+
+Predictor::Predictor(int input_size, size_t output_length)
+        : input_size_(input_size), output_length_(output_length) {}
+
+void Predictor::preprocess(const Frame &frame, const Box &roi, float *input) const {
+    yuv420_crop_resize_rgb(frame, roi, input, input_size_, input_size_);
+}
+
+void Predictor::preprocess(const uint32_t *argb, float *input) const {
+    argb_to_rgb(argb, (size_t) input_size_ * input_size_, input);
+}
+
+bool Predictor::predict(InferenceBackend &backend, const Frame &frame, const Box &roi) {
+    // allocated on first use, so predictors driven stage by stage never hold them
+    input_.resize(input_length());
+    output_.resize(output_length_);
+
+    preprocess(frame, roi, input_.data());
+    if (!backend.invoke(input_.data(), output_.data()))
+        return false;
+    postprocess(output_.data(), roi);
+    return true;
+}
+
+static void map_to_frame(const Box &roi, DetectedObject *begin, DetectedObject *end) {
+    for (DetectedObject *obj = begin; obj != end; obj++) {
+        obj->rect.x = roi.x + obj->rect.x * roi.width;
+        obj->rect.y = roi.y + obj->rect.y * roi.height;
+        obj->rect.width *= roi.width;
+        obj->rect.height *= roi.height;
+    }
+}
+
+void map_to_frame(const Box &roi, std::vector<DetectedObject> &objects) {
+    map_to_frame(roi, objects.data(), objects.data() + objects.size());
+}
+
+Detector::Detector(int input_size, int num_classes, int num_anchors)
+        : Predictor(input_size, (size_t) (4 + num_classes) * num_anchors),
+          num_classes_(num_classes), num_anchors_(num_anchors), kernel_(decode_kernel(num_classes)) {}
+
+void Detector::postprocess(const float *output, const Box &roi) {
+    proposals_.clear();
+    objects_.clear();
+    decode(output, config_.confidence_threshold, nullptr, proposals_);
+    select(proposals_, config_, roi, objects_);
+}
+
+void Detector::decode(const float *output, float confidence_threshold, const std::vector<uint64_t> *anchor_mask,
+                      Detections &proposals) const {
+    kernel_(output, num_anchors_, num_classes_, confidence_threshold, anchor_mask, proposals);
+}
+
+void Detector::select(const Detections &proposals, const PostprocessConfig &config, const Box &roi,
+                      std::vector<DetectedObject> &objects) const {
+    // reused between frames of the same thread
+    static thread_local Detections selected;
+
+    const size_t first = objects.size();
+    select_detections(proposals, config, selected);
+    selected.append_objects(objects);
+    map_to_frame(roi, objects.data() + first, objects.data() + objects.size());
+}
+
+Classifier::Classifier(int input_size, int num_classes)
+        : Predictor(input_size, num_classes), num_classes_(num_classes) {}
+
+// class probabilities do not depend on where in the frame the input came from
+void Classifier::postprocess(const float *output, const Box & /* roi */) {
+    top_k(output, top_k_, classes_);
+}
+
+void Classifier::top_k(const float *output, int k, std::vector<Classification> &classes) const {
+    if (k <= 0 || k > num_classes_)
+        k = num_classes_;
+
+    classes.resize(num_classes_);
+    for (int i = 0; i < num_classes_; i++)
+        classes[i] = {i, output[i]};
+
+    // only the reported classes need sorting
+    std::partial_sort(classes.begin(), classes.begin() + k, classes.end(),
+                      [](const Classification &a, const Classification &b) {
+                          return a.confidence > b.confidence || (a.confidence == b.confidence && a.index < b.index);
+                      });
+    classes.resize(k);
+}
@@ -0,0 +1,134 @@
+//
+// Per task model pipelines: a camera frame turned into the model input, the model run on a
+// backend and its raw output decoded into results, one implementation for every platform.
+//
+
+#ifndef ANDROID_PREDICTOR_H
+#define ANDROID_PREDICTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "detections.h"
+#include "frame_source.h"
+#include "geometry.h"
+#include "postprocess.h"
+#include "ultralytics.h"
+
+// Runs the model. Platforms whose interpreter only has a managed API call the predictor stages
+// around it instead.
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    // Runs the model on an interleaved float RGB input into `output`, false on failure.
+    virtual bool invoke(const float *input, float *output) = 0;
+};
+
+// The preprocess and postprocess stages of one model, with the model input always a square of
+// interleaved float RGB in [0, 1].
+class Predictor {
+public:
+    Predictor(int input_size, size_t output_length);
+
+    virtual ~Predictor() = default;
+
+    int input_size() const { return input_size_; }
+
+    // floats of one model input
+    size_t input_length() const { return (size_t) input_size_ * input_size_ * 3; }
+
+    // floats of one model output
+    size_t output_length() const { return output_length_; }
+
+    // Fills `input` with the `roi` region (normalized, in the display orientation) of a frame.
+    void preprocess(const Frame &frame, const Box &roi, float *input) const;
+
+    // Fills `input` from packed 0xAARRGGBB pixels already scaled to the input size.
+    void preprocess(const uint32_t *argb, float *input) const;
+
+    // Decodes the output of an input holding the `roi` region of the frame. The results are kept
+    // until the next call.
+    virtual void postprocess(const float *output, const Box &roi) = 0;
+
+    // All stages, on buffers owned by the predictor. Returns false when the backend fails, the
+    // results of the previous frame are kept then.
+    bool predict(InferenceBackend &backend, const Frame &frame, const Box &roi);
+
+private:
+    const int input_size_;
+    const size_t output_length_;
+    std::vector<float> input_;
+    std::vector<float> output_;
+};
+
+// Maps objects from the model input holding the `roi` region back to the full frame.
+void map_to_frame(const Box &roi, std::vector<DetectedObject> &objects);
+
+// [4 + num_classes][num_anchors] outputs, boxes as centers and sizes normalized to the input.
+class Detector : public Predictor {
+public:
+    Detector(int input_size, int num_classes, int num_anchors);
+
+    int num_classes() const { return num_classes_; }
+
+    int num_anchors() const { return num_anchors_; }
+
+    // Settings of the following postprocess() calls.
+    void configure(const PostprocessConfig &config) { config_ = config; }
+
+    void postprocess(const float *output, const Box &roi) override;
+
+    const std::vector<DetectedObject> &objects() const { return objects_; }
+
+    // The two halves of postprocess(), for callers holding their own settings. Both are const
+    // and may run on several threads at once.
+
+    // Appends the anchors above the threshold, only those whose bit is set with `anchor_mask`.
+    void decode(const float *output, float confidence_threshold, const std::vector<uint64_t> *anchor_mask,
+                Detections &proposals) const;
+
+    // Suppresses overlapping proposals and appends the rest to `objects`, mapped to the frame.
+    void select(const Detections &proposals, const PostprocessConfig &config, const Box &roi,
+                std::vector<DetectedObject> &objects) const;
+
+private:
+    const int num_classes_;
+    const int num_anchors_;
+    // picked once for the class count
+    const DecodeKernel kernel_;
+    PostprocessConfig config_;
+    Detections proposals_;
+    std::vector<DetectedObject> objects_;
+};
+
+struct Classification {
+    int index;
+    float confidence;
+};
+
+// [num_classes] outputs of class probabilities.
+class Classifier : public Predictor {
+public:
+    Classifier(int input_size, int num_classes);
+
+    int num_classes() const { return num_classes_; }
+
+    // Classes reported by postprocess(), zero reports all.
+    void set_top_k(int k) { top_k_ = k; }
+
+    void postprocess(const float *output, const Box &roi) override;
+
+    const std::vector<Classification> &classes() const { return classes_; }
+
+    // Replaces `classes` with the `k` most probable classes, most probable first, ties by index.
+    void top_k(const float *output, int k, std::vector<Classification> &classes) const;
+
+private:
+    const int num_classes_;
+    int top_k_ = 0;
+    std::vector<Classification> classes_;
+};
+
+#endif //ANDROID_PREDICTOR_H
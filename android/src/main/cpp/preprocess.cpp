@@ -0,0 +1,216 @@
+#include "preprocess.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "cpu_features.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if ULTRALYTICS_DISPATCH_AVX2
+#include <immintrin.h>
+#endif
+
+void crop_resize_rgb(const float *src, int src_w, int src_h, const Box &roi,
+                     float *dst, int dst_w, int dst_h) {
+    const float x0 = roi.x * src_w;
+    const float y0 = roi.y * src_h;
+    const float sx = roi.width * src_w / dst_w;
+    const float sy = roi.height * src_h / dst_h;
+
+    for (int y = 0; y < dst_h; y++) {
+        float fy = std::min(std::max(y0 + (y + 0.5f) * sy - 0.5f, 0.f), (float) (src_h - 1));
+        int iy = (int) fy;
+        int iy1 = std::min(iy + 1, src_h - 1);
+        float wy = fy - iy;
+
+        const float *row0 = src + (size_t) iy * src_w * 3;
+        const float *row1 = src + (size_t) iy1 * src_w * 3;
+        float *out = dst + (size_t) y * dst_w * 3;
+
+        for (int x = 0; x < dst_w; x++) {
+            float fx = std::min(std::max(x0 + (x + 0.5f) * sx - 0.5f, 0.f), (float) (src_w - 1));
+            int ix = (int) fx;
+            int ix1 = std::min(ix + 1, src_w - 1);
+            float wx = fx - ix;
+
+            for (int c = 0; c < 3; c++) {
+                float top = row0[ix * 3 + c] + (row0[ix1 * 3 + c] - row0[ix * 3 + c]) * wx;
+                float bottom = row1[ix * 3 + c] + (row1[ix1 * 3 + c] - row1[ix * 3 + c]) * wx;
+                out[x * 3 + c] = top + (bottom - top) * wy;
+            }
+        }
+    }
+}
+
+// The vector paths do the same operations in the same order as yuv_to_rgb_pixel(), and max(0, v)
+// and min(255, v) select like its std::max and std::min for every value 8 bit planes can produce
+// (never NaN or -0), so every path gives bit identical output. GCC keeps those float selects as
+// branches, which mispredict on camera data. The file is built with -ffp-contract=off, otherwise
+// the compiler may fuse a multiply and add in one path and not in another.
+#if defined(__SSE2__)
+// Interleaves four pixels of planar r, g, b into out[0..11].
+static ULTRALYTICS_ALWAYS_INLINE void store_rgb4(float *out, __m128 r, __m128 g, __m128 b) {
+    __m128 rg_lo = _mm_unpacklo_ps(r, g);
+    __m128 rg_hi = _mm_unpackhi_ps(r, g);
+    __m128 gb_lo = _mm_unpacklo_ps(g, b);
+    __m128 gb_hi = _mm_unpackhi_ps(g, b);
+    __m128 b0r1 = _mm_shuffle_ps(b, r, _MM_SHUFFLE(0, 1, 0, 0));
+    __m128 b2r3 = _mm_shuffle_ps(gb_hi, rg_hi, _MM_SHUFFLE(2, 2, 1, 1));
+    _mm_storeu_ps(out, _mm_shuffle_ps(rg_lo, b0r1, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(gb_lo, rg_hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(b2r3, gb_hi, _MM_SHUFFLE(3, 2, 2, 0)));
+}
+#endif
+
+// Converts `n` pixels from planar luma and centered chroma to interleaved RGB.
+static void yuv_to_rgb_baseline(const float *luma, const float *cb, const float *cr, float *out, int n) {
+    int x = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.f);
+    const float32x4_t max = vdupq_n_f32(255.f);
+    const float32x4_t scale = vdupq_n_f32(1.f / 255.f);
+    for (; x + 4 <= n; x += 4) {
+        float32x4_t l = vld1q_f32(luma + x);
+        float32x4_t u = vld1q_f32(cb + x);
+        float32x4_t v = vld1q_f32(cr + x);
+        float32x4_t r = vaddq_f32(l, vmulq_f32(vdupq_n_f32(1.402f), v));
+        float32x4_t g = vsubq_f32(vsubq_f32(l, vmulq_f32(vdupq_n_f32(0.344136f), u)),
+                                  vmulq_f32(vdupq_n_f32(0.714136f), v));
+        float32x4_t b = vaddq_f32(l, vmulq_f32(vdupq_n_f32(1.772f), u));
+
+        float32x4x3_t rgb;
+        rgb.val[0] = vmulq_f32(vminq_f32(max, vmaxq_f32(zero, r)), scale);
+        rgb.val[1] = vmulq_f32(vminq_f32(max, vmaxq_f32(zero, g)), scale);
+        rgb.val[2] = vmulq_f32(vminq_f32(max, vmaxq_f32(zero, b)), scale);
+        vst3q_f32(out + x * 3, rgb);
+    }
+#elif defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 max = _mm_set1_ps(255.f);
+    const __m128 scale = _mm_set1_ps(1.f / 255.f);
+    for (; x + 4 <= n; x += 4) {
+        __m128 l = _mm_loadu_ps(luma + x);
+        __m128 u = _mm_loadu_ps(cb + x);
+        __m128 v = _mm_loadu_ps(cr + x);
+        __m128 r = _mm_add_ps(l, _mm_mul_ps(_mm_set1_ps(1.402f), v));
+        __m128 g = _mm_sub_ps(_mm_sub_ps(l, _mm_mul_ps(_mm_set1_ps(0.344136f), u)),
+                              _mm_mul_ps(_mm_set1_ps(0.714136f), v));
+        __m128 b = _mm_add_ps(l, _mm_mul_ps(_mm_set1_ps(1.772f), u));
+
+        store_rgb4(out + x * 3,
+                   _mm_mul_ps(_mm_min_ps(max, _mm_max_ps(zero, r)), scale),
+                   _mm_mul_ps(_mm_min_ps(max, _mm_max_ps(zero, g)), scale),
+                   _mm_mul_ps(_mm_min_ps(max, _mm_max_ps(zero, b)), scale));
+    }
+#endif
+    for (; x < n; x++)
+        yuv_to_rgb_pixel(luma[x], cb[x], cr[x], out + x * 3);
+}
+
+#if ULTRALYTICS_DISPATCH_AVX2
+// Eight pixels per step, interleaved as two halves.
+static ULTRALYTICS_TARGET_AVX2 void yuv_to_rgb_avx2(const float *luma, const float *cb, const float *cr,
+                                                    float *out, int n) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 max = _mm256_set1_ps(255.f);
+    const __m256 scale = _mm256_set1_ps(1.f / 255.f);
+    int x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m256 l = _mm256_loadu_ps(luma + x);
+        __m256 u = _mm256_loadu_ps(cb + x);
+        __m256 v = _mm256_loadu_ps(cr + x);
+        __m256 r = _mm256_add_ps(l, _mm256_mul_ps(_mm256_set1_ps(1.402f), v));
+        __m256 g = _mm256_sub_ps(_mm256_sub_ps(l, _mm256_mul_ps(_mm256_set1_ps(0.344136f), u)),
+                                 _mm256_mul_ps(_mm256_set1_ps(0.714136f), v));
+        __m256 b = _mm256_add_ps(l, _mm256_mul_ps(_mm256_set1_ps(1.772f), u));
+        r = _mm256_mul_ps(_mm256_min_ps(max, _mm256_max_ps(zero, r)), scale);
+        g = _mm256_mul_ps(_mm256_min_ps(max, _mm256_max_ps(zero, g)), scale);
+        b = _mm256_mul_ps(_mm256_min_ps(max, _mm256_max_ps(zero, b)), scale);
+
+        store_rgb4(out + x * 3, _mm256_castps256_ps128(r), _mm256_castps256_ps128(g), _mm256_castps256_ps128(b));
+        store_rgb4(out + x * 3 + 12, _mm256_extractf128_ps(r, 1), _mm256_extractf128_ps(g, 1),
+                   _mm256_extractf128_ps(b, 1));
+    }
+    yuv_to_rgb_baseline(luma + x, cb + x, cr + x, out + x * 3, n - x);
+}
+#endif
+
+typedef void (*YuvToRgbKernel)(const float *luma, const float *cb, const float *cr, float *out, int n);
+
+static YuvToRgbKernel yuv_to_rgb_kernel() {
+#if ULTRALYTICS_DISPATCH_AVX2
+    if (cpu_extensions().avx2)
+        return yuv_to_rgb_avx2;
+#endif
+    return yuv_to_rgb_baseline;
+}
+
+void yuv420_crop_resize_rgb(const Frame &frame, const Box &roi,
+                            float *dst, int dst_w, int dst_h) {
+    const YuvPlanes &p = frame.planes;
+    const int rotation = ((frame.rotation % 360) + 360) % 360;
+    const bool transposed = rotation == 90 || rotation == 270;
+
+    // Rotations by multiples of 90° keep the mapping separable: every output row and column adds
+    // a fixed offset into the luma and chroma planes.
+    std::vector<size_t> row_offsets(dst_h * 2);
+    std::vector<size_t> col_offsets(dst_w * 2);
+
+    for (int y = 0; y < dst_h; y++) {
+        float v = roi.y + (y + 0.5f) * roi.height / dst_h;
+        size_t *offset = &row_offsets[y * 2];
+        if (!transposed) {
+            int sy = std::min(std::max((int) ((rotation == 180 ? 1.f - v : v) * p.height), 0), p.height - 1);
+            offset[0] = (size_t) sy * p.y_row_stride;
+            offset[1] = (size_t) (sy / 2) * p.uv_row_stride;
+        } else {
+            int sx = std::min(std::max((int) ((rotation == 270 ? 1.f - v : v) * p.width), 0), p.width - 1);
+            offset[0] = sx;
+            offset[1] = (size_t) (sx / 2) * p.uv_pixel_stride;
+        }
+    }
+
+    for (int x = 0; x < dst_w; x++) {
+        float u = roi.x + (x + 0.5f) * roi.width / dst_w;
+        size_t *offset = &col_offsets[x * 2];
+        if (!transposed) {
+            int sx = std::min(std::max((int) ((rotation == 180 ? 1.f - u : u) * p.width), 0), p.width - 1);
+            offset[0] = sx;
+            offset[1] = (size_t) (sx / 2) * p.uv_pixel_stride;
+        } else {
+            int sy = std::min(std::max((int) ((rotation == 90 ? 1.f - u : u) * p.height), 0), p.height - 1);
+            offset[0] = (size_t) sy * p.y_row_stride;
+            offset[1] = (size_t) (sy / 2) * p.uv_row_stride;
+        }
+    }
+
+    static const YuvToRgbKernel convert = yuv_to_rgb_kernel();
+    std::vector<float> luma(dst_w), cb(dst_w), cr(dst_w);
+
+    for (int y = 0; y < dst_h; y++) {
+        const uint8_t *y_row = p.y + row_offsets[y * 2];
+        const uint8_t *u_row = p.u + row_offsets[y * 2 + 1];
+        const uint8_t *v_row = p.v + row_offsets[y * 2 + 1];
+
+        for (int x = 0; x < dst_w; x++) {
+            luma[x] = y_row[col_offsets[x * 2]];
+            cb[x] = u_row[col_offsets[x * 2 + 1]] - 128.f;
+            cr[x] = v_row[col_offsets[x * 2 + 1]] - 128.f;
+        }
+        convert(luma.data(), cb.data(), cr.data(), dst + (size_t) y * dst_w * 3, dst_w);
+    }
+}
+
+void argb_to_rgb(const uint32_t *src, size_t count, float *dst) {
+    // divides rather than scales, the same values as Bitmap based preprocessing
+    for (size_t i = 0; i < count; i++) {
+        uint32_t pixel = src[i];
+        dst[i * 3] = (float) ((pixel >> 16) & 0xFF) / 255.f;
+        dst[i * 3 + 1] = (float) ((pixel >> 8) & 0xFF) / 255.f;
+        dst[i * 3 + 2] = (float) (pixel & 0xFF) / 255.f;
+    }
+}
@@ -0,0 +1,39 @@
+//
+// Image helpers working on the float RGB model input.
+//
+
+#ifndef ANDROID_PREPROCESS_H
+#define ANDROID_PREPROCESS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "frame_source.h"
+#include "geometry.h"
+
+// Bilinear resize of the `roi` region (normalized) of an interleaved float RGB image.
+void crop_resize_rgb(const float *src, int src_w, int src_h, const Box &roi,
+                     float *dst, int dst_w, int dst_h);
+
+// Nearest neighbour resize of the `roi` region (normalized, in the display orientation) of a
+// camera frame into interleaved float RGB in [0, 1], converted with full range BT.601.
+void yuv420_crop_resize_rgb(const Frame &frame, const Box &roi,
+                            float *dst, int dst_w, int dst_h);
+
+// Full range BT.601 conversion of one pixel to RGB in [0, 1], from luma and chroma centered on
+// zero. The reference the vector paths of yuv420_crop_resize_rgb() match bit for bit.
+inline void yuv_to_rgb_pixel(float luma, float cb, float cr, float *out) {
+    float r = luma + 1.402f * cr;
+    float g = luma - 0.344136f * cb - 0.714136f * cr;
+    float b = luma + 1.772f * cb;
+
+    out[0] = std::min(std::max(r, 0.f), 255.f) * (1.f / 255.f);
+    out[1] = std::min(std::max(g, 0.f), 255.f) * (1.f / 255.f);
+    out[2] = std::min(std::max(b, 0.f), 255.f) * (1.f / 255.f);
+}
+
+// Packed 0xAARRGGBB pixels, as Android bitmaps hand them out, into interleaved float RGB in [0, 1].
+void argb_to_rgb(const uint32_t *src, size_t count, float *dst);
+
+#endif //ANDROID_PREPROCESS_H
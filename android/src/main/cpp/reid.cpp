@@ -0,0 +1,75 @@
+#include "reid.h"
+
+#include <algorithm>
+
+void ReIdentifier::configure(int dim, int capacity, float threshold) {
+    gallery_.reset(dim, dim > 0 ? capacity : 0);
+    threshold_ = threshold;
+    last_embedded_.clear();
+    resolved_.clear();
+}
+
+void ReIdentifier::select(const TrackList &tracks, int64_t timestamp, int max_crops,
+                          std::vector<int> &track_ids) {
+    // forget the tracks dropped by the tracker
+    for (auto it = last_embedded_.begin(); it != last_embedded_.end();) {
+        bool alive = std::any_of(tracks.begin(), tracks.end(),
+                                 [&](const Track &t) { return t.id == it->first; });
+        if (alive) {
+            ++it;
+        } else {
+            resolved_.erase(it->first);
+            it = last_embedded_.erase(it);
+        }
+    }
+
+    // unresolved tracks first, then the ones embedded longest ago
+    std::vector<std::pair<int64_t, int>> due;
+    for (const Track &track: tracks) {
+        if (track.missed > 0 || track.hits < min_hits)
+            continue;
+
+        auto it = last_embedded_.find(track.id);
+        int64_t last = it == last_embedded_.end() ? INT64_MIN : it->second;
+        if (last == INT64_MIN || timestamp - last >= interval_ns)
+            due.emplace_back(last, track.id);
+    }
+    std::sort(due.begin(), due.end());
+
+    for (int i = 0; i < (int) due.size() && i < max_crops; i++) {
+        track_ids.push_back(due[i].second);
+        last_embedded_[due[i].second] = timestamp;
+    }
+}
+
+int ReIdentifier::match(int track_id, const float *embedding, const TrackList &tracks) const {
+    if (resolved_.find(track_id) != resolved_.end())
+        return track_id;
+
+    // only identities that are not visible right now can be taken over
+    std::vector<int> visible;
+    for (const Track &track: tracks) {
+        if (track.missed == 0 && track.id != track_id)
+            visible.push_back(track.id);
+    }
+
+    GalleryMatch match;
+    if (gallery_.query(embedding, visible, match) && match.similarity >= threshold_)
+        return match.label;
+    return track_id;
+}
+
+void ReIdentifier::add(int track_id, int id, const float *embedding) {
+    if (id != track_id) {
+        auto it = last_embedded_.find(track_id);
+        if (it != last_embedded_.end()) {
+            last_embedded_[id] = it->second;
+            last_embedded_.erase(it);
+        }
+        resolved_.erase(track_id);
+    }
+    // compared once, a refused relabel is not retried
+    resolved_.insert(id);
+
+    gallery_.add(id, embedding);
+}
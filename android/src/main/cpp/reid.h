@@ -0,0 +1,53 @@
+//
+// Appearance based re-identification: embeddings of confirmed tracks are kept
+// in a gallery, and new tracks take over the id of the lost track they match.
+//
+
+#ifndef ANDROID_REID_H
+#define ANDROID_REID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "embedding_gallery.h"
+#include "tracker.h"
+
+class ReIdentifier {
+public:
+    // A zero `dim` disables re-identification.
+    void configure(int dim, int capacity, float threshold);
+
+    bool enabled() const { return gallery_.dim() > 0; }
+
+    int dim() const { return gallery_.dim(); }
+
+    // Picks up to `max_crops` confirmed tracks that are due for a new embedding.
+    void select(const TrackList &tracks, int64_t timestamp, int max_crops, std::vector<int> &track_ids);
+
+    // Returns the id `track_id` should carry from now on, the lost track its embedding matches
+    // or its own. Nothing is stored until add().
+    int match(int track_id, const float *embedding, const TrackList &tracks) const;
+
+    // Stores the embedding of `track_id` under `id`, the id it carries once relabeled or its own
+    // when the relabel was refused.
+    void add(int track_id, int id, const float *embedding);
+
+    // Halves the gallery when memory is short.
+    void shed() { gallery_.shrink(); }
+
+    // minimum time between two embeddings of the same track
+    int64_t interval_ns = 500000000;
+    // minimum matches before a track is embedded
+    int min_hits = 3;
+
+private:
+    EmbeddingGallery gallery_;
+    float threshold_ = 0.7f;
+    std::unordered_map<int, int64_t> last_embedded_;
+    // tracks already compared against the gallery
+    std::unordered_set<int> resolved_;
+};
+
+#endif //ANDROID_REID_H
@@ -0,0 +1,66 @@
+#include "roi_mask.h"
+
+#include "geometry.h"
+
+// YOLOv8 heads, anchors are laid out stride by stride in row-major order
+static const int STRIDES[] = {8, 16, 32};
+
+void RoiMask::set_polygons(std::vector<std::vector<Point2f>> polygons) {
+    polygons_.clear();
+    for (std::vector<Point2f> &polygon: polygons) {
+        if (polygon.size() >= 3)
+            polygons_.push_back(std::move(polygon));
+    }
+
+    // rebuilt on the next frame, frames still decoding keep the previous bits
+    bits_ = nullptr;
+}
+
+std::shared_ptr<const std::vector<uint64_t>> RoiMask::bits(int num_anchors, int input_width, int input_height,
+                                                           const Box &crop) {
+    if (polygons_.empty())
+        return nullptr;
+
+    if (bits_ == nullptr || num_anchors != num_anchors_ || input_width != input_width_ ||
+        input_height != input_height_ || crop != crop_) {
+        num_anchors_ = num_anchors;
+        input_width_ = input_width;
+        input_height_ = input_height;
+        crop_ = crop;
+        auto bits = std::make_shared<std::vector<uint64_t>>();
+        rasterize(*bits);
+        bits_ = std::move(bits);
+    }
+    return bits_;
+}
+
+void RoiMask::rasterize(std::vector<uint64_t> &bits) const {
+    bits.assign((num_anchors_ + 63) / 64, 0);
+
+    int anchor = 0;
+    for (int stride: STRIDES) {
+        const int grid_w = input_width_ / stride;
+        const int grid_h = input_height_ / stride;
+        for (int gy = 0; gy < grid_h; gy++) {
+            for (int gx = 0; gx < grid_w; gx++, anchor++) {
+                if (anchor >= num_anchors_)
+                    return;
+
+                // anchor center in model input coordinates, then in frame coordinates
+                Point2f center((gx + 0.5f) * stride / input_width_, (gy + 0.5f) * stride / input_height_);
+                center.x = crop_.x + center.x * crop_.width;
+                center.y = crop_.y + center.y * crop_.height;
+                for (const std::vector<Point2f> &polygon: polygons_) {
+                    if (point_in_polygon(polygon, center)) {
+                        bits[anchor >> 6] |= (uint64_t) 1 << (anchor & 63);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // the grid does not match the model output, keep every remaining anchor
+    for (; anchor < num_anchors_; anchor++)
+        bits[anchor >> 6] |= (uint64_t) 1 << (anchor & 63);
+}
@@ -0,0 +1,40 @@
+//
+// Regions of interest rasterized into a per-anchor bitset, so the decoder can
+// skip anchors whose center falls outside every region.
+//
+
+#ifndef ANDROID_ROI_MASK_H
+#define ANDROID_ROI_MASK_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "geometry.h"
+
+class RoiMask {
+public:
+    // Polygons in normalized frame coordinates, an empty list disables the mask.
+    void set_polygons(std::vector<std::vector<Point2f>> polygons);
+
+    bool empty() const { return polygons_.empty(); }
+
+    // Returns one bit per anchor, null when the mask is disabled. `crop` is the normalized region
+    // of the frame that was scaled into the model input. The bits are rebuilt into a new vector
+    // whenever the polygons or the input geometry change, so a caller can keep decoding with
+    // the returned bits without holding the lock that guards this mask.
+    std::shared_ptr<const std::vector<uint64_t>> bits(int num_anchors, int input_width, int input_height,
+                                                      const Box &crop);
+
+private:
+    void rasterize(std::vector<uint64_t> &bits) const;
+
+    std::vector<std::vector<Point2f>> polygons_;
+    std::shared_ptr<const std::vector<uint64_t>> bits_;
+    int num_anchors_ = 0;
+    int input_width_ = 0;
+    int input_height_ = 0;
+    Box crop_;
+};
+
+#endif //ANDROID_ROI_MASK_H
@@ -0,0 +1,158 @@
+#include "rule_engine.h"
+
+#include <algorithm>
+
+#include "geometry.h"
+
+// resolution of the rasterized zone lookup along each axis
+static const int ZONE_GRID_SIZE = 128;
+
+static float cross(const Point2f &o, const Point2f &a, const Point2f &b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+static void rasterize_zone(Rule &rule) {
+    float x0 = 1.f, y0 = 1.f, x1 = 0.f, y1 = 0.f;
+    for (const Point2f &p: rule.points) {
+        x0 = std::min(x0, p.x);
+        y0 = std::min(y0, p.y);
+        x1 = std::max(x1, p.x);
+        y1 = std::max(y1, p.y);
+    }
+    rule.bounds = Box(x0, y0, std::max(0.f, x1 - x0), std::max(0.f, y1 - y0));
+
+    // sample every cell at its center once, lookups are then a single byte read
+    rule.lookup.assign(ZONE_GRID_SIZE * ZONE_GRID_SIZE, 0);
+    for (int gy = 0; gy < ZONE_GRID_SIZE; gy++) {
+        float y = y0 + (gy + 0.5f) * rule.bounds.height / ZONE_GRID_SIZE;
+        for (int gx = 0; gx < ZONE_GRID_SIZE; gx++) {
+            float x = x0 + (gx + 0.5f) * rule.bounds.width / ZONE_GRID_SIZE;
+            rule.lookup[gy * ZONE_GRID_SIZE + gx] = point_in_polygon(rule.points, Point2f(x, y));
+        }
+    }
+}
+
+void RuleEngine::set_rules(std::vector<Rule> rules) {
+    rules_.clear();
+    for (Rule &rule: rules) {
+        if (rule.type == RULE_ZONE) {
+            if (rule.points.size() < 3)
+                continue;
+            rasterize_zone(rule);
+        } else if (rule.type == RULE_LINE) {
+            if (rule.points.size() != 2)
+                continue;
+        } else {
+            continue;
+        }
+        rules_.push_back(std::move(rule));
+    }
+
+    // zone indexes are stored per track, drop them when the rule set changes
+    states_.clear();
+}
+
+bool RuleEngine::zone_contains(const Rule &rule, const Point2f &p) const {
+    if (p.x < rule.bounds.x || p.y < rule.bounds.y ||
+        p.x >= rule.bounds.x + rule.bounds.width || p.y >= rule.bounds.y + rule.bounds.height)
+        return false;
+
+    int gx = (int) ((p.x - rule.bounds.x) / rule.bounds.width * ZONE_GRID_SIZE);
+    int gy = (int) ((p.y - rule.bounds.y) / rule.bounds.height * ZONE_GRID_SIZE);
+    gx = std::min(gx, ZONE_GRID_SIZE - 1);
+    gy = std::min(gy, ZONE_GRID_SIZE - 1);
+    return rule.lookup[gy * ZONE_GRID_SIZE + gx] != 0;
+}
+
+void RuleEngine::evaluate(const TrackList &tracks, int64_t timestamp,
+                          std::vector<RuleEvent> &events) {
+    if (rules_.empty())
+        return;
+
+    for (auto &it: states_)
+        it.second.alive = false;
+
+    for (const Track &track: tracks) {
+        TrackState &state = states_[track.id];
+        state.alive = true;
+
+        // only tracks matched in this frame carry a new position
+        if (track.missed > 0)
+            continue;
+
+        Point2f center(track.rect.x + track.rect.width / 2, track.rect.y + track.rect.height / 2);
+        if (state.zones.empty())
+            state.zones.resize(rules_.size());
+
+        for (int r = 0; r < (int) rules_.size(); r++) {
+            const Rule &rule = rules_[r];
+            if (rule.class_index >= 0 && rule.class_index != track.index)
+                continue;
+
+            if (rule.type == RULE_ZONE) {
+                ZoneState &zone = state.zones[r];
+                bool inside = zone_contains(rule, center);
+                if (inside && !zone.inside) {
+                    zone.inside = true;
+                    zone.dwell_fired = false;
+                    zone.enter_timestamp = timestamp;
+                    events.push_back({rule.id, RULE_EVENT_ENTER, track.id, track.index, timestamp, center.x, center.y});
+                } else if (!inside && zone.inside) {
+                    zone.inside = false;
+                    events.push_back({rule.id, RULE_EVENT_EXIT, track.id, track.index, timestamp, center.x, center.y});
+                }
+
+                if (zone.inside && !zone.dwell_fired && rule.dwell_ns > 0 &&
+                    timestamp - zone.enter_timestamp >= rule.dwell_ns) {
+                    zone.dwell_fired = true;
+                    events.push_back({rule.id, RULE_EVENT_DWELL, track.id, track.index, timestamp, center.x, center.y});
+                }
+            } else if (rule.type == RULE_LINE && state.seen) {
+                const Point2f &a = rule.points[0];
+                const Point2f &b = rule.points[1];
+
+                // the track path and the line must straddle each other
+                float d0 = cross(a, b, state.center);
+                float d1 = cross(a, b, center);
+                float d2 = cross(state.center, center, a);
+                float d3 = cross(state.center, center, b);
+                if (((d0 > 0 && d1 <= 0) || (d0 < 0 && d1 >= 0)) &&
+                    ((d2 > 0 && d3 < 0) || (d2 < 0 && d3 > 0))) {
+                    // forward means crossing from the left side of a->b to its right side
+                    int type = d0 < 0 ? RULE_EVENT_CROSS_FORWARD : RULE_EVENT_CROSS_BACKWARD;
+                    events.push_back({rule.id, type, track.id, track.index, timestamp, center.x, center.y});
+                }
+            }
+        }
+
+        state.center = center;
+        state.index = track.index;
+        state.seen = true;
+    }
+
+    // tracks dropped by the tracker leave every zone they were in
+    for (auto it = states_.begin(); it != states_.end();) {
+        if (it->second.alive) {
+            ++it;
+            continue;
+        }
+
+        for (int r = 0; r < (int) it->second.zones.size(); r++) {
+            if (it->second.zones[r].inside)
+                events.push_back({rules_[r].id, RULE_EVENT_EXIT, it->first, it->second.index, timestamp,
+                                  it->second.center.x, it->second.center.y});
+        }
+        it = states_.erase(it);
+    }
+}
+
+void RuleEngine::relabel(int from, int to) {
+    auto it = states_.find(from);
+    if (it == states_.end())
+        return;
+
+    // the newer state holds the current position and zone occupancy
+    TrackState state = it->second;
+    states_.erase(it);
+    states_[to] = state;
+}
@@ -0,0 +1,85 @@
+//
+// Zone, line crossing and dwell time rules evaluated on tracked objects.
+// All coordinates are normalized to the model input frame (0..1).
+//
+
+#ifndef ANDROID_RULE_ENGINE_H
+#define ANDROID_RULE_ENGINE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "tracker.h"
+
+enum RuleType {
+    RULE_ZONE = 0,
+    RULE_LINE = 1,
+};
+
+enum RuleEventType {
+    RULE_EVENT_ENTER = 0,
+    RULE_EVENT_EXIT = 1,
+    RULE_EVENT_DWELL = 2,
+    RULE_EVENT_CROSS_FORWARD = 3,
+    RULE_EVENT_CROSS_BACKWARD = 4,
+};
+
+struct Rule {
+    int id;
+    int type;
+    // -1 matches every class
+    int class_index;
+    // zones only, 0 disables the dwell event
+    int64_t dwell_ns;
+    std::vector<Point2f> points;
+
+    // rasterized lookup over the zone bounding box
+    Box bounds;
+    std::vector<uint8_t> lookup;
+};
+
+struct RuleEvent {
+    int rule_id;
+    int type;
+    int track_id;
+    int index;
+    int64_t timestamp;
+    float x;
+    float y;
+};
+
+class RuleEngine {
+public:
+    void set_rules(std::vector<Rule> rules);
+
+    bool empty() const { return rules_.empty(); }
+
+    // Appends the events triggered by the tracks updated at `timestamp`.
+    void evaluate(const TrackList &tracks, int64_t timestamp, std::vector<RuleEvent> &events);
+
+    // Moves the state of track `from` to track `to`, following a tracker relabel.
+    void relabel(int from, int to);
+
+private:
+    struct ZoneState {
+        bool inside = false;
+        bool dwell_fired = false;
+        int64_t enter_timestamp = 0;
+    };
+
+    struct TrackState {
+        Point2f center;
+        int index;
+        bool seen = false;
+        bool alive = false;
+        std::vector<ZoneState> zones;
+    };
+
+    bool zone_contains(const Rule &rule, const Point2f &p) const;
+
+    std::vector<Rule> rules_;
+    std::unordered_map<int, TrackState> states_;
+};
+
+#endif //ANDROID_RULE_ENGINE_H
@@ -0,0 +1,59 @@
+#include "scratch_arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "memory_budget.h"
+
+static const size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+ScratchArena::~ScratchArena() {
+    release();
+}
+
+void ScratchArena::add_block(size_t size) {
+    void *data = nullptr;
+    if (posix_memalign(&data, ALIGNMENT, size) != 0)
+        throw std::bad_alloc();
+    blocks_.push_back({(uint8_t *) data, size});
+    capacity_ += size;
+    memory_charge(MEMORY_SCRATCH, size);
+    used_ = 0;
+}
+
+void *ScratchArena::allocate(size_t bytes) {
+    bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    std::lock_guard<std::mutex> guard(lock_);
+    if (blocks_.empty() || used_ + bytes > blocks_.back().size)
+        add_block(std::max(bytes, std::max(MIN_BLOCK_SIZE, blocks_.empty() ? 0 : blocks_.back().size * 2)));
+
+    void *memory = blocks_.back().data + used_;
+    used_ += bytes;
+    return memory;
+}
+
+void ScratchArena::reset() {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (blocks_.size() > 1) {
+        size_t total = capacity_;
+        for (Block &block: blocks_)
+            free(block.data);
+        blocks_.clear();
+        memory_release(MEMORY_SCRATCH, capacity_);
+        capacity_ = 0;
+        add_block(total);
+    }
+    used_ = 0;
+}
+
+void ScratchArena::release() {
+    std::lock_guard<std::mutex> guard(lock_);
+    for (Block &block: blocks_)
+        free(block.data);
+    blocks_.clear();
+    memory_release(MEMORY_SCRATCH, capacity_);
+    capacity_ = 0;
+    used_ = 0;
+}
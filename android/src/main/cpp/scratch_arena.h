@@ -0,0 +1,52 @@
+//
+// Per-frame bump allocator for temporary buffers.
+//
+
+#ifndef ANDROID_SCRATCH_ARENA_H
+#define ANDROID_SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class ScratchArena {
+public:
+    static const size_t ALIGNMENT = 64;
+
+    ScratchArena() = default;
+
+    ScratchArena(const ScratchArena &) = delete;
+
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    ~ScratchArena();
+
+    // Memory that stays valid until the next reset(). Safe to call from several threads.
+    void *allocate(size_t bytes);
+
+    // Frees everything at once. After a frame that needed more than one block the blocks are
+    // merged, so steady state frames allocate nothing.
+    void reset();
+
+    // Frees the blocks when memory is short, the next frame allocates what it needs again.
+    // Only between frames.
+    void release();
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Block {
+        uint8_t *data;
+        size_t size;
+    };
+
+    void add_block(size_t size);
+
+    std::mutex lock_;
+    std::vector<Block> blocks_;
+    size_t used_ = 0;
+    size_t capacity_ = 0;
+};
+
+#endif //ANDROID_SCRATCH_ARENA_H
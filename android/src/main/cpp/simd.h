@@ -0,0 +1,72 @@
+//
+// Minimal float kernels with NEON and SSE paths and a scalar fallback.
+//
+
+#ifndef ANDROID_SIMD_H
+#define ANDROID_SIMD_H
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static inline float dot_product(const float *a, const float *b, int n) {
+    int i = 0;
+    float sum = 0.f;
+#if defined(__ARM_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.f);
+    float32x4_t acc1 = vdupq_n_f32(0.f);
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t acc2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(acc2, acc2), 0);
+#elif defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+static inline void add_scalar(float *dst, float v, int n) {
+    int i = 0;
+#if defined(__ARM_NEON)
+    float32x4_t vv = vdupq_n_f32(v);
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vv));
+#elif defined(__SSE2__)
+    __m128 vv = _mm_set1_ps(v);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), vv));
+#endif
+    for (; i < n; i++)
+        dst[i] += v;
+}
+
+static inline void scale_inplace(float *dst, float v, int n) {
+    int i = 0;
+#if defined(__ARM_NEON)
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(dst + i), v));
+#elif defined(__SSE2__)
+    __m128 vv = _mm_set1_ps(v);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), vv));
+#endif
+    for (; i < n; i++)
+        dst[i] *= v;
+}
+
+#endif //ANDROID_SIMD_H
@@ -0,0 +1,195 @@
+#include "smoothing.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float TWO_PI = 6.28318531f;
+// timestamp of a row created in the current frame, its filter starts at the measurement
+static const int64_t NEW_ROW = INT64_MIN;
+// frames closer than this are taken a millisecond apart
+static const float MIN_DT = 1e-3f;
+
+static float box_iou(const Box &a, const Box &b) {
+    float inter_area = (a & b).area();
+    float union_area = a.area() + b.area() - inter_area;
+    return union_area > 0.f ? inter_area / union_area : 0.f;
+}
+
+// One Euro step over `n` coordinates, branch free so that it vectorizes. w / (w + 1) with
+// w = 2 pi fc dt is the smoothing factor of a first order low pass with cutoff fc.
+static void one_euro(const float *x, const float *dt, float *value, float *derivative, size_t n,
+                     float min_cutoff, float beta, float derivative_cutoff) {
+    for (size_t i = 0; i < n; i++) {
+        float w_d = TWO_PI * derivative_cutoff * dt[i];
+        float speed = (x[i] - value[i]) / dt[i];
+        float d = derivative[i] + w_d / (w_d + 1.f) * (speed - derivative[i]);
+        float w = TWO_PI * (min_cutoff + beta * std::fabs(d)) * dt[i];
+        value[i] += w / (w + 1.f) * (x[i] - value[i]);
+        derivative[i] = d;
+    }
+}
+
+int Smoother::row_of(const DetectedObject &object, std::vector<char> &used) {
+    int row = -1;
+    if (object.track_id >= 0) {
+        auto it = std::find(keys_.begin(), keys_.end(), object.track_id);
+        if (it != keys_.end() && !used[it - keys_.begin()])
+            row = it - keys_.begin();
+    } else {
+        // the best overlapping untracked filter of the same class
+        float best = iou_threshold;
+        for (int r = 0; r < (int) keys_.size(); r++) {
+            if (keys_[r] >= 0 || used[r] || indices_[r] != object.index)
+                continue;
+
+            const float *box = &values_[(size_t) r * stride_];
+            float iou = box_iou(Box(box[0], box[1], box[2], box[3]), object.rect);
+            if (iou > best) {
+                best = iou;
+                row = r;
+            }
+        }
+    }
+
+    if (row < 0) {
+        row = keys_.size();
+        keys_.push_back(object.track_id >= 0 ? object.track_id : next_key_--);
+        indices_.push_back(object.index);
+        timestamps_.push_back(NEW_ROW);
+        missed_.push_back(0);
+        values_.resize(values_.size() + stride_);
+        derivatives_.resize(derivatives_.size() + stride_);
+        used.push_back(0);
+    }
+    used[row] = 1;
+    return row;
+}
+
+void Smoother::smooth(std::vector<DetectedObject> &objects, int64_t timestamp) {
+    smooth(objects, nullptr, 0, timestamp);
+}
+
+void Smoother::smooth(std::vector<DetectedObject> &objects, float *keypoints, int num_keypoints,
+                      int64_t timestamp) {
+    if (!enabled)
+        return;
+
+    const int stride = 4 + 2 * num_keypoints;
+    if (stride != stride_) {
+        reset();
+        stride_ = stride;
+    }
+
+    std::vector<char> used(keys_.size(), 0);
+    rows_.resize(objects.size());
+    for (size_t o = 0; o < objects.size(); o++)
+        rows_[o] = row_of(objects[o], used);
+
+    // gather the measurements and the state of their filters in object order
+    const size_t count = objects.size() * stride_;
+    input_.resize(count);
+    dt_.resize(count);
+    value_.resize(count);
+    derivative_.resize(count);
+    for (size_t o = 0; o < objects.size(); o++) {
+        float *in = &input_[o * stride_];
+        const Box &rect = objects[o].rect;
+        in[0] = rect.x;
+        in[1] = rect.y;
+        in[2] = rect.width;
+        in[3] = rect.height;
+        for (int k = 0; k < num_keypoints; k++) {
+            in[4 + 2 * k] = keypoints[(o * num_keypoints + k) * 3];
+            in[5 + 2 * k] = keypoints[(o * num_keypoints + k) * 3 + 1];
+        }
+
+        const int row = rows_[o];
+        const bool fresh = timestamps_[row] == NEW_ROW;
+        const float dt = fresh ? 1.f : std::max((timestamp - timestamps_[row]) / 1e9f, MIN_DT);
+        const float *v = &values_[(size_t) row * stride_];
+        const float *d = &derivatives_[(size_t) row * stride_];
+        for (int c = 0; c < stride_; c++) {
+            value_[o * stride_ + c] = fresh ? in[c] : v[c];
+            derivative_[o * stride_ + c] = fresh ? 0.f : d[c];
+            dt_[o * stride_ + c] = dt;
+        }
+    }
+
+    one_euro(input_.data(), dt_.data(), value_.data(), derivative_.data(), count, min_cutoff, beta,
+             derivative_cutoff);
+
+    // scatter the state back and report the smoothed coordinates
+    for (size_t o = 0; o < objects.size(); o++) {
+        const int row = rows_[o];
+        const float *out = &value_[o * stride_];
+        std::copy(out, out + stride_, &values_[(size_t) row * stride_]);
+        std::copy(&derivative_[o * stride_], &derivative_[o * stride_] + stride_,
+                  &derivatives_[(size_t) row * stride_]);
+        timestamps_[row] = timestamp;
+        missed_[row] = 0;
+
+        Box &rect = objects[o].rect;
+        rect.x = out[0];
+        rect.y = out[1];
+        rect.width = out[2];
+        rect.height = out[3];
+        for (int k = 0; k < num_keypoints; k++) {
+            keypoints[(o * num_keypoints + k) * 3] = out[4 + 2 * k];
+            keypoints[(o * num_keypoints + k) * 3 + 1] = out[5 + 2 * k];
+        }
+    }
+
+    // filters of objects gone for longer than a track would be kept are dropped
+    std::vector<char> keep(keys_.size());
+    for (size_t r = 0; r < keys_.size(); r++)
+        keep[r] = used[r] || ++missed_[r] <= max_missed;
+    compact(keep);
+}
+
+void Smoother::compact(const std::vector<char> &keep) {
+    size_t kept = 0;
+    for (size_t r = 0; r < keys_.size(); r++) {
+        if (!keep[r])
+            continue;
+
+        if (kept != r) {
+            keys_[kept] = keys_[r];
+            indices_[kept] = indices_[r];
+            timestamps_[kept] = timestamps_[r];
+            missed_[kept] = missed_[r];
+            std::copy(&values_[r * stride_], &values_[r * stride_] + stride_, &values_[kept * stride_]);
+            std::copy(&derivatives_[r * stride_], &derivatives_[r * stride_] + stride_,
+                      &derivatives_[kept * stride_]);
+        }
+        kept++;
+    }
+    keys_.resize(kept);
+    indices_.resize(kept);
+    timestamps_.resize(kept);
+    missed_.resize(kept);
+    values_.resize(kept * stride_);
+    derivatives_.resize(kept * stride_);
+}
+
+void Smoother::reset() {
+    keys_.clear();
+    indices_.clear();
+    timestamps_.clear();
+    missed_.clear();
+    values_.clear();
+    derivatives_.clear();
+    next_key_ = -1;
+}
+
+void Smoother::shed() {
+    std::vector<char> keep(keys_.size());
+    for (size_t r = 0; r < keys_.size(); r++)
+        keep[r] = missed_[r] == 0;
+    compact(keep);
+    values_.shrink_to_fit();
+    derivatives_.shrink_to_fit();
+    input_ = CountedVector<float, MEMORY_TRACKER>();
+    dt_ = CountedVector<float, MEMORY_TRACKER>();
+    value_ = CountedVector<float, MEMORY_TRACKER>();
+    derivative_ = CountedVector<float, MEMORY_TRACKER>();
+}
@@ -0,0 +1,69 @@
+//
+// One Euro filters smoothing the reported boxes, and keypoints, of each object across frames.
+// The filter state is kept in flat arrays, a row of coordinates per object, and a frame is
+// filtered in a single pass over all of its coordinates.
+//
+
+#ifndef ANDROID_SMOOTHING_H
+#define ANDROID_SMOOTHING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "memory_budget.h"
+#include "ultralytics.h"
+
+class Smoother {
+public:
+    // Smooths the boxes in place. Objects are followed by their track id, or when untracked by
+    // their overlap with the smoothed boxes of the previous frame.
+    void smooth(std::vector<DetectedObject> &objects, int64_t timestamp);
+
+    // Also smooths `num_keypoints` keypoints per object, laid out as x, y and confidence. The
+    // confidences are left as they are.
+    void smooth(std::vector<DetectedObject> &objects, float *keypoints, int num_keypoints, int64_t timestamp);
+
+    void reset();
+
+    // Drops the filters of the objects missing from the last frame and their spare capacity.
+    void shed();
+
+    bool enabled = false;
+    // cutoff frequency in Hz at rest, lower is smoother
+    float min_cutoff = 1.f;
+    // how fast the cutoff rises with the speed in normalized units per second, higher lags less
+    float beta = 10.f;
+    // cutoff frequency in Hz of the speed estimate
+    float derivative_cutoff = 1.f;
+    // overlap an untracked object needs with a smoothed box to continue its filter
+    float iou_threshold = 0.3f;
+    int max_missed = 15;
+
+private:
+    int row_of(const DetectedObject &object, std::vector<char> &used);
+
+    // drops the rows not kept, in place across every per-row array
+    void compact(const std::vector<char> &keep);
+
+    // coordinates per row, the box then the keypoints
+    int stride_ = 0;
+    int next_key_ = -1;
+
+    // per row: the track id, or a negative key for an untracked object
+    std::vector<int> keys_;
+    std::vector<int> indices_;
+    std::vector<int64_t> timestamps_;
+    std::vector<int> missed_;
+    // per row and coordinate
+    CountedVector<float, MEMORY_TRACKER> values_;
+    CountedVector<float, MEMORY_TRACKER> derivatives_;
+
+    // the frame's coordinates in object order, filtered in place
+    std::vector<int> rows_;
+    CountedVector<float, MEMORY_TRACKER> input_;
+    CountedVector<float, MEMORY_TRACKER> dt_;
+    CountedVector<float, MEMORY_TRACKER> value_;
+    CountedVector<float, MEMORY_TRACKER> derivative_;
+};
+
+#endif //ANDROID_SMOOTHING_H
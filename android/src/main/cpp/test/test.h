@@ -0,0 +1,65 @@
+//
+// Tiny unit test harness for the native core, host builds only.
+//
+
+#ifndef ANDROID_TEST_H
+#define ANDROID_TEST_H
+
+#include <cmath>
+#include <cstdio>
+
+// failed checks so far, a suite passes when it adds none
+extern int test_failures;
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);            \
+            test_failures++;                                                                \
+        }                                                                                   \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                             \
+    do {                                                                                    \
+        double actual_ = (actual);                                                          \
+        double expected_ = (expected);                                                      \
+        if (!(std::fabs(actual_ - expected_) <= (tolerance))) {                             \
+            printf("%s:%d: CHECK_NEAR(%s, %s) failed, %g vs %g\n", __FILE__, __LINE__,      \
+                   #actual, #expected, actual_, expected_);                                 \
+            test_failures++;                                                                \
+        }                                                                                   \
+    } while (0)
+
+void test_atomic_config();
+
+void test_detection_log();
+
+void test_frame_recording();
+
+void test_geometry();
+
+void test_heatmap();
+
+void test_memory_budget();
+
+void test_output_exchange();
+
+void test_postprocess();
+
+void test_preprocess();
+
+void test_reid();
+
+void test_roi_mask();
+
+void test_rule_engine();
+
+void test_smoothing();
+
+void test_track_history();
+
+void test_tracker();
+
+void test_zoom_controller();
+
+#endif //ANDROID_TEST_H
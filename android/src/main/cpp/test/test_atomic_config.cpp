@@ -0,0 +1,101 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "atomic_config.h"
+#include "test.h"
+
+// counts live copies, so the tests see when replaced values are freed
+struct Counted {
+    static int live;
+
+    int first = 0;
+    int second = 0;
+
+    Counted() { live++; }
+
+    Counted(const Counted &other) : first(other.first), second(other.second) { live++; }
+
+    ~Counted() { live--; }
+};
+
+int Counted::live = 0;
+
+static void snapshot_keeps_its_value() {
+    AtomicConfig<Counted> config;
+    config.update([](Counted &value) { value.first = 1; });
+
+    AtomicConfig<Counted>::Snapshot before = config.read();
+    config.update([](Counted &value) { value.second = 2; });
+    CHECK(before->first == 1 && before->second == 0);
+
+    // edits start from the latest value
+    AtomicConfig<Counted>::Snapshot after = config.read();
+    CHECK(after->first == 1 && after->second == 2);
+}
+
+static void replaced_values_are_freed_by_the_last_reader() {
+    {
+        AtomicConfig<Counted> config;
+        CHECK(Counted::live == 1);
+
+        // without readers an update frees the value it replaces
+        config.update([](Counted &value) { value.first = 1; });
+        CHECK(Counted::live == 1);
+
+        {
+            AtomicConfig<Counted>::Snapshot pinned = config.read();
+            config.update([](Counted &value) { value.first = 2; });
+            config.update([](Counted &value) { value.first = 3; });
+            CHECK(Counted::live == 3);
+            CHECK(pinned->first == 1);
+
+            // a moved snapshot unpins once
+            AtomicConfig<Counted>::Snapshot moved(std::move(pinned));
+            CHECK(moved->first == 1);
+            CHECK(Counted::live == 3);
+        }
+        CHECK(Counted::live == 1);
+        CHECK(config.read()->first == 3);
+    }
+    CHECK(Counted::live == 0);
+}
+
+static void readers_never_see_a_torn_value() {
+    AtomicConfig<Counted> config;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                AtomicConfig<Counted>::Snapshot snapshot = config.read();
+                if (snapshot->first != snapshot->second)
+                    torn++;
+            }
+        });
+    }
+
+    for (int i = 1; i <= 20000; i++) {
+        config.update([i](Counted &value) {
+            value.first = i;
+            value.second = i;
+        });
+    }
+    done.store(true);
+    for (std::thread &reader: readers)
+        reader.join();
+
+    CHECK(torn.load() == 0);
+    CHECK(config.read()->first == 20000);
+    // whatever the readers pinned last is freed by now or with the next update
+    config.update([](Counted &) {});
+    CHECK(Counted::live == 1);
+}
+
+void test_atomic_config() {
+    snapshot_keeps_its_value();
+    replaced_values_are_freed_by_the_last_reader();
+    readers_never_see_a_torn_value();
+}
@@ -0,0 +1,149 @@
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "detection_log.h"
+#include "test.h"
+
+// A fresh directory under /tmp, removed with the segments in it.
+struct TempDirectory {
+    std::string path;
+
+    TempDirectory() {
+        char name[] = "/tmp/ultralytics_log_XXXXXX";
+        if (mkdtemp(name) != nullptr)
+            path = name;
+    }
+
+    ~TempDirectory() {
+        for (const std::string &segment: DetectionLogReader::segments(path))
+            unlink(segment.c_str());
+        rmdir(path.c_str());
+    }
+};
+
+static std::vector<DetectedObject> objects(int first, int count) {
+    std::vector<DetectedObject> objects(count);
+    for (int i = 0; i < count; i++) {
+        objects[i].rect = Box(0.01f * (first + i), 0.5f, 0.25f, 1.f);
+        objects[i].index = first + i;
+        objects[i].confidence = 0.75f;
+        objects[i].track_id = 100 + first + i;
+    }
+    return objects;
+}
+
+// Reads every segment in order, returns the records per segment.
+static std::vector<std::vector<LogRecord>> read_all(const std::string &directory) {
+    std::vector<std::vector<LogRecord>> segments;
+    for (const std::string &path: DetectionLogReader::segments(directory)) {
+        DetectionLogReader reader;
+        CHECK(reader.open(path));
+        std::vector<LogRecord> records;
+        for (size_t i = 0; i < reader.size(); i++)
+            records.push_back(reader[i]);
+        segments.push_back(records);
+    }
+    return segments;
+}
+
+static void records_are_read_back_across_segments() {
+    TempDirectory dir;
+    CHECK(!dir.path.empty());
+
+    DetectionLog log;
+    CHECK(log.open(dir.path, 4, 0));
+    CHECK(log.is_open());
+    // two frames, the second spills over into a third segment
+    log.append(1, 1000, objects(0, 6));
+    log.append(2, 2000, objects(6, 4));
+    log.close();
+    CHECK(!log.is_open());
+
+    std::vector<std::vector<LogRecord>> segments = read_all(dir.path);
+    CHECK(segments.size() == 3);
+    if (segments.size() != 3)
+        return;
+    CHECK(segments[0].size() == 4 && segments[1].size() == 4 && segments[2].size() == 2);
+
+    int n = 0;
+    for (const std::vector<LogRecord> &records: segments) {
+        for (const LogRecord &record: records) {
+            CHECK(record.frame_id == (n < 6 ? 1u : 2u));
+            CHECK(record.timestamp == (n < 6 ? 1000 : 2000));
+            CHECK(record.track_id == 100 + n);
+            CHECK(record.index == n);
+            CHECK(record.x == (uint16_t) std::lround(0.01f * n * 65535.f));
+            CHECK(record.y == 32768 && record.w == 16384 && record.h == 65535);
+            CHECK(record.score == 49151);
+            n++;
+        }
+    }
+    CHECK(n == 10);
+}
+
+static void old_segments_are_removed() {
+    TempDirectory dir;
+    DetectionLog log;
+    CHECK(log.open(dir.path, 2, 2));
+    for (int frame = 0; frame < 5; frame++)
+        log.append(frame, frame, objects(2 * frame, 2));
+    log.close();
+
+    // the newest two of five full segments
+    std::vector<std::string> paths = DetectionLogReader::segments(dir.path);
+    CHECK(paths.size() == 2);
+    std::vector<std::vector<LogRecord>> segments = read_all(dir.path);
+    if (segments.size() == 2) {
+        CHECK(segments[0].size() == 2 && segments[0][0].frame_id == 3);
+        CHECK(segments[1].size() == 2 && segments[1][1].frame_id == 4);
+    }
+
+    // a new session continues the numbering and keeps the limit
+    CHECK(log.open(dir.path, 2, 2));
+    log.append(9, 9, objects(0, 1));
+    log.close();
+    paths = DetectionLogReader::segments(dir.path);
+    CHECK(paths.size() == 2);
+    if (paths.size() == 2)
+        CHECK(paths[1].find("detections_00000005.ulog") != std::string::npos);
+}
+
+static void live_and_truncated_segments_are_read_to_the_last_record() {
+    TempDirectory dir;
+    DetectionLog log;
+    CHECK(log.open(dir.path, 8, 0));
+    log.append(1, 1, objects(0, 3));
+
+    // the segment being written has room for eight, the header says three
+    std::vector<std::string> paths = DetectionLogReader::segments(dir.path);
+    CHECK(!paths.empty());
+    DetectionLogReader reader;
+    CHECK(reader.open(paths.front()));
+    CHECK(reader.size() == 3);
+    reader.close();
+    log.close();
+
+    // cut in the middle of the third record, as a crash while syncing could leave it
+    const std::string path = DetectionLogReader::segments(dir.path).front();
+    CHECK(truncate(path.c_str(), sizeof(LogHeader) + 2 * sizeof(LogRecord) + 5) == 0);
+    CHECK(reader.open(path));
+    CHECK(reader.size() == 2);
+    if (reader.size() == 2)
+        CHECK(reader[1].track_id == 101);
+    reader.close();
+
+    // not even a whole header
+    CHECK(truncate(path.c_str(), sizeof(LogHeader) - 1) == 0);
+    CHECK(!reader.open(path));
+    CHECK(reader.size() == 0);
+}
+
+void test_detection_log() {
+    records_are_read_back_across_segments();
+    old_segments_are_removed();
+    live_and_truncated_segments_are_read_to_the_last_record();
+}
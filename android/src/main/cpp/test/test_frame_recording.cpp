@@ -0,0 +1,168 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "frame_recording.h"
+#include "test.h"
+
+static const int WIDTH = 96;
+static const int HEIGHT = 64;
+static const int NUM_FRAMES = 12;
+
+// A file under /tmp, removed again.
+struct TempFile {
+    std::string path;
+
+    TempFile() {
+        char name[] = "/tmp/ultralytics_recording_XXXXXX";
+        int fd = mkstemp(name);
+        if (fd >= 0) {
+            ::close(fd);
+            path = name;
+        }
+    }
+
+    ~TempFile() { unlink(path.c_str()); }
+};
+
+// The pixels of a frame without its strides, and what else a replay must reproduce.
+struct PackedFrame {
+    int64_t timestamp;
+    int rotation;
+    int width;
+    int height;
+    std::vector<uint8_t> y, u, v;
+
+    explicit PackedFrame(const Frame &frame)
+            : timestamp(frame.timestamp), rotation(frame.rotation),
+              width(frame.planes.width), height(frame.planes.height) {
+        const YuvPlanes &p = frame.planes;
+        for (int row = 0; row < height; row++)
+            y.insert(y.end(), p.y + (size_t) row * p.y_row_stride, p.y + (size_t) row * p.y_row_stride + width);
+        for (int row = 0; row < height / 2; row++) {
+            for (int col = 0; col < width / 2; col++) {
+                u.push_back(p.u[(size_t) row * p.uv_row_stride + col * p.uv_pixel_stride]);
+                v.push_back(p.v[(size_t) row * p.uv_row_stride + col * p.uv_pixel_stride]);
+            }
+        }
+    }
+
+    bool operator==(const PackedFrame &other) const {
+        return timestamp == other.timestamp && rotation == other.rotation && width == other.width &&
+               height == other.height && y == other.y && u == other.u && v == other.v;
+    }
+};
+
+// Repacks an I420 frame the way many camera HALs deliver it: padded rows and interleaved
+// chroma, V first.
+static Frame semi_planar(const Frame &frame, std::vector<uint8_t> &storage) {
+    const YuvPlanes &p = frame.planes;
+    const int stride = p.width + 16;
+    storage.assign((size_t) stride * p.height + (size_t) stride * (p.height / 2), 0xee);
+    uint8_t *y = storage.data();
+    uint8_t *vu = y + (size_t) stride * p.height;
+    for (int row = 0; row < p.height; row++)
+        std::copy(p.y + (size_t) row * p.y_row_stride, p.y + (size_t) row * p.y_row_stride + p.width,
+                  y + (size_t) row * stride);
+    for (int row = 0; row < p.height / 2; row++) {
+        for (int col = 0; col < p.width / 2; col++) {
+            vu[(size_t) row * stride + col * 2] = p.v[(size_t) row * p.uv_row_stride + col];
+            vu[(size_t) row * stride + col * 2 + 1] = p.u[(size_t) row * p.uv_row_stride + col];
+        }
+    }
+
+    Frame repacked = frame;
+    repacked.planes = {y, vu + 1, vu, p.width, p.height, stride, stride, 2};
+    return repacked;
+}
+
+// Records synthetic frames, every other one semi-planar, and returns them packed.
+static std::vector<PackedFrame> record(const std::string &path) {
+    SyntheticFrameSource source(WIDTH, HEIGHT, 3, 30, NUM_FRAMES);
+    FrameRecorder recorder;
+    CHECK(recorder.open(path));
+    CHECK(recorder.is_open());
+
+    std::vector<PackedFrame> recorded;
+    std::vector<uint8_t> storage;
+    Frame frame;
+    for (int i = 0; source.next(frame); i++) {
+        frame.rotation = 90 * (i % 4);
+        if (i % 2)
+            frame = semi_planar(frame, storage);
+        recorder.record(frame);
+        recorded.emplace_back(frame);
+    }
+    recorder.close();
+    CHECK(!recorder.is_open());
+    return recorded;
+}
+
+static void replay_matches_the_recorded_frames() {
+    TempFile file;
+    CHECK(!file.path.empty());
+    std::vector<PackedFrame> recorded = record(file.path);
+
+    RecordingFrameSource replay;
+    CHECK(replay.open(file.path, false));
+    // the writer may fall behind, dropped frames are counted and the rest keep their order
+    CHECK(replay.size() > 0);
+    CHECK(replay.size() + replay.dropped() == (size_t) NUM_FRAMES);
+
+    Frame frame;
+    size_t next = 0;
+    int replayed = 0;
+    int64_t first = -1;
+    while (replay.next(frame)) {
+        if (first < 0)
+            first = frame.timestamp;
+        CHECK(frame.planes.y_row_stride == WIDTH && frame.planes.uv_pixel_stride == 1);
+        PackedFrame packed(frame);
+        while (next < recorded.size() && recorded[next].timestamp != packed.timestamp)
+            next++;
+        CHECK(next < recorded.size());
+        if (next < recorded.size())
+            CHECK(packed == recorded[next]);
+        replayed++;
+    }
+    CHECK(replayed == (int) replay.size());
+
+    // rewinding replays the same frames
+    replay.rewind();
+    CHECK(replay.next(frame));
+    CHECK(frame.timestamp == first);
+}
+
+static void unfinished_recordings_replay_the_whole_frames() {
+    TempFile file;
+    record(file.path);
+
+    RecordingFrameSource replay;
+    CHECK(replay.open(file.path, false));
+    const size_t complete = replay.size();
+    replay.close();
+
+    // cut into the last frame, as an interrupted session leaves it
+    const size_t frame_size = sizeof(RecordedFrame) + (size_t) WIDTH * HEIGHT * 3 / 2;
+    CHECK(truncate(file.path.c_str(), sizeof(RecordingHeader) + complete * frame_size - 10) == 0);
+    CHECK(replay.open(file.path, false));
+    CHECK(replay.size() == complete - 1);
+
+    // only a header, or less
+    CHECK(truncate(file.path.c_str(), sizeof(RecordingHeader)) == 0);
+    CHECK(replay.open(file.path, false));
+    CHECK(replay.size() == 0);
+    Frame frame;
+    CHECK(!replay.next(frame));
+    CHECK(truncate(file.path.c_str(), sizeof(RecordingHeader) - 1) == 0);
+    CHECK(!replay.open(file.path, false));
+}
+
+void test_frame_recording() {
+    replay_matches_the_recorded_frames();
+    unfinished_recordings_replay_the_whole_frames();
+}
@@ -0,0 +1,107 @@
+#include <cmath>
+#include <vector>
+
+#include "geometry.h"
+#include "test.h"
+
+static std::vector<Point2f> rect(float x1, float y1, float x2, float y2) {
+    return {Point2f(x1, y1), Point2f(x2, y1), Point2f(x2, y2), Point2f(x1, y2)};
+}
+
+static void intersection_and_area() {
+    const Box a(0.f, 0.f, 1.f, 1.f);
+    Box overlap = a & Box(0.5f, 0.25f, 1.f, 0.5f);
+    CHECK(overlap == Box(0.5f, 0.25f, 0.5f, 0.5f));
+    CHECK(overlap.area() == 0.25f);
+    CHECK((a & Box(0.25f, 0.25f, 0.5f, 0.5f)) == Box(0.25f, 0.25f, 0.5f, 0.5f));
+
+    // disjoint or only touching gives the all zero box
+    CHECK((a & Box(2.f, 0.f, 1.f, 1.f)) == Box());
+    CHECK((a & Box(1.f, 0.f, 1.f, 1.f)) == Box());
+    CHECK((a & Box(0.f, 1.f, 1.f, 1.f)).area() == 0.f);
+
+    // empty and negative sizes never overlap anything
+    CHECK((a & Box(0.5f, 0.5f, 0.f, 0.2f)) == Box());
+    CHECK((a & Box(0.5f, 0.5f, -0.2f, 0.3f)) == Box());
+    CHECK((Box(0.8f, 0.8f, -0.5f, -0.5f) & a) == Box());
+
+    Box negative(0.5f, 0.5f, -0.5f, 0.5f);
+    CHECK(negative.empty());
+    CHECK(negative.area() < 0.f);
+    CHECK(Box().empty() && Box().area() == 0.f);
+    CHECK(!a.empty());
+}
+
+static void union_skips_empty_boxes() {
+    const Box a(0.f, 0.f, 0.5f, 0.5f);
+    CHECK((a | Box(0.25f, 0.75f, 0.5f, 0.25f)) == Box(0.f, 0.f, 0.75f, 1.f));
+    CHECK((a | Box()) == a);
+    CHECK((Box(0.9f, 0.9f, -1.f, 1.f) | a) == a);
+    CHECK((Box() | Box()).empty());
+}
+
+// Boxes are cache keys of the ROI mask, equal only when every field is.
+static void equality_compares_every_field() {
+    const Box a(0.25f, 0.5f, 0.125f, 1.f);
+    CHECK(a == Box(0.25f, 0.5f, 0.125f, 1.f));
+    CHECK(!(a != Box(0.25f, 0.5f, 0.125f, 1.f)));
+    CHECK(a != Box(0.26f, 0.5f, 0.125f, 1.f));
+    CHECK(a != Box(0.25f, 0.51f, 0.125f, 1.f));
+    CHECK(a != Box(0.25f, 0.5f, 0.126f, 1.f));
+    CHECK(a != Box(0.25f, 0.5f, 0.125f, 0.99f));
+
+    // float semantics: zeros of either sign match, NaN matches nothing
+    CHECK(Box(-0.f, 0.f, 1.f, 1.f) == Box(0.f, 0.f, 1.f, 1.f));
+    Box nan(NAN, 0.f, 1.f, 1.f);
+    CHECK(nan != nan);
+}
+
+static void point_in_polygon_inside_and_outside() {
+    const std::vector<Point2f> square = rect(0.f, 0.f, 1.f, 1.f);
+    CHECK(point_in_polygon(square, Point2f(0.5f, 0.5f)));
+    CHECK(!point_in_polygon(square, Point2f(1.5f, 0.5f)));
+    CHECK(!point_in_polygon(square, Point2f(0.5f, -0.5f)));
+
+    // concave: the notch of a U is outside
+    const std::vector<Point2f> u = {Point2f(0.f, 0.f), Point2f(3.f, 0.f), Point2f(3.f, 3.f), Point2f(2.f, 3.f),
+                                    Point2f(2.f, 1.f), Point2f(1.f, 1.f), Point2f(1.f, 3.f), Point2f(0.f, 3.f)};
+    CHECK(point_in_polygon(u, Point2f(0.5f, 2.5f)));
+    CHECK(point_in_polygon(u, Point2f(2.5f, 2.5f)));
+    CHECK(!point_in_polygon(u, Point2f(1.5f, 2.f)));
+
+    // fewer than three points enclose nothing
+    CHECK(!point_in_polygon({}, Point2f(0.f, 0.f)));
+    CHECK(!point_in_polygon({Point2f(0.f, 0.f), Point2f(1.f, 1.f)}, Point2f(0.5f, 0.5f)));
+}
+
+// Which side a boundary point falls on is not specified, but polygons sharing an edge or a vertex
+// claim each point of it exactly once, so adjacent regions neither overlap nor leave gaps.
+static void shared_boundaries_belong_to_one_polygon() {
+    const std::vector<std::vector<Point2f>> quarters = {rect(0.f, 0.f, 1.f, 1.f), rect(1.f, 0.f, 2.f, 1.f),
+                                                        rect(0.f, 1.f, 1.f, 2.f), rect(1.f, 1.f, 2.f, 2.f)};
+    // the inner edges, their crossing and the left and top outer edges
+    for (float y = 0.f; y < 2.f; y += 0.5f) {
+        for (float x = 0.f; x < 2.f; x += 0.5f) {
+            int owners = 0;
+            for (const std::vector<Point2f> &quarter: quarters)
+                owners += point_in_polygon(quarter, Point2f(x, y));
+            CHECK(owners == 1);
+        }
+    }
+
+    // the two halves of a square split along its diagonal
+    const std::vector<Point2f> lower = {Point2f(0.f, 0.f), Point2f(1.f, 0.f), Point2f(1.f, 1.f)};
+    const std::vector<Point2f> upper = {Point2f(0.f, 0.f), Point2f(1.f, 1.f), Point2f(0.f, 1.f)};
+    for (float t: {0.125f, 0.25f, 0.5f, 0.75f}) {
+        Point2f p(t, t);
+        CHECK(point_in_polygon(lower, p) != point_in_polygon(upper, p));
+    }
+}
+
+void test_geometry() {
+    intersection_and_area();
+    union_skips_empty_boxes();
+    equality_compares_every_field();
+    point_in_polygon_inside_and_outside();
+    shared_boundaries_belong_to_one_polygon();
+}
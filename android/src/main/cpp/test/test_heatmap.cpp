@@ -0,0 +1,132 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "heatmap.h"
+#include "test.h"
+
+static const int64_t SECOND = 1000000000;
+static const int64_t FRAME_NS = SECOND / 10;
+
+static std::vector<DetectedObject> object(float x, float y, float width, float height) {
+    DetectedObject obj{};
+    obj.rect = Box(x, y, width, height);
+    obj.confidence = 0.9f;
+    return {obj};
+}
+
+static void footprint_cells_collect_presence() {
+    Heatmap heatmap;
+    heatmap.configure(10, 10, 0);
+    std::vector<uint8_t> out;
+    CHECK(heatmap.snapshot(0, out) == 0.f);
+
+    // the first frame only starts the clock, the lower fifth of the box gets the time after it
+    std::vector<DetectedObject> objects = object(0.f, 0.f, 0.5f, 1.f);
+    heatmap.accumulate(objects, 0);
+    heatmap.accumulate(objects, FRAME_NS);
+    heatmap.accumulate(objects, 2 * FRAME_NS);
+
+    CHECK_NEAR(heatmap.snapshot(2 * FRAME_NS, out), 0.2, 1e-6);
+    CHECK(out.size() == 100);
+    for (int y = 0; y < 10; y++) {
+        for (int x = 0; x < 10; x++)
+            CHECK(out[y * 10 + x] == (x < 5 && y >= 8 ? 255 : 0));
+    }
+
+    // a tiny box still covers a cell
+    heatmap.accumulate(object(0.91f, 0.01f, 0.001f, 0.001f), 3 * FRAME_NS);
+    heatmap.snapshot(3 * FRAME_NS, out);
+    CHECK(out[9] == 128);
+}
+
+static void gaps_are_capped() {
+    Heatmap heatmap;
+    heatmap.configure(4, 4, 0);
+    std::vector<DetectedObject> objects = object(0.f, 0.f, 1.f, 1.f);
+    std::vector<uint8_t> out;
+
+    heatmap.accumulate(objects, 0);
+    heatmap.accumulate(objects, 5 * SECOND);
+    CHECK_NEAR(heatmap.snapshot(5 * SECOND, out), 0.2, 1e-6);
+
+    heatmap.max_frame_gap_ns = SECOND;
+    heatmap.accumulate(objects, 6 * SECOND);
+    CHECK_NEAR(heatmap.snapshot(6 * SECOND, out), 1.2, 1e-6);
+
+    // time running backwards adds nothing
+    heatmap.accumulate(objects, 5 * SECOND);
+    CHECK_NEAR(heatmap.snapshot(6 * SECOND, out), 1.2, 1e-6);
+}
+
+static void heat_halves_every_half_life() {
+    Heatmap heatmap;
+    heatmap.configure(4, 4, 2 * SECOND);
+    std::vector<DetectedObject> objects = object(0.f, 0.f, 1.f, 1.f);
+    std::vector<DetectedObject> none;
+    std::vector<uint8_t> out;
+
+    heatmap.accumulate(objects, 0);
+    heatmap.accumulate(objects, FRAME_NS);
+    const float peak = heatmap.snapshot(FRAME_NS, out);
+    CHECK_NEAR(peak, 0.1, 1e-6);
+
+    // decay happens on read, with or without frames in between
+    CHECK_NEAR(heatmap.snapshot(FRAME_NS + 2 * SECOND, out), peak / 2, 1e-6);
+    heatmap.accumulate(none, FRAME_NS + 2 * SECOND);
+    CHECK_NEAR(heatmap.snapshot(FRAME_NS + 4 * SECOND, out), peak / 4, 1e-6);
+    CHECK(out[15] == 255);
+}
+
+static void rescaling_keeps_the_heat_continuous() {
+    // a half life of a second passes the largest gain after 20 seconds, the footprint is the
+    // lower left cell
+    Heatmap heatmap;
+    heatmap.configure(2, 2, SECOND);
+    heatmap.max_frame_gap_ns = SECOND;
+    std::vector<DetectedObject> objects = object(0.f, 0.f, 0.5f, 1.f);
+    std::vector<uint8_t> out;
+
+    // the same sum in double precision, decayed every frame
+    double expected = 0.;
+    int64_t timestamp = 0;
+    heatmap.accumulate(objects, timestamp);
+    for (int i = 1; i <= 400; i++) {
+        timestamp += FRAME_NS;
+        expected = expected * std::exp2(-0.1) + 0.1;
+        heatmap.accumulate(objects, timestamp);
+
+        float peak = heatmap.snapshot(timestamp, out);
+        CHECK(std::fabs(peak - expected) <= 1e-4 * expected);
+        CHECK(out[2] == 255 && out[0] == 0 && out[3] == 0);
+    }
+    // close to the steady state 0.1 / (1 - 2^-0.1)
+    CHECK_NEAR(expected, 0.1 / (1. - std::exp2(-0.1)), 1e-3);
+}
+
+static void configure_clears_the_grid() {
+    Heatmap heatmap;
+    CHECK(!heatmap.enabled());
+    heatmap.configure(3, 2, 0);
+    CHECK(heatmap.enabled() && heatmap.width() == 3 && heatmap.height() == 2);
+
+    std::vector<DetectedObject> objects = object(0.f, 0.f, 1.f, 1.f);
+    heatmap.accumulate(objects, 0);
+    heatmap.accumulate(objects, FRAME_NS);
+    heatmap.configure(3, 2, 0);
+
+    std::vector<uint8_t> out;
+    CHECK(heatmap.snapshot(FRAME_NS, out) == 0.f);
+    CHECK(out.size() == 6);
+
+    heatmap.configure(0, 2, 0);
+    CHECK(!heatmap.enabled());
+}
+
+void test_heatmap() {
+    footprint_cells_collect_presence();
+    gaps_are_capped();
+    heat_halves_every_half_life();
+    rescaling_keeps_the_heat_continuous();
+    configure_clears_the_grid();
+}
@@ -0,0 +1,51 @@
+#include <cstring>
+
+#include "test.h"
+
+int test_failures = 0;
+
+struct Suite {
+    const char *name;
+    void (*run)();
+};
+
+static const Suite SUITES[] = {
+        {"atomic_config", test_atomic_config},
+        {"detection_log", test_detection_log},
+        {"frame_recording", test_frame_recording},
+        {"geometry", test_geometry},
+        {"heatmap", test_heatmap},
+        {"memory_budget", test_memory_budget},
+        {"output_exchange", test_output_exchange},
+        {"postprocess", test_postprocess},
+        {"preprocess", test_preprocess},
+        {"reid", test_reid},
+        {"roi_mask", test_roi_mask},
+        {"rule_engine", test_rule_engine},
+        {"smoothing", test_smoothing},
+        {"track_history", test_track_history},
+        {"tracker", test_tracker},
+        {"zoom_controller", test_zoom_controller},
+};
+
+int main(int argc, char **argv) {
+    // optional suite name, every suite runs without it
+    const char *filter = argc > 1 ? argv[1] : nullptr;
+
+    int ran = 0;
+    for (const Suite &suite: SUITES) {
+        if (filter != nullptr && strcmp(filter, suite.name) != 0)
+            continue;
+
+        const int failures = test_failures;
+        suite.run();
+        printf("%-24s %s\n", suite.name, test_failures == failures ? "passed" : "FAILED");
+        ran++;
+    }
+
+    if (ran == 0) {
+        printf("no suite named %s\n", filter);
+        return 1;
+    }
+    return test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "embedding_gallery.h"
+#include "memory_budget.h"
+#include "test.h"
+#include "track_history.h"
+#include "tracker.h"
+
+static const int64_t FRAME_NS = 33333333;
+
+static void allocators_charge_exactly() {
+    const size_t before = memory_used(MEMORY_SCRATCH);
+    {
+        CountedVector<double, MEMORY_SCRATCH> values(100);
+        CHECK(memory_used(MEMORY_SCRATCH) == before + 100 * sizeof(double));
+
+        values.reserve(1000);
+        CHECK(memory_used(MEMORY_SCRATCH) == before + 1000 * sizeof(double));
+
+        // copies charge their own allocation
+        CountedVector<double, MEMORY_SCRATCH> copy(values);
+        CHECK(memory_used(MEMORY_SCRATCH) == before + 1100 * sizeof(double));
+
+        values.clear();
+        values.shrink_to_fit();
+        CHECK(memory_used(MEMORY_SCRATCH) == before + 100 * sizeof(double));
+
+        // containers rebind the allocator to their nodes, those are charged too
+        std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                CountingAllocator<std::pair<const int, int>, MEMORY_SCRATCH>> map;
+        for (int i = 0; i < 100; i++)
+            map[i] = i;
+        CHECK(memory_used(MEMORY_SCRATCH) > before + 100 * sizeof(double));
+    }
+    CHECK(memory_used(MEMORY_SCRATCH) == before);
+}
+
+static void budget_is_checked_against_every_subsystem() {
+    const size_t total = memory_used_total();
+    CHECK(!memory_over_budget());
+
+    set_memory_budget(total + 64);
+    CHECK(memory_budget() == total + 64);
+    CHECK(!memory_over_budget());
+
+    {
+        CountedVector<char, MEMORY_FRAMES> frames(32);
+        CountedVector<char, MEMORY_CACHES> caches(32);
+        CHECK(memory_used_total() == total + 64);
+        CHECK(!memory_over_budget());
+
+        CountedVector<char, MEMORY_TRACKER> tracker(1);
+        CHECK(memory_over_budget());
+    }
+    CHECK(!memory_over_budget());
+
+    // no limit
+    set_memory_budget(0);
+    CountedVector<char, MEMORY_FRAMES> frames(1024);
+    CHECK(!memory_over_budget());
+}
+
+// Fills a gallery, a history and a tracker, then sheds them in the order the pipeline does until
+// the total is under a budget a quarter below what they hold.
+static void shedding_gets_under_the_budget() {
+    const size_t base = memory_used_total();
+
+    EmbeddingGallery gallery;
+    gallery.reset(64, 512);
+    std::vector<float> embedding(64);
+    for (int i = 0; i < 512; i++) {
+        for (int d = 0; d < 64; d++)
+            embedding[d] = (float) ((i * 31 + d * 17) % 23) - 11.f;
+        gallery.add(i, embedding.data());
+    }
+
+    TrackHistory history;
+    history.configure(64 * 1024, 32, 0.01f);
+    Tracker tracker;
+    std::vector<DetectedObject> objects;
+    for (int i = 0; i < 100; i++) {
+        DetectedObject obj{};
+        obj.rect = Box(0.1f * (i % 10), 0.1f * (i / 10), 0.05f, 0.05f);
+        obj.confidence = 0.9f;
+        objects.push_back(obj);
+    }
+    tracker.update(objects, 0);
+    history.update(tracker.tracks(), 0);
+    // all but ten are lost
+    objects.resize(10);
+    tracker.update(objects, FRAME_NS);
+    history.update(tracker.tracks(), FRAME_NS);
+
+    const size_t held = memory_used_total() - base;
+    set_memory_budget(base + held * 3 / 4);
+    CHECK(memory_over_budget());
+
+    size_t caches = memory_used(MEMORY_CACHES);
+    gallery.shrink();
+    CHECK(gallery.size() == 256);
+    CHECK(memory_used(MEMORY_CACHES) < caches);
+
+    size_t used = memory_used(MEMORY_HISTORY);
+    history.shed();
+    CHECK(memory_used(MEMORY_HISTORY) < used);
+    CHECK(history.memory_usage() <= 32 * 1024);
+
+    used = memory_used(MEMORY_TRACKER);
+    tracker.shed();
+    CHECK(memory_used(MEMORY_TRACKER) < used);
+    CHECK(tracker.tracks().size() == 10);
+
+    CHECK(!memory_over_budget());
+    set_memory_budget(0);
+}
+
+void test_memory_budget() {
+    allocators_charge_exactly();
+    budget_is_checked_against_every_subsystem();
+    shedding_gets_under_the_budget();
+}
@@ -0,0 +1,121 @@
+#include "output_exchange.h"
+#include "test.h"
+
+// Writes a frame into the next free slot the way the detector does, returns the slot or -1.
+static int write_frame(OutputExchange &exchange, uint32_t frame_id) {
+    const int slot = exchange.begin_write();
+    if (slot < 0)
+        return -1;
+    float *data = exchange.slot_data(slot);
+    data[0] = (float) frame_id;
+    exchange.publish(data, frame_id, frame_id * 10);
+    return slot;
+}
+
+static void latest_output_is_acquired_once() {
+    OutputExchange exchange;
+    const int64_t id = exchange.configure(2, 3);
+
+    CHECK(ultralytics_output_acquire(id).data == nullptr);
+
+    write_frame(exchange, 1);
+    write_frame(exchange, 2);
+    UltralyticsOutput output = ultralytics_output_acquire(id);
+    CHECK(output.data != nullptr);
+    CHECK(output.frame_id == 2);
+    CHECK(output.timestamp == 20);
+    CHECK(output.rows == 2 && output.cols == 3);
+    CHECK(output.data[0] == 2.f);
+
+    // nothing new was published since
+    CHECK(ultralytics_output_acquire(id).data == nullptr);
+    ultralytics_output_release(output.token);
+}
+
+static void held_and_unread_slots_are_not_reused() {
+    OutputExchange exchange;
+    const int64_t id = exchange.configure(1, 4);
+
+    const int held = write_frame(exchange, 1);
+    UltralyticsOutput output = ultralytics_output_acquire(id);
+    const int unread = write_frame(exchange, 2);
+    CHECK(unread != held);
+
+    // the third slot is the only one left, and stays the only one while nothing changes
+    const int third = exchange.begin_write();
+    CHECK(third >= 0 && third != held && third != unread);
+    CHECK(exchange.begin_write() == third);
+
+    // publishing it makes the unread slot free, the held one never is
+    exchange.publish(exchange.slot_data(third), 3, 30);
+    CHECK(exchange.begin_write() == unread);
+    CHECK(output.data[0] == 1.f);
+
+    ultralytics_output_release(output.token);
+    CHECK(exchange.begin_write() == held);
+}
+
+static void every_slot_held_skips_the_output() {
+    OutputExchange exchange;
+    const int64_t id = exchange.configure(1, 1);
+
+    UltralyticsOutput outputs[OutputExchange::NUM_SLOTS];
+    for (int i = 0; i < OutputExchange::NUM_SLOTS; i++) {
+        CHECK(write_frame(exchange, i + 1) >= 0);
+        outputs[i] = ultralytics_output_acquire(id);
+    }
+    CHECK(exchange.begin_write() == -1);
+
+    ultralytics_output_release(outputs[1].token);
+    CHECK(write_frame(exchange, 9) >= 0);
+    for (const UltralyticsOutput &output: outputs)
+        ultralytics_output_release(output.token);
+}
+
+static void foreign_buffers_are_not_published() {
+    OutputExchange exchange;
+    const int64_t id = exchange.configure(1, 2);
+
+    // the interpreter wrote into its own buffer instead of the slot
+    float other[2] = {};
+    exchange.begin_write();
+    exchange.publish(other, 1, 10);
+    CHECK(ultralytics_output_acquire(id).data == nullptr);
+}
+
+static void held_output_outlives_its_exchange() {
+    UltralyticsOutput output;
+    int64_t id;
+    {
+        OutputExchange exchange;
+        id = exchange.configure(1, 2);
+        write_frame(exchange, 5);
+        output = ultralytics_output_acquire(id);
+
+        // a new shape replaces the slots but not the one Dart holds
+        exchange.configure(2, 2);
+        CHECK(output.data[0] == 5.f);
+        CHECK(exchange.begin_write() >= 0);
+    }
+    CHECK(output.data[0] == 5.f);
+    CHECK(ultralytics_output_acquire(id).data == nullptr);
+    ultralytics_output_release(output.token);
+}
+
+static void same_shape_keeps_the_slots() {
+    OutputExchange exchange;
+    const int64_t id = exchange.configure(1, 2);
+    float *data = exchange.slot_data(0);
+    CHECK(exchange.configure(1, 2) == id);
+    CHECK(exchange.slot_data(0) == data);
+    CHECK(exchange.slot_data(OutputExchange::NUM_SLOTS) == nullptr);
+}
+
+void test_output_exchange() {
+    latest_output_is_acquired_once();
+    held_and_unread_slots_are_not_reused();
+    every_slot_held_skips_the_output();
+    foreign_buffers_are_not_published();
+    held_output_outlives_its_exchange();
+    same_shape_keeps_the_slots();
+}
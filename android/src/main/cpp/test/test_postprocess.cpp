@@ -0,0 +1,234 @@
+#include <cstdint>
+#include <vector>
+
+#include "postprocess.h"
+#include "predictor.h"
+#include "test.h"
+
+// A [4 + num_classes][num_anchors] output with every score 0.
+struct Output {
+    int num_classes;
+    int num_anchors;
+    std::vector<float> data;
+
+    Output(int classes, int anchors)
+            : num_classes(classes), num_anchors(anchors), data((size_t) (4 + classes) * anchors, 0.f) {}
+
+    void set_box(int anchor, float cx, float cy, float w, float h) {
+        data[anchor] = cx;
+        data[num_anchors + anchor] = cy;
+        data[2 * num_anchors + anchor] = w;
+        data[3 * num_anchors + anchor] = h;
+    }
+
+    void set_score(int anchor, int class_index, float score) {
+        data[(size_t) (4 + class_index) * num_anchors + anchor] = score;
+    }
+};
+
+static PostprocessConfig config(float iou_threshold, int max_detections) {
+    PostprocessConfig config;
+    config.confidence_threshold = 0.25f;
+    config.iou_threshold = iou_threshold;
+    config.max_detections = max_detections;
+    return config;
+}
+
+static void decode_converts_the_best_class() {
+    Output output(3, 4);
+    output.set_box(1, 0.5f, 0.5f, 0.2f, 0.4f);
+    output.set_score(1, 0, 0.3f);
+    output.set_score(1, 2, 0.8f);
+    // ties keep the lowest class
+    output.set_box(2, 0.2f, 0.2f, 0.1f, 0.1f);
+    output.set_score(2, 1, 0.6f);
+    output.set_score(2, 2, 0.6f);
+    // the threshold itself does not pass
+    output.set_score(3, 0, 0.25f);
+
+    Detections proposals;
+    generate_proposals(output.data.data(), 4, 3, 0.25f, nullptr, proposals);
+    CHECK(proposals.size() == 2);
+    if (proposals.size() != 2)
+        return;
+    CHECK(proposals.class_index()[0] == 2);
+    CHECK_NEAR(proposals.score()[0], 0.8f, 1e-6);
+    CHECK_NEAR(proposals.x1()[0], 0.4f, 1e-6);
+    CHECK_NEAR(proposals.y1()[0], 0.3f, 1e-6);
+    CHECK_NEAR(proposals.x2()[0], 0.6f, 1e-6);
+    CHECK_NEAR(proposals.y2()[0], 0.7f, 1e-6);
+    CHECK(proposals.class_index()[1] == 1);
+}
+
+static void decode_skips_masked_anchors() {
+    // a full block and a partial one
+    const int anchors = 100;
+    Output output(1, anchors);
+    for (int i = 0; i < anchors; i++) {
+        output.set_box(i, 0.5f, 0.5f, 0.1f, 0.1f);
+        output.set_score(i, 0, 0.9f);
+    }
+
+    Detections proposals;
+    generate_proposals(output.data.data(), anchors, 1, 0.25f, nullptr, proposals);
+    CHECK(proposals.size() == anchors);
+
+    // anchors 3 and 70, a missing word masks its block out
+    std::vector<uint64_t> mask = {1ull << 3, 1ull << 6};
+    proposals.clear();
+    generate_proposals(output.data.data(), anchors, 1, 0.25f, &mask, proposals);
+    CHECK(proposals.size() == 2);
+
+    mask.resize(1);
+    proposals.clear();
+    generate_proposals(output.data.data(), anchors, 1, 0.25f, &mask, proposals);
+    CHECK(proposals.size() == 1);
+}
+
+static void specialized_kernels_match_the_generic_one() {
+    uint32_t seed = 12345;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float) (seed >> 8) / (float) (1u << 24);
+    };
+
+    for (int classes: {1, 2, 3, 80, 365, 600}) {
+        const int anchors = 300;
+        Output output(classes, anchors);
+        for (float &value: output.data)
+            value = random();
+
+        Detections generic;
+        Detections specialized;
+        decode_kernel(classes, false)(output.data.data(), anchors, classes, 0.5f, nullptr, generic);
+        decode_kernel(classes)(output.data.data(), anchors, classes, 0.5f, nullptr, specialized);
+
+        CHECK(generic.size() > 0);
+        CHECK(generic.size() == specialized.size());
+        if (generic.size() != specialized.size())
+            continue;
+        for (size_t i = 0; i < generic.size(); i++) {
+            CHECK(generic.class_index()[i] == specialized.class_index()[i]);
+            CHECK(generic.score()[i] == specialized.score()[i]);
+            CHECK(generic.x1()[i] == specialized.x1()[i]);
+            CHECK(generic.y2()[i] == specialized.y2()[i]);
+        }
+    }
+}
+
+static void nms_suppresses_overlaps() {
+    Detections proposals;
+    proposals.push_back(0.10f, 0.10f, 0.50f, 0.50f, 0.7f, 0);
+    proposals.push_back(0.12f, 0.12f, 0.52f, 0.52f, 0.9f, 1);
+    proposals.push_back(0.60f, 0.60f, 0.90f, 0.90f, 0.8f, 0);
+
+    Detections selected;
+    select_detections(proposals, config(0.45f, 10), selected);
+    CHECK(selected.size() == 2);
+    if (selected.size() == 2) {
+        CHECK_NEAR(selected.score()[0], 0.9f, 1e-6);
+        CHECK_NEAR(selected.score()[1], 0.8f, 1e-6);
+    }
+
+    // boxes of other classes survive per class
+    PostprocessConfig per_class = config(0.45f, 10);
+    per_class.nms_mode = NMS_PER_CLASS;
+    select_detections(proposals, per_class, selected);
+    CHECK(selected.size() == 3);
+
+    // overlaps up to the threshold are kept
+    select_detections(proposals, config(0.99f, 10), selected);
+    CHECK(selected.size() == 3);
+
+    select_detections(proposals, config(0.45f, 1), selected);
+    CHECK(selected.size() == 1);
+}
+
+static void select_filters_orders_and_clamps() {
+    Detections proposals;
+    proposals.push_back(-0.1f, 0.2f, 0.3f, 1.2f, 0.5f, 0);
+    proposals.push_back(0.5f, 0.5f, 0.6f, 0.6f, 0.5f, 1);
+    proposals.push_back(0.7f, 0.7f, 0.8f, 0.8f, 0.9f, 2);
+
+    // equal scores keep their position
+    Detections selected;
+    select_detections(proposals, config(0.45f, 10), selected);
+    CHECK(selected.size() == 3);
+    if (selected.size() == 3) {
+        CHECK(selected.class_index()[0] == 2);
+        CHECK(selected.class_index()[1] == 0);
+        CHECK(selected.class_index()[2] == 1);
+        CHECK(selected.x1()[1] == 0.f);
+        CHECK(selected.y2()[1] == 1.f);
+    }
+
+    PostprocessConfig filtered = config(0.45f, 10);
+    filtered.classes = {1, 1, 0};
+    select_detections(proposals, filtered, selected);
+    CHECK(selected.size() == 2);
+
+    PostprocessConfig capped = config(0.45f, 10);
+    capped.max_proposals = 2;
+    select_detections(proposals, capped, selected);
+    CHECK(selected.size() == 2);
+    if (selected.size() == 2) {
+        CHECK(selected.class_index()[0] == 2);
+        CHECK(selected.class_index()[1] == 0);
+    }
+}
+
+static void gather_keeps_extra_columns() {
+    Detections rows(2);
+    for (int i = 0; i < 3; i++) {
+        size_t row = rows.push_back(0.f, 0.f, 0.1f * (i + 1), 0.2f, 0.5f, i);
+        rows.extra(0)[row] = (float) i;
+        rows.extra(1)[row] = (float) (10 * i);
+    }
+
+    const int order[] = {2, 0};
+    Detections gathered;
+    rows.gather(order, 2, gathered);
+    CHECK(gathered.size() == 2);
+    CHECK(gathered.extra_columns() == 2);
+    CHECK(gathered.class_index()[0] == 2 && gathered.class_index()[1] == 0);
+    CHECK(gathered.extra(0)[0] == 2.f && gathered.extra(1)[0] == 20.f);
+
+    std::vector<DetectedObject> objects;
+    gathered.append_objects(objects);
+    CHECK(objects.size() == 2);
+    if (objects.size() == 2) {
+        CHECK_NEAR(objects[0].rect.width, 0.3f, 1e-6);
+        CHECK_NEAR(objects[0].rect.height, 0.2f, 1e-6);
+        CHECK(objects[0].index == 2);
+    }
+}
+
+static void detector_maps_to_the_frame() {
+    Output output(2, 8);
+    output.set_box(5, 0.5f, 0.5f, 0.5f, 0.5f);
+    output.set_score(5, 1, 0.9f);
+
+    Detector detector(64, 2, 8);
+    detector.configure(config(0.45f, 10));
+    detector.postprocess(output.data.data(), Box(0.5f, 0.f, 0.5f, 1.f));
+
+    const std::vector<DetectedObject> &objects = detector.objects();
+    CHECK(objects.size() == 1);
+    if (objects.size() == 1) {
+        CHECK(objects[0].index == 1);
+        CHECK_NEAR(objects[0].rect.x, 0.625f, 1e-6);
+        CHECK_NEAR(objects[0].rect.y, 0.25f, 1e-6);
+        CHECK_NEAR(objects[0].rect.width, 0.25f, 1e-6);
+        CHECK_NEAR(objects[0].rect.height, 0.5f, 1e-6);
+    }
+}
+
+void test_postprocess() {
+    decode_converts_the_best_class();
+    decode_skips_masked_anchors();
+    specialized_kernels_match_the_generic_one();
+    nms_suppresses_overlaps();
+    select_filters_orders_and_clamps();
+    gather_keeps_extra_columns();
+    detector_maps_to_the_frame();
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "cpu_features.h"
+#include "predictor.h"
+#include "preprocess.h"
+#include "test.h"
+
+// sensor size, the display is 120 x 160 for rotations of 90 and 270
+static const int WIDTH = 160;
+static const int HEIGHT = 120;
+static const int INPUT = 64;
+
+// An I420 frame with a bright square at `square` of the display, dark elsewhere.
+struct SquareFrame {
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> uv;
+    Frame frame;
+
+    SquareFrame(const Box &square, int rotation)
+            : y((size_t) WIDTH * HEIGHT), uv((size_t) WIDTH * HEIGHT / 4, 128) {
+        for (int sy = 0; sy < HEIGHT; sy++) {
+            for (int sx = 0; sx < WIDTH; sx++) {
+                // pixel center in the display orientation
+                float fx = (sx + 0.5f) / WIDTH;
+                float fy = (sy + 0.5f) / HEIGHT;
+                float u = rotation == 0 ? fx : rotation == 90 ? 1.f - fy : rotation == 180 ? 1.f - fx : fy;
+                float v = rotation == 0 ? fy : rotation == 90 ? fx : rotation == 180 ? 1.f - fy : 1.f - fx;
+                bool inside = u >= square.x && u < square.x + square.width &&
+                              v >= square.y && v < square.y + square.height;
+                y[(size_t) sy * WIDTH + sx] = inside ? 235 : 16;
+            }
+        }
+        frame.planes = {y.data(), uv.data(), uv.data(), WIDTH, HEIGHT, WIDTH, WIDTH / 2, 1};
+        frame.rotation = rotation;
+        frame.timestamp = 0;
+    }
+};
+
+// Bounding box of the bright input pixels, normalized to the input.
+static Box bright_box(const std::vector<float> &input) {
+    int x1 = INPUT, y1 = INPUT, x2 = -1, y2 = -1;
+    for (int y = 0; y < INPUT; y++) {
+        for (int x = 0; x < INPUT; x++) {
+            if (input[((size_t) y * INPUT + x) * 3] < 0.5f)
+                continue;
+            x1 = std::min(x1, x);
+            y1 = std::min(y1, y);
+            x2 = std::max(x2, x + 1);
+            y2 = std::max(y2, y + 1);
+        }
+    }
+    if (x2 < 0)
+        return Box();
+    return Box((float) x1 / INPUT, (float) y1 / INPUT, (float) (x2 - x1) / INPUT, (float) (y2 - y1) / INPUT);
+}
+
+// A box found in the cropped input lands where the object is in the frame.
+static void crop_round_trips_through_map_to_frame() {
+    const Box square(0.25f, 0.25f, 0.25f, 0.25f);
+    const Box crops[] = {Box(0.f, 0.f, 1.f, 1.f), Box(0.25f, 0.f, 0.5f, 1.f), Box(0.f, 0.125f, 1.f, 0.75f),
+                         Box(0.125f, 0.2f, 0.5f, 0.5f)};
+
+    for (int rotation: {0, 90, 180, 270}) {
+        SquareFrame source(square, rotation);
+        for (const Box &crop: crops) {
+            std::vector<float> input((size_t) INPUT * INPUT * 3);
+            yuv420_crop_resize_rgb(source.frame, crop, input.data(), INPUT, INPUT);
+
+            std::vector<DetectedObject> objects(1);
+            objects[0].rect = bright_box(input);
+            map_to_frame(crop, objects);
+
+            // nearest neighbour sampling is off by at most one input pixel and one sensor pixel
+            const float tolerance = std::max(crop.width, crop.height) / INPUT + 1.f / HEIGHT;
+            const Box &found = objects[0].rect;
+            CHECK_NEAR(found.x, square.x, tolerance);
+            CHECK_NEAR(found.y, square.y, tolerance);
+            CHECK_NEAR(found.x + found.width, square.x + square.width, tolerance);
+            CHECK_NEAR(found.y + found.height, square.y + square.height, tolerance);
+        }
+    }
+}
+
+// Whichever kernel the dispatch picks, every output pixel is bit identical to yuv_to_rgb_pixel().
+// ctest runs this once as detected and once with ULTRALYTICS_CPU_BASELINE set.
+static void kernels_match_the_scalar_reference() {
+    if (getenv("ULTRALYTICS_CPU_BASELINE") != nullptr)
+        CHECK(cpu_extensions_string() == "baseline");
+
+    uint32_t state = 12345;
+    auto random_byte = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (uint8_t) (state >> 24);
+    };
+
+    // every tail length of the 4 and 8 pixel vector loops, odd widths included
+    std::vector<int> widths;
+    for (int w = 1; w <= 40; w++)
+        widths.push_back(w);
+    widths.insert(widths.end(), {63, 64, 65, 333, 640});
+
+    const int height = 4;
+    for (int w: widths) {
+        // full range noise, with the extremes that clamp in every channel
+        const int cw = (w + 1) / 2;
+        std::vector<uint8_t> y((size_t) w * height), u((size_t) cw * height / 2), v((size_t) cw * height / 2);
+        for (uint8_t &value: y)
+            value = random_byte();
+        for (size_t i = 0; i < u.size(); i++) {
+            u[i] = i % 7 == 0 ? 0 : i % 7 == 1 ? 255 : random_byte();
+            v[i] = i % 5 == 0 ? 255 : i % 5 == 1 ? 0 : random_byte();
+        }
+
+        Frame frame{};
+        frame.planes = {y.data(), u.data(), v.data(), w, height, w, cw, 1};
+        std::vector<float> out((size_t) w * height * 3);
+        yuv420_crop_resize_rgb(frame, Box(0.f, 0.f, 1.f, 1.f), out.data(), w, height);
+
+        std::vector<float> expected(out.size());
+        for (int row = 0; row < height; row++) {
+            for (int col = 0; col < w; col++) {
+                size_t chroma = (size_t) (row / 2) * cw + col / 2;
+                yuv_to_rgb_pixel(y[(size_t) row * w + col], u[chroma] - 128.f, v[chroma] - 128.f,
+                                 &expected[((size_t) row * w + col) * 3]);
+            }
+        }
+        CHECK(memcmp(out.data(), expected.data(), out.size() * sizeof(float)) == 0);
+    }
+}
+
+void test_preprocess() {
+    crop_round_trips_through_map_to_frame();
+    kernels_match_the_scalar_reference();
+}
@@ -0,0 +1,79 @@
+#include <vector>
+
+#include "reid.h"
+#include "test.h"
+
+static Track track(int id, int missed) {
+    Track t{};
+    t.id = id;
+    t.rect = Box(0.4f, 0.4f, 0.2f, 0.2f);
+    t.hits = 10;
+    t.missed = missed;
+    return t;
+}
+
+static TrackList tracks(std::initializer_list<Track> list) {
+    TrackList result;
+    for (const Track &t: list)
+        result.push_back(t);
+    return result;
+}
+
+static void lost_track_is_taken_over() {
+    ReIdentifier reid;
+    reid.configure(4, 16, 0.7f);
+
+    const float first[4] = {1.f, 0.f, 0.f, 0.f};
+    CHECK(reid.match(1, first, tracks({track(1, 0)})) == 1);
+    reid.add(1, 1, first);
+
+    // a visible identity cannot be taken over
+    const float similar[4] = {0.9f, 0.1f, 0.f, 0.f};
+    CHECK(reid.match(2, similar, tracks({track(1, 0), track(2, 0)})) == 2);
+    CHECK(reid.match(2, similar, tracks({track(1, 1), track(2, 0)})) == 1);
+
+    // a dissimilar one keeps its own id
+    const float other[4] = {0.f, 0.f, 1.f, 0.f};
+    CHECK(reid.match(3, other, tracks({track(1, 1), track(3, 0)})) == 3);
+}
+
+static void refused_relabel_keeps_the_gallery_clean() {
+    ReIdentifier reid;
+    reid.configure(4, 16, 0.7f);
+
+    const float first[4] = {1.f, 0.f, 0.f, 0.f};
+    reid.add(1, 1, first);
+
+    // matches track 1, but the tracker refuses the relabel
+    const float second[4] = {0.8f, 0.6f, 0.f, 0.f};
+    CHECK(reid.match(2, second, tracks({track(1, 1), track(2, 0)})) == 1);
+    reid.add(2, 2, second);
+
+    // close to track 2 only, it must not be sent to track 1 through track 2's embedding
+    const float third[4] = {0.6f, 0.8f, 0.f, 0.f};
+    CHECK(reid.match(3, third, tracks({track(1, 1), track(2, 1), track(3, 0)})) == 2);
+
+    // resolved tracks are not compared again
+    CHECK(reid.match(2, first, tracks({track(1, 1), track(2, 0)})) == 2);
+}
+
+static void accepted_relabel_stores_under_the_new_id() {
+    ReIdentifier reid;
+    reid.configure(4, 16, 0.7f);
+
+    const float first[4] = {1.f, 0.f, 0.f, 0.f};
+    reid.add(1, 1, first);
+
+    const float second[4] = {0.8f, 0.6f, 0.f, 0.f};
+    CHECK(reid.match(2, second, tracks({track(1, 1), track(2, 0)})) == 1);
+    reid.add(2, 1, second);
+
+    const float third[4] = {0.6f, 0.8f, 0.f, 0.f};
+    CHECK(reid.match(3, third, tracks({track(1, 1), track(3, 0)})) == 1);
+}
+
+void test_reid() {
+    lost_track_is_taken_over();
+    refused_relabel_keeps_the_gallery_clean();
+    accepted_relabel_stores_under_the_new_id();
+}
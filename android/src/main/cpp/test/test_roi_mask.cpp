@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "roi_mask.h"
+#include "test.h"
+
+// 64 x 64 input: 8 x 8 anchors of stride 8, then 4 x 4 of stride 16, then 2 x 2 of stride 32
+static const int INPUT = 64;
+static const int ANCHORS = 84;
+static const Box FULL(0.f, 0.f, 1.f, 1.f);
+
+static std::vector<Point2f> rect(float x1, float y1, float x2, float y2) {
+    return {Point2f(x1, y1), Point2f(x2, y1), Point2f(x2, y2), Point2f(x1, y2)};
+}
+
+static bool bit(const std::vector<uint64_t> &bits, int anchor) {
+    return (bits[anchor >> 6] >> (anchor & 63)) & 1;
+}
+
+static int count(const std::vector<uint64_t> &bits, int num_anchors) {
+    int n = 0;
+    for (int i = 0; i < num_anchors; i++)
+        n += bit(bits, i);
+    return n;
+}
+
+static void anchors_follow_the_strides() {
+    RoiMask mask;
+    mask.set_polygons({rect(0.f, 0.f, 0.5f, 0.5f)});
+    std::shared_ptr<const std::vector<uint64_t>> bits = mask.bits(ANCHORS, INPUT, INPUT, FULL);
+    CHECK(bits != nullptr && bits->size() == 2);
+    if (bits == nullptr)
+        return;
+
+    // the top left quarter of every grid, each grid row-major after the previous one
+    for (int gy = 0; gy < 8; gy++) {
+        for (int gx = 0; gx < 8; gx++)
+            CHECK(bit(*bits, gy * 8 + gx) == (gx < 4 && gy < 4));
+    }
+    for (int gy = 0; gy < 4; gy++) {
+        for (int gx = 0; gx < 4; gx++)
+            CHECK(bit(*bits, 64 + gy * 4 + gx) == (gx < 2 && gy < 2));
+    }
+    CHECK(bit(*bits, 80));
+    CHECK(!bit(*bits, 81) && !bit(*bits, 82) && !bit(*bits, 83));
+    CHECK(count(*bits, 128) == 16 + 4 + 1);
+}
+
+static void crop_maps_anchors_to_the_frame() {
+    RoiMask mask;
+    const Box right_half(0.5f, 0.f, 0.5f, 1.f);
+
+    // the left half of the frame is not in the input at all
+    mask.set_polygons({rect(0.f, 0.f, 0.5f, 1.f)});
+    CHECK(count(*mask.bits(ANCHORS, INPUT, INPUT, right_half), ANCHORS) == 0);
+
+    // the left half of the input is the third quarter of the frame
+    mask.set_polygons({rect(0.5f, 0.f, 0.75f, 1.f)});
+    std::shared_ptr<const std::vector<uint64_t>> bits = mask.bits(ANCHORS, INPUT, INPUT, right_half);
+    CHECK(count(*bits, ANCHORS) == 32 + 8 + 2);
+    CHECK(bit(*bits, 3) && !bit(*bits, 4));
+}
+
+static void unmatched_grids_keep_the_rest() {
+    RoiMask mask;
+    mask.set_polygons({rect(0.f, 0.f, 0.1f, 0.1f)});
+
+    // anchors the grid does not know about are never masked out
+    std::shared_ptr<const std::vector<uint64_t>> bits = mask.bits(100, INPUT, INPUT, FULL);
+    CHECK(bits->size() == 2);
+    CHECK(bit(*bits, 0) && !bit(*bits, 1));
+    CHECK(count(*bits, 100) == 1 + (100 - ANCHORS));
+
+    // fewer anchors than the grid, the mask stops at the last one
+    bits = mask.bits(70, INPUT, INPUT, FULL);
+    CHECK(bits->size() == 2);
+    CHECK(count(*bits, 128) == 1);
+}
+
+static void cache_is_rebuilt_on_changes() {
+    RoiMask mask;
+    CHECK(mask.empty());
+    CHECK(mask.bits(ANCHORS, INPUT, INPUT, FULL) == nullptr);
+
+    // polygons with fewer than three points are dropped
+    mask.set_polygons({{Point2f(0.f, 0.f), Point2f(1.f, 1.f)}});
+    CHECK(mask.empty());
+
+    mask.set_polygons({rect(0.f, 0.f, 0.5f, 0.5f)});
+    std::shared_ptr<const std::vector<uint64_t>> first = mask.bits(ANCHORS, INPUT, INPUT, FULL);
+    CHECK(mask.bits(ANCHORS, INPUT, INPUT, FULL) == first);
+
+    // new polygons publish new bits, the old ones stay intact for frames still using them
+    mask.set_polygons({rect(0.5f, 0.5f, 1.f, 1.f)});
+    std::shared_ptr<const std::vector<uint64_t>> second = mask.bits(ANCHORS, INPUT, INPUT, FULL);
+    CHECK(second != first);
+    CHECK(bit(*first, 0) && !bit(*second, 0));
+    CHECK(bit(*second, 63) && !bit(*first, 63));
+
+    // so does new geometry
+    CHECK(mask.bits(ANCHORS, INPUT, INPUT, Box(0.f, 0.f, 0.5f, 0.5f)) != second);
+    CHECK(mask.bits(ANCHORS, 2 * INPUT, INPUT, FULL) != second);
+
+    mask.set_polygons({});
+    CHECK(mask.bits(ANCHORS, INPUT, INPUT, FULL) == nullptr);
+}
+
+void test_roi_mask() {
+    anchors_follow_the_strides();
+    crop_maps_anchors_to_the_frame();
+    unmatched_grids_keep_the_rest();
+    cache_is_rebuilt_on_changes();
+}
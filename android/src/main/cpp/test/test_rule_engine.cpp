@@ -0,0 +1,159 @@
+#include <vector>
+
+#include "rule_engine.h"
+#include "test.h"
+
+static const int64_t SECOND = 1000000000;
+
+// a 0.2 square centered at (cx, cy), seen in the current frame unless `missed`
+static Track track(int id, float cx, float cy, int index = 0, int missed = 0) {
+    Track t{};
+    t.id = id;
+    t.rect = Box(cx - 0.1f, cy - 0.1f, 0.2f, 0.2f);
+    t.index = index;
+    t.confidence = 0.9f;
+    t.hits = 1;
+    t.missed = missed;
+    return t;
+}
+
+static TrackList tracks(std::initializer_list<Track> list) {
+    TrackList result;
+    for (const Track &t: list)
+        result.push_back(t);
+    return result;
+}
+
+static Rule zone(int id, int class_index, int64_t dwell_ns) {
+    Rule rule{};
+    rule.id = id;
+    rule.type = RULE_ZONE;
+    rule.class_index = class_index;
+    rule.dwell_ns = dwell_ns;
+    rule.points = {Point2f(0.25f, 0.25f), Point2f(0.75f, 0.25f), Point2f(0.75f, 0.75f), Point2f(0.25f, 0.75f)};
+    return rule;
+}
+
+// the vertical line x = 0.5, pointing down
+static Rule line(int id) {
+    Rule rule{};
+    rule.id = id;
+    rule.type = RULE_LINE;
+    rule.class_index = -1;
+    rule.points = {Point2f(0.5f, 0.f), Point2f(0.5f, 1.f)};
+    return rule;
+}
+
+static void zone_enter_dwell_exit() {
+    RuleEngine engine;
+    engine.set_rules({zone(7, -1, SECOND)});
+
+    std::vector<RuleEvent> events;
+    engine.evaluate(tracks({track(1, 0.1f, 0.5f)}), 0, events);
+    CHECK(events.empty());
+
+    engine.evaluate(tracks({track(1, 0.5f, 0.5f)}), SECOND / 2, events);
+    CHECK(events.size() == 1);
+    CHECK(events[0].rule_id == 7 && events[0].type == RULE_EVENT_ENTER && events[0].track_id == 1);
+
+    // dwell fires once, a second after entering
+    events.clear();
+    engine.evaluate(tracks({track(1, 0.5f, 0.5f)}), SECOND, events);
+    CHECK(events.empty());
+    engine.evaluate(tracks({track(1, 0.5f, 0.5f)}), SECOND + SECOND / 2, events);
+    engine.evaluate(tracks({track(1, 0.5f, 0.5f)}), 2 * SECOND, events);
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == RULE_EVENT_DWELL);
+
+    events.clear();
+    engine.evaluate(tracks({track(1, 0.9f, 0.5f)}), 3 * SECOND, events);
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == RULE_EVENT_EXIT);
+    CHECK_NEAR(events[0].x, 0.9, 1e-6);
+}
+
+static void zone_filters_by_class() {
+    RuleEngine engine;
+    engine.set_rules({zone(1, 2, 0)});
+
+    std::vector<RuleEvent> events;
+    engine.evaluate(tracks({track(1, 0.5f, 0.5f, 0), track(2, 0.5f, 0.5f, 2)}), 0, events);
+    CHECK(events.size() == 1);
+    CHECK(events[0].track_id == 2 && events[0].index == 2);
+}
+
+static void lost_track_keeps_its_zone_until_dropped() {
+    RuleEngine engine;
+    engine.set_rules({zone(1, -1, 0)});
+
+    std::vector<RuleEvent> events;
+    engine.evaluate(tracks({track(1, 0.5f, 0.5f)}), 0, events);
+    events.clear();
+
+    // missed frames carry no position, the track stays inside
+    engine.evaluate(tracks({track(1, 0.5f, 0.5f, 0, 1)}), 1, events);
+    CHECK(events.empty());
+
+    // gone from the tracker, it leaves the zone where it was last seen
+    engine.evaluate(tracks({}), 2, events);
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == RULE_EVENT_EXIT && events[0].track_id == 1);
+}
+
+static void line_crossings_have_a_direction() {
+    RuleEngine engine;
+    engine.set_rules({line(3)});
+
+    std::vector<RuleEvent> events;
+    engine.evaluate(tracks({track(1, 0.8f, 0.5f), track(2, 0.2f, 0.5f)}), 0, events);
+    CHECK(events.empty());
+
+    // from the left of the downward line to its right, and back
+    engine.evaluate(tracks({track(1, 0.2f, 0.5f), track(2, 0.8f, 0.5f)}), 1, events);
+    CHECK(events.size() == 2);
+    CHECK(events[0].track_id == 1 && events[0].type == RULE_EVENT_CROSS_FORWARD);
+    CHECK(events[1].track_id == 2 && events[1].type == RULE_EVENT_CROSS_BACKWARD);
+
+    // moving along one side crosses nothing
+    events.clear();
+    engine.evaluate(tracks({track(1, 0.2f, 0.9f), track(2, 0.8f, 0.1f)}), 2, events);
+    CHECK(events.empty());
+}
+
+static void invalid_rules_are_skipped() {
+    Rule open_zone = zone(1, -1, 0);
+    open_zone.points.resize(2);
+    Rule bent_line = line(2);
+    bent_line.points.emplace_back(1.f, 1.f);
+
+    RuleEngine engine;
+    engine.set_rules({open_zone, bent_line});
+    CHECK(engine.empty());
+}
+
+static void relabel_moves_the_zone_state() {
+    RuleEngine engine;
+    engine.set_rules({zone(1, -1, 0)});
+
+    std::vector<RuleEvent> events;
+    engine.evaluate(tracks({track(5, 0.5f, 0.5f)}), 0, events);
+    events.clear();
+
+    // re-identified as track 2, still inside without a second enter
+    engine.relabel(5, 2);
+    engine.evaluate(tracks({track(2, 0.5f, 0.5f)}), 1, events);
+    CHECK(events.empty());
+
+    engine.evaluate(tracks({track(2, 0.9f, 0.5f)}), 2, events);
+    CHECK(events.size() == 1);
+    CHECK(events[0].type == RULE_EVENT_EXIT && events[0].track_id == 2);
+}
+
+void test_rule_engine() {
+    zone_enter_dwell_exit();
+    zone_filters_by_class();
+    lost_track_keeps_its_zone_until_dropped();
+    line_crossings_have_a_direction();
+    invalid_rules_are_skipped();
+    relabel_moves_the_zone_state();
+}
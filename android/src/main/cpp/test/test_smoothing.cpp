@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "smoothing.h"
+#include "test.h"
+
+// 30 frames per second
+static const int64_t FRAME_NS = 33333333;
+
+static DetectedObject object(float x, float y, int index, int track_id) {
+    DetectedObject obj{};
+    obj.rect = Box(x, y, 0.2f, 0.2f);
+    obj.index = index;
+    obj.confidence = 0.9f;
+    obj.track_id = track_id;
+    return obj;
+}
+
+static Smoother smoother() {
+    Smoother smoother;
+    smoother.enabled = true;
+    return smoother;
+}
+
+// Smooths a single object and returns its reported x.
+static float smooth_x(Smoother &smoother, DetectedObject obj, int64_t timestamp) {
+    std::vector<DetectedObject> objects = {obj};
+    smoother.smooth(objects, timestamp);
+    return objects[0].rect.x;
+}
+
+static void disabled_reports_measurements() {
+    Smoother smoother;
+    smooth_x(smoother, object(0.4f, 0.4f, 0, 1), 0);
+    CHECK(smooth_x(smoother, object(0.5f, 0.4f, 0, 1), FRAME_NS) == 0.5f);
+}
+
+static void jitter_is_damped() {
+    Smoother s = smoother();
+
+    // the first frame starts the filter at the measurement
+    CHECK(smooth_x(s, object(0.5f, 0.4f, 0, 1), 0) == 0.5f);
+
+    float low = 1.f, high = 0.f;
+    for (int i = 1; i < 60; i++) {
+        float x = smooth_x(s, object(i % 2 ? 0.51f : 0.49f, 0.4f, 0, 1), i * FRAME_NS);
+        if (i >= 30) {
+            low = std::min(low, x);
+            high = std::max(high, x);
+        }
+    }
+    // the measurements spread over 0.02
+    CHECK(high - low < 0.01f);
+    CHECK_NEAR((low + high) / 2, 0.5f, 0.005f);
+}
+
+static void movement_is_followed() {
+    Smoother s = smoother();
+
+    // a fifth of the frame per second
+    float x = 0.f;
+    for (int i = 0; i < 60; i++)
+        x = smooth_x(s, object(0.1f + 0.2f * i / 30.f, 0.4f, 0, 1), i * FRAME_NS);
+    CHECK_NEAR(x, 0.1f + 0.2f * 59 / 30.f, 0.01f);
+}
+
+static void tracks_keep_their_filters() {
+    Smoother s = smoother();
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0, 1), object(0.7f, 0.7f, 0, 2)};
+    s.smooth(objects, 0);
+
+    // listed in the other order, each object continues its own filter
+    objects = {object(0.72f, 0.7f, 0, 2), object(0.12f, 0.1f, 0, 1)};
+    s.smooth(objects, FRAME_NS);
+    CHECK(objects[0].rect.x > 0.7f && objects[0].rect.x < 0.72f);
+    CHECK(objects[1].rect.x > 0.1f && objects[1].rect.x < 0.12f);
+}
+
+static void untracked_objects_follow_the_overlapping_box() {
+    Smoother s = smoother();
+    smooth_x(s, object(0.4f, 0.4f, 3, -1), 0);
+
+    // overlapping and of the same class: smoothed
+    float x = smooth_x(s, object(0.42f, 0.4f, 3, -1), FRAME_NS);
+    CHECK(x > 0.4f && x < 0.42f);
+
+    // another class starts its own filter
+    CHECK(smooth_x(s, object(0.44f, 0.4f, 4, -1), 2 * FRAME_NS) == 0.44f);
+
+    // so does a box that moved too far
+    CHECK(smooth_x(s, object(0.8f, 0.4f, 3, -1), 3 * FRAME_NS) == 0.8f);
+}
+
+static void missing_objects_are_forgotten() {
+    Smoother s = smoother();
+    s.max_missed = 2;
+    smooth_x(s, object(0.4f, 0.4f, 0, 1), 0);
+
+    std::vector<DetectedObject> none;
+    s.smooth(none, FRAME_NS);
+    s.smooth(none, 2 * FRAME_NS);
+    float x = smooth_x(s, object(0.5f, 0.4f, 0, 1), 3 * FRAME_NS);
+    CHECK(x > 0.4f && x < 0.5f);
+
+    for (int i = 4; i < 7; i++)
+        s.smooth(none, i * FRAME_NS);
+    CHECK(smooth_x(s, object(0.6f, 0.4f, 0, 1), 7 * FRAME_NS) == 0.6f);
+}
+
+static void keypoints_are_smoothed() {
+    Smoother s = smoother();
+    std::vector<DetectedObject> objects = {object(0.4f, 0.4f, 0, 1)};
+    float keypoints[] = {0.5f, 0.5f, 0.9f, 0.3f, 0.6f, 0.8f};
+    s.smooth(objects, keypoints, 2, 0);
+    CHECK(keypoints[0] == 0.5f && keypoints[4] == 0.6f);
+
+    float moved[] = {0.52f, 0.5f, 0.4f, 0.3f, 0.62f, 0.2f};
+    s.smooth(objects, moved, 2, FRAME_NS);
+    CHECK(moved[0] > 0.5f && moved[0] < 0.52f);
+    CHECK(moved[4] > 0.6f && moved[4] < 0.62f);
+    CHECK(moved[1] == 0.5f);
+    // confidences are reported as measured
+    CHECK(moved[2] == 0.4f && moved[5] == 0.2f);
+
+    // boxes without keypoints restart the filters
+    CHECK(smooth_x(s, object(0.45f, 0.4f, 0, 1), 2 * FRAME_NS) == 0.45f);
+}
+
+static void shed_drops_missing_objects() {
+    Smoother s = smoother();
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0, 1), object(0.7f, 0.7f, 0, 2)};
+    s.smooth(objects, 0);
+    objects = {object(0.1f, 0.1f, 0, 1)};
+    s.smooth(objects, FRAME_NS);
+    s.shed();
+
+    objects = {object(0.12f, 0.1f, 0, 1), object(0.72f, 0.7f, 0, 2)};
+    s.smooth(objects, 2 * FRAME_NS);
+    CHECK(objects[0].rect.x > 0.1f && objects[0].rect.x < 0.12f);
+    CHECK(objects[1].rect.x == 0.72f);
+}
+
+void test_smoothing() {
+    disabled_reports_measurements();
+    jitter_is_damped();
+    movement_is_followed();
+    tracks_keep_their_filters();
+    untracked_objects_follow_the_overlapping_box();
+    missing_objects_are_forgotten();
+    keypoints_are_smoothed();
+    shed_drops_missing_objects();
+}
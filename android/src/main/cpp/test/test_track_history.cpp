@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "test.h"
+#include "track_history.h"
+
+static const int64_t FRAME = 33000000;
+static const float QUANT = 1.f / 32767.f;
+
+static TrackList track_at(int id, float cx, float cy) {
+    Track t{};
+    t.id = id;
+    t.rect = Box(cx - 0.05f, cy - 0.05f, 0.1f, 0.1f);
+    t.hits = 1;
+    TrackList tracks;
+    tracks.push_back(t);
+    return tracks;
+}
+
+static std::vector<Point2f> stored_points(const TrackHistory &history, int track_id) {
+    std::vector<uint8_t> packed;
+    int count = history.query(track_id, INT64_MAX, packed);
+    std::vector<Point2f> points;
+    for (int i = 0; i < count; i++) {
+        int16_t x, y;
+        memcpy(&x, &packed[i * 8], 2);
+        memcpy(&y, &packed[i * 8 + 2], 2);
+        points.emplace_back(x * QUANT, y * QUANT);
+    }
+    return points;
+}
+
+static float segment_distance(const Point2f &a, const Point2f &b, const Point2f &p) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float len2 = dx * dx + dy * dy;
+    float t = len2 > 0.f ? std::min(1.f, std::max(0.f, ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2)) : 0.f;
+    return std::hypot(a.x + t * dx - p.x, a.y + t * dy - p.y);
+}
+
+static float path_distance(const std::vector<Point2f> &path, const Point2f &p) {
+    float best = path.empty() ? INFINITY : std::hypot(path[0].x - p.x, path[0].y - p.y);
+    for (size_t i = 1; i < path.size(); i++)
+        best = std::min(best, segment_distance(path[i - 1], path[i], p));
+    return best;
+}
+
+// Feeds `n` frames of `position(i)` and checks every raw center against the stored trajectory.
+template<typename Position>
+static void check_within_epsilon(float epsilon, int n, Position position) {
+    TrackHistory history;
+    history.configure(1 << 20, n, epsilon);
+
+    std::vector<Point2f> raw;
+    for (int i = 0; i < n; i++) {
+        Point2f p = position(i);
+        history.update(track_at(1, p.x, p.y), i * FRAME);
+        raw.emplace_back(std::round(p.x * 32767.f) * QUANT, std::round(p.y * 32767.f) * QUANT);
+    }
+
+    std::vector<Point2f> path = stored_points(history, 1);
+    CHECK(path.size() < raw.size() / 2);
+    float worst = 0.f;
+    for (const Point2f &p: raw)
+        worst = std::max(worst, path_distance(path, p));
+    CHECK(worst <= epsilon + 2 * QUANT);
+}
+
+static void straight_line_is_within_epsilon() {
+    check_within_epsilon(0.005f, 300, [](int i) { return Point2f(0.1f + i * 0.002f, 0.2f + i * 0.001f); });
+}
+
+// a gentle arc, each step within epsilon of the previous chord while the run drifts away from it
+static void slow_curve_is_within_epsilon() {
+    check_within_epsilon(0.005f, 600, [](int i) {
+        float a = i * 0.004f;
+        return Point2f(0.5f + 0.4f * std::cos(a), 0.5f + 0.4f * std::sin(a));
+    });
+}
+
+static void jittery_walk_is_within_epsilon() {
+    uint32_t state = 99;
+    auto random = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.f / 16777216.f) - 0.5f;
+    };
+    float x = 0.5f, y = 0.5f, vx = 0.002f, vy = 0.f;
+    std::vector<Point2f> positions;
+    for (int i = 0; i < 1000; i++) {
+        vx += 0.0005f * random();
+        vy += 0.0005f * random();
+        x = std::min(0.95f, std::max(0.05f, x + vx));
+        y = std::min(0.95f, std::max(0.05f, y + vy));
+        positions.emplace_back(x + 0.002f * random(), y + 0.002f * random());
+    }
+    check_within_epsilon(0.004f, (int) positions.size(), [&](int i) { return positions[i]; });
+}
+
+static void still_object_keeps_the_time_resolution() {
+    TrackHistory history;
+    history.configure(1 << 16, 64, 0.01f);
+
+    // ten seconds without moving, a point at least every second
+    for (int i = 0; i < 300; i++)
+        history.update(track_at(1, 0.5f, 0.5f), i * FRAME);
+
+    std::vector<uint8_t> packed;
+    int count = history.query(1, INT64_MAX, packed);
+    CHECK(count >= 9 && count <= 12);
+}
+
+static void budget_evicts_the_oldest_track() {
+    TrackHistory history;
+    // room for two rings of 16 points
+    history.configure(2 * (16 * sizeof(HistoryPoint) + 64), 16, 0.01f);
+
+    std::vector<uint8_t> packed;
+    history.update(track_at(1, 0.1f, 0.1f), 0);
+    history.update(track_at(2, 0.2f, 0.2f), FRAME);
+    history.update(track_at(3, 0.3f, 0.3f), 2 * FRAME);
+    CHECK(history.query(1, INT64_MAX, packed) == 0);
+    CHECK(history.query(2, INT64_MAX, packed) == 1);
+    CHECK(history.query(3, INT64_MAX, packed) == 1);
+}
+
+static void relabel_and_window() {
+    TrackHistory history;
+    history.configure(1 << 16, 64, 0.001f);
+    for (int i = 0; i < 60; i++) {
+        // a zigzag, every point is kept
+        history.update(track_at(4, 0.2f + 0.01f * i, i % 2 ? 0.3f : 0.4f), i * FRAME);
+    }
+
+    history.relabel(4, 1);
+    std::vector<uint8_t> packed;
+    CHECK(history.query(4, INT64_MAX, packed) == 0);
+    CHECK(history.query(1, INT64_MAX, packed) == 60);
+
+    // the last second, ages measured from the latest update
+    packed.clear();
+    int count = history.query(1, 1000000000, packed);
+    CHECK(count == 31);
+    uint32_t age;
+    memcpy(&age, &packed[(count - 1) * 8 + 4], 4);
+    CHECK(age == 0);
+}
+
+void test_track_history() {
+    straight_line_is_within_epsilon();
+    slow_curve_is_within_epsilon();
+    jittery_walk_is_within_epsilon();
+    still_object_keeps_the_time_resolution();
+    budget_evicts_the_oldest_track();
+    relabel_and_window();
+}
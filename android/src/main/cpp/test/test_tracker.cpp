@@ -0,0 +1,154 @@
+#include <vector>
+
+#include "test.h"
+#include "tracker.h"
+
+static const int64_t SECOND = 1000000000;
+
+static DetectedObject object(float x, float y, float size, int index = 0) {
+    DetectedObject obj;
+    obj.rect = Box(x, y, size, size);
+    obj.index = index;
+    obj.confidence = 0.9f;
+    return obj;
+}
+
+static void new_objects_get_distinct_ids() {
+    Tracker tracker;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f), object(0.6f, 0.6f, 0.2f)};
+    tracker.update(objects, 0);
+
+    CHECK(objects[0].track_id == 1);
+    CHECK(objects[1].track_id == 2);
+    CHECK(tracker.tracks().size() == 2);
+}
+
+static void overlapping_object_keeps_its_id() {
+    Tracker tracker;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f)};
+    tracker.update(objects, 0);
+
+    objects = {object(0.12f, 0.1f, 0.2f)};
+    tracker.update(objects, SECOND / 10);
+    CHECK(objects[0].track_id == 1);
+    CHECK(tracker.tracks().size() == 1);
+
+    // half of the 0.2 units per second of the measurement, with the default smoothing
+    CHECK_NEAR(tracker.tracks()[0].vx, 0.1, 1e-4);
+    CHECK_NEAR(tracker.tracks()[0].vy, 0.0, 1e-6);
+}
+
+static void other_class_starts_a_new_track() {
+    Tracker tracker;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f, 0)};
+    tracker.update(objects, 0);
+
+    objects = {object(0.1f, 0.1f, 0.2f, 1)};
+    tracker.update(objects, SECOND / 30);
+    CHECK(objects[0].track_id == 2);
+}
+
+static void best_overlap_wins_the_track() {
+    Tracker tracker;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f)};
+    tracker.update(objects, 0);
+
+    objects = {object(0.15f, 0.1f, 0.2f), object(0.11f, 0.1f, 0.2f)};
+    tracker.update(objects, SECOND / 30);
+    CHECK(objects[1].track_id == 1);
+    CHECK(objects[0].track_id == 2);
+}
+
+static void lost_tracks_are_dropped() {
+    Tracker tracker;
+    tracker.max_missed = 2;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f)};
+    tracker.update(objects, 0);
+
+    std::vector<DetectedObject> none;
+    tracker.update(none, 1);
+    tracker.update(none, 2);
+    CHECK(tracker.tracks().size() == 1);
+    CHECK(tracker.tracks()[0].missed == 2);
+
+    // back within max_missed frames, it is the same object
+    objects = {object(0.1f, 0.1f, 0.2f)};
+    tracker.update(objects, 3);
+    CHECK(objects[0].track_id == 1);
+
+    for (int i = 0; i < 3; i++)
+        tracker.update(none, 4 + i);
+    CHECK(tracker.tracks().empty());
+
+    objects = {object(0.1f, 0.1f, 0.2f)};
+    tracker.update(objects, 10);
+    CHECK(objects[0].track_id == 2);
+}
+
+static void extrapolation_follows_the_velocity() {
+    Tracker tracker;
+    tracker.velocity_smoothing = 1.f;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f), object(0.6f, 0.6f, 0.2f)};
+    tracker.update(objects, 0);
+
+    // the first moves right at 1 unit per second, the second is not seen
+    objects = {object(0.2f, 0.1f, 0.2f)};
+    tracker.update(objects, SECOND / 10);
+
+    std::vector<DetectedObject> extrapolated;
+    tracker.extrapolate(SECOND / 10 + SECOND / 20, SECOND, extrapolated);
+    CHECK(extrapolated.size() == 1);
+    CHECK(extrapolated[0].track_id == 1);
+    CHECK_NEAR(extrapolated[0].rect.x, 0.25, 1e-4);
+    CHECK_NEAR(extrapolated[0].rect.width, 0.2, 1e-6);
+
+    // capped at the horizon
+    extrapolated.clear();
+    tracker.extrapolate(SECOND * 10, SECOND / 10, extrapolated);
+    CHECK_NEAR(extrapolated[0].rect.x, 0.3, 1e-4);
+
+    // never moved back in time
+    extrapolated.clear();
+    tracker.extrapolate(0, SECOND, extrapolated);
+    CHECK_NEAR(extrapolated[0].rect.x, 0.2, 1e-6);
+}
+
+static void relabel_replaces_only_lost_tracks() {
+    Tracker tracker;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f), object(0.6f, 0.6f, 0.2f)};
+    tracker.update(objects, 0);
+
+    // both seen in the last frame, they are different objects
+    CHECK(!tracker.relabel(2, 1));
+    CHECK(!tracker.relabel(7, 1));
+
+    objects = {object(0.6f, 0.6f, 0.2f)};
+    tracker.update(objects, 1);
+    CHECK(tracker.relabel(2, 1));
+    CHECK(tracker.tracks().size() == 1);
+    CHECK(tracker.tracks()[0].id == 1);
+    CHECK_NEAR(tracker.tracks()[0].rect.x, 0.6, 1e-6);
+}
+
+static void shed_keeps_the_live_tracks() {
+    Tracker tracker;
+    std::vector<DetectedObject> objects = {object(0.1f, 0.1f, 0.2f), object(0.6f, 0.6f, 0.2f)};
+    tracker.update(objects, 0);
+
+    objects = {object(0.6f, 0.6f, 0.2f)};
+    tracker.update(objects, 1);
+    tracker.shed();
+    CHECK(tracker.tracks().size() == 1);
+    CHECK(tracker.tracks()[0].id == 2);
+}
+
+void test_tracker() {
+    new_objects_get_distinct_ids();
+    overlapping_object_keeps_its_id();
+    other_class_starts_a_new_track();
+    best_overlap_wins_the_track();
+    lost_tracks_are_dropped();
+    extrapolation_follows_the_velocity();
+    relabel_replaces_only_lost_tracks();
+    shed_keeps_the_live_tracks();
+}
@@ -0,0 +1,134 @@
+#include "test.h"
+#include "zoom_controller.h"
+
+static const Box FULL(0.f, 0.f, 1.f, 1.f);
+
+static Track track(float x, float y, float size, int hits = 5, int missed = 0) {
+    Track t{};
+    t.rect = Box(x, y, size, size);
+    t.hits = hits;
+    t.missed = missed;
+    return t;
+}
+
+static ZoomController controller() {
+    ZoomController zoom;
+    zoom.enabled = true;
+    zoom.refresh_interval = 0;
+    return zoom;
+}
+
+static bool inside(const Box &r, const Box &bounds) {
+    const float eps = 1e-6f;
+    return r.x >= bounds.x - eps && r.y >= bounds.y - eps &&
+           r.x + r.width <= bounds.x + bounds.width + eps && r.y + r.height <= bounds.y + bounds.height + eps;
+}
+
+static void disabled_uses_the_viewport() {
+    ZoomController zoom;
+    TrackList tracks;
+    tracks.push_back(track(0.4f, 0.4f, 0.1f));
+    CHECK(zoom.next_crop(tracks, FULL) == FULL);
+}
+
+static void only_confirmed_visible_tracks_are_targets() {
+    ZoomController zoom = controller();
+    TrackList tracks;
+    tracks.push_back(track(0.1f, 0.1f, 0.1f, 1));
+    tracks.push_back(track(0.7f, 0.7f, 0.1f, 5, 1));
+    CHECK(zoom.next_crop(tracks, FULL) == FULL);
+
+    // 0.1 wide plus half of it on each side is under the smallest crop, centered on the track
+    tracks.push_back(track(0.4f, 0.4f, 0.1f));
+    Box crop = zoom.next_crop(tracks, FULL);
+    CHECK_NEAR(crop.width, 0.25f, 1e-6);
+    CHECK_NEAR(crop.height, 0.25f, 1e-6);
+    CHECK_NEAR(crop.x, 0.325f, 1e-6);
+    CHECK_NEAR(crop.y, 0.325f, 1e-6);
+
+    // two targets, the crop covers their union with the margin
+    ZoomController both = controller();
+    tracks.push_back(track(0.5f, 0.4f, 0.1f));
+    crop = both.next_crop(tracks, FULL);
+    CHECK_NEAR(crop.width, 0.4f, 1e-6);
+    CHECK_NEAR(crop.x, 0.3f, 1e-6);
+    CHECK_NEAR(crop.y, 0.25f, 1e-6);
+}
+
+static void crop_is_clamped_to_the_viewport() {
+    // larger than the viewport with the margin
+    ZoomController zoom = controller();
+    TrackList tracks;
+    tracks.push_back(track(0.2f, 0.2f, 0.6f));
+    CHECK(zoom.next_crop(tracks, FULL) == FULL);
+
+    // pushed inside at a corner
+    zoom.reset();
+    tracks.clear();
+    tracks.push_back(track(0.f, 0.9f, 0.1f));
+    Box crop = zoom.next_crop(tracks, FULL);
+    CHECK_NEAR(crop.x, 0.f, 1e-6);
+    CHECK_NEAR(crop.y, 0.75f, 1e-6);
+
+    // a letterboxed viewport keeps its aspect ratio and contains the crop
+    const Box viewport(0.f, 0.125f, 1.f, 0.75f);
+    zoom.reset();
+    tracks.clear();
+    tracks.push_back(track(0.45f, 0.05f, 0.1f));
+    crop = zoom.next_crop(tracks, viewport);
+    CHECK(inside(crop, viewport));
+    CHECK_NEAR(crop.width / crop.height, viewport.width / viewport.height, 1e-5);
+    // the margin fits the shorter side
+    CHECK_NEAR(crop.height, 0.2f, 1e-6);
+    CHECK_NEAR(crop.y, 0.125f, 1e-6);
+}
+
+static void crop_is_smoothed() {
+    ZoomController zoom = controller();
+    TrackList tracks;
+    tracks.push_back(track(0.4f, 0.4f, 0.1f));
+
+    // the first crop jumps to the target, a still target keeps it in place
+    CHECK_NEAR(zoom.next_crop(tracks, FULL).x, 0.325f, 1e-6);
+    CHECK_NEAR(zoom.next_crop(tracks, FULL).x, 0.325f, 1e-6);
+
+    // a target moved by 0.1 moves the crop by the smoothing weight of it each frame
+    tracks[0].rect.x = 0.5f;
+    CHECK_NEAR(zoom.next_crop(tracks, FULL).x, 0.355f, 1e-6);
+    CHECK_NEAR(zoom.next_crop(tracks, FULL).x, 0.376f, 1e-6);
+    for (int i = 0; i < 50; i++)
+        zoom.next_crop(tracks, FULL);
+    CHECK_NEAR(zoom.next_crop(tracks, FULL).x, 0.425f, 1e-5);
+
+    // so does the size
+    tracks[0].rect.width = tracks[0].rect.height = 0.2f;
+    Box crop = zoom.next_crop(tracks, FULL);
+    CHECK(crop.width > 0.25f && crop.width < 0.4f);
+    CHECK(inside(crop, FULL));
+
+    // losing every target starts over
+    TrackList none;
+    CHECK(zoom.next_crop(none, FULL) == FULL);
+    tracks[0].rect = Box(0.4f, 0.4f, 0.1f, 0.1f);
+    CHECK_NEAR(zoom.next_crop(tracks, FULL).x, 0.325f, 1e-6);
+}
+
+static void refresh_shows_the_viewport_without_losing_the_crop() {
+    ZoomController zoom = controller();
+    zoom.refresh_interval = 3;
+    TrackList tracks;
+    tracks.push_back(track(0.4f, 0.4f, 0.1f));
+
+    CHECK(zoom.next_crop(tracks, FULL) != FULL);
+    CHECK(zoom.next_crop(tracks, FULL) != FULL);
+    CHECK(zoom.next_crop(tracks, FULL) == FULL);
+    CHECK_NEAR(zoom.next_crop(tracks, FULL).x, 0.325f, 1e-6);
+}
+
+void test_zoom_controller() {
+    disabled_uses_the_viewport();
+    only_confirmed_visible_tracks_are_targets();
+    crop_is_clamped_to_the_viewport();
+    crop_is_smoothed();
+    refresh_shows_the_viewport_without_losing_the_crop();
+}
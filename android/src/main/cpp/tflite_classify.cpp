@@ -0,0 +1,107 @@
+#include <jni.h>
+#include "jni_frame.h"
+#include "predictor.h"
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_classify_TfliteClassifier_nativeCreate(JNIEnv *env,
+                                                                                      jobject thiz,
+                                                                                      jint input_size,
+                                                                                      jint num_classes) {
+    return (jlong) new Classifier(input_size, num_classes);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_classify_TfliteClassifier_nativeRelease(JNIEnv *env,
+                                                                                       jobject thiz,
+                                                                                       jlong handle) {
+    delete (Classifier *) handle;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_classify_TfliteClassifier_nativePreprocessFrame(JNIEnv *env,
+                                                                                               jobject thiz,
+                                                                                               jlong handle,
+                                                                                               jobject y_buffer,
+                                                                                               jobject u_buffer,
+                                                                                               jobject v_buffer,
+                                                                                               jint y_row_stride,
+                                                                                               jint uv_row_stride,
+                                                                                               jint uv_pixel_stride,
+                                                                                               jint width,
+                                                                                               jint height,
+                                                                                               jint rotation,
+                                                                                               jobject input) {
+    Classifier *classifier = (Classifier *) handle;
+    if (classifier == nullptr)
+        return JNI_FALSE;
+
+    Frame frame;
+    float *dst = (float *) env->GetDirectBufferAddress(input);
+    if (dst == NULL || env->GetDirectBufferCapacity(input) < (jlong) (classifier->input_length() * sizeof(float)) ||
+        !frame_from_planes(env, y_buffer, u_buffer, v_buffer, y_row_stride, uv_row_stride, uv_pixel_stride,
+                           width, height, rotation, 0, frame))
+        return JNI_FALSE;
+
+    // the whole frame, stretched to the square input
+    classifier->preprocess(frame, Box(0.f, 0.f, 1.f, 1.f), dst);
+    return JNI_TRUE;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_classify_TfliteClassifier_nativePreprocessBitmap(JNIEnv *env,
+                                                                                                jobject thiz,
+                                                                                                jlong handle,
+                                                                                                jintArray pixels,
+                                                                                                jobject input) {
+    Classifier *classifier = (Classifier *) handle;
+    if (classifier == nullptr)
+        return JNI_FALSE;
+
+    float *dst = (float *) env->GetDirectBufferAddress(input);
+    if (dst == NULL || env->GetDirectBufferCapacity(input) < (jlong) (classifier->input_length() * sizeof(float)) ||
+        env->GetArrayLength(pixels) < classifier->input_size() * classifier->input_size())
+        return JNI_FALSE;
+
+    jint *argb = env->GetIntArrayElements(pixels, NULL);
+    if (argb == NULL)
+        return JNI_FALSE;
+    classifier->preprocess((const uint32_t *) argb, dst);
+    env->ReleaseIntArrayElements(pixels, argb, JNI_ABORT);
+    return JNI_TRUE;
+}
+
+extern "C"
+JNIEXPORT jfloatArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_classify_TfliteClassifier_nativeClassify(JNIEnv *env,
+                                                                                        jobject thiz,
+                                                                                        jlong handle,
+                                                                                        jobject output,
+                                                                                        jint top_k) {
+    Classifier *classifier = (Classifier *) handle;
+    if (classifier == nullptr)
+        return NULL;
+
+    //return [top_k * 2(class, confidence)], most confident first
+    std::vector<Classification> classes;
+    const float *probabilities = (const float *) env->GetDirectBufferAddress(output);
+    if (probabilities != NULL &&
+        env->GetDirectBufferCapacity(output) >= (jlong) (classifier->output_length() * sizeof(float)))
+        classifier->top_k(probabilities, top_k, classes);
+
+    std::vector<float> packed;
+    packed.reserve(classes.size() * 2);
+    for (const Classification &c: classes) {
+        packed.push_back((float) c.index);
+        packed.push_back(c.confidence);
+    }
+
+    jfloatArray result = env->NewFloatArray((jsize) packed.size());
+    if (result == NULL)
+        return NULL;
+    env->SetFloatArrayRegion(result, 0, packed.size(), packed.data());
+    return result;
+}
@@ -1,198 +1,876 @@
 #include <jni.h>
+#include "jni_frame.h"
+#include "memory_budget.h"
+#include "pipeline.h"
+#include "postprocess.h"
+#include "predictor.h"
+#include "preprocess.h"
 #include "ultralytics.h"
 
-static void qsort_descent_inplace(std::vector<DetectedObject> &objects, int left, int right) {
-    int i = left;
-    int j = right;
-    float p = objects[(left + right) / 2].confidence;
+static jobjectArray pack_objects(JNIEnv *env, const std::vector<DetectedObject> &objects) {
+    //return 2-dimension array [detected_box][7(x, y, width, height, conf, class, track id)]
+    jobjectArray objArray;
+    jclass floatArray = env->FindClass("[F");
+    if (floatArray == NULL)
+        return NULL;
+    int size = objects.size();
+    objArray = env->NewObjectArray(size, floatArray, NULL);
+    if (objArray == NULL)
+        return NULL;
+    for (int i = 0; i < objects.size(); i++) {
+        int index = objects[i].index;
+        float x = objects[i].rect.x;
+        float y = objects[i].rect.y;
+        float width = objects[i].rect.width;
+        float height = objects[i].rect.height;
+        float confidence = objects[i].confidence;
+        float track_id = objects[i].track_id;
 
-    while (i <= j) {
-        while (objects[i].confidence > p)
-            i++;
+        float boxres[7] = {x, y, width, height, confidence, (float) index, track_id};
+        jfloatArray iarr = env->NewFloatArray((jsize) 7);
+        if (iarr == NULL)
+            return NULL;
+        env->SetFloatArrayRegion(iarr, 0, 7, boxres);
+        env->SetObjectArrayElement(objArray, i, iarr);
+        env->DeleteLocalRef(iarr);
+    }
+    return objArray;
+}
 
-        while (objects[j].confidence < p)
-            j--;
+// Over the global budget, the pipeline sheds until it is under it: caches first, then capacity
+// that only costs history or evidence, then buffers the next frame has to allocate again.
+static void shed_memory(Pipeline &pipeline) {
+    if (memory_over_budget())
+        pipeline.reid.shed();
+    if (memory_over_budget())
+        pipeline.frames.shed();
+    if (memory_over_budget())
+        pipeline.history.shed();
+    if (memory_over_budget())
+        pipeline.tracker.shed();
+    if (memory_over_budget())
+        pipeline.smoother.shed();
+    if (memory_over_budget() && pipeline.postprocessor != nullptr)
+        pipeline.postprocessor->shed();
+}
 
-        if (i <= j) {
-            // swap
-            std::swap(objects[i], objects[j]);
+// Handles are 0 once TfliteDetector.release() has run, the entry points then do nothing.
 
-            i++;
-            j--;
-        }
-    }
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_postprocess(JNIEnv *env,
+                                                                                 jobject thiz,
+                                                                                 jlong handle,
+                                                                                 jobject recognitions,
+                                                                                 jfloat crop_x, jfloat crop_y,
+                                                                                 jfloat crop_w, jfloat crop_h,
+                                                                                 jlong timestamp,
+                                                                                 jboolean track) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return pack_objects(env, std::vector<DetectedObject>());
+
+    const Box crop(crop_x, crop_y, crop_w, crop_h);
+
+    // reused between frames of the same thread
+    static thread_local Detections proposals;
+    std::vector<DetectedObject> objects;
 
-    //     #pragma omp parallel sections
+    std::shared_ptr<const Detector> detector;
+    std::shared_ptr<CustomPostprocessor> postprocessor;
     {
-        //         #pragma omp section
-        {
-            if (left < j) qsort_descent_inplace(objects, left, j);
-        }
-        //         #pragma omp section
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        detector = pipeline->detector;
+        postprocessor = pipeline->postprocessor;
+    }
+    if (detector == nullptr)
+        return pack_objects(env, objects);
+
+    // the [4 + num_classes][num_anchors] output in one block, as written by the interpreter
+    const float *output = (const float *) env->GetDirectBufferAddress(recognitions);
+    if (output == nullptr ||
+        env->GetDirectBufferCapacity(recognitions) < (jlong) (detector->output_length() * sizeof(float)))
+        return pack_objects(env, objects);
+
+    // one consistent set of settings for the whole frame, however they change meanwhile
+    AtomicConfig<PostprocessConfig>::Snapshot config = pipeline->config.read();
+
+    // find boxes with score > threshold and class > threshold, then map from the cropped model
+    // input back to the full frame. A custom postprocessor is third-party code and runs without
+    // the lock, on the reference taken above.
+    if (postprocessor != nullptr) {
+        postprocessor->process(output, *config, detector->input_size(), objects);
+        map_to_frame(crop, objects);
+    } else {
+        // the mask is immutable once published, decoding does not need the lock
+        std::shared_ptr<const std::vector<uint64_t>> mask;
         {
-            if (i < right) qsort_descent_inplace(objects, i, right);
+            std::lock_guard<std::mutex> guard(pipeline->lock);
+            mask = pipeline->roi_mask.bits(detector->num_anchors(), detector->input_size(),
+                                           detector->input_size(), crop);
         }
+        proposals.clear();
+        detector->decode(output, config->confidence_threshold, mask.get(), proposals);
+        detector->select(proposals, *config, crop, objects);
     }
+
+    // assign track ids and evaluate the rules on the live stream only
+    if (track) {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        pipeline->tracker.update(objects, timestamp);
+        pipeline->history.update(pipeline->tracker.tracks(), timestamp);
+        pipeline->rule_engine.evaluate(pipeline->tracker.tracks(), timestamp, pipeline->events);
+        pipeline->heatmap.accumulate(objects, timestamp);
+        pipeline->frames.add_detections(timestamp, objects);
+        pipeline->log.append(pipeline->frame_id, timestamp, objects);
+
+        // only the reported boxes are smoothed, tracks and the log keep the measurements
+        pipeline->smoother.smooth(objects, timestamp);
+
+        // the raw output becomes visible to Dart once the frame is done with it
+        pipeline->outputs.publish(output, pipeline->frame_id++, timestamp);
+
+        shed_memory(*pipeline);
+    }
+
+    return pack_objects(env, objects);
 }
 
-static void qsort_descent_inplace(std::vector<DetectedObject> &objects) {
-    if (objects.empty())
-        return;
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativePreprocessFrame(JNIEnv *env,
+                                                                                           jobject thiz,
+                                                                                           jlong handle,
+                                                                                           jobject y_buffer,
+                                                                                           jobject u_buffer,
+                                                                                           jobject v_buffer,
+                                                                                           jint y_row_stride,
+                                                                                           jint uv_row_stride,
+                                                                                           jint uv_pixel_stride,
+                                                                                           jint width,
+                                                                                           jint height,
+                                                                                           jint rotation,
+                                                                                           jfloat crop_x, jfloat crop_y,
+                                                                                           jfloat crop_w, jfloat crop_h,
+                                                                                           jobject input) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return JNI_FALSE;
+
+    std::shared_ptr<const Detector> detector;
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        detector = pipeline->detector;
+    }
+
+    Frame frame;
+    float *dst = (float *) env->GetDirectBufferAddress(input);
+    if (detector == nullptr || dst == NULL ||
+        env->GetDirectBufferCapacity(input) < (jlong) (detector->input_length() * sizeof(float)) ||
+        !frame_from_planes(env, y_buffer, u_buffer, v_buffer, y_row_stride, uv_row_stride, uv_pixel_stride,
+                           width, height, rotation, 0, frame))
+        return JNI_FALSE;
 
-    qsort_descent_inplace(objects, 0, objects.size() - 1);
+    detector->preprocess(frame, Box(crop_x, crop_y, crop_w, crop_h), dst);
+    return JNI_TRUE;
 }
 
-static float intersection_area(const DetectedObject &a, const DetectedObject &b) {
-    cv::Rect_<float> inter = a.rect & b.rect;
-    return inter.area();
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativePreprocessBitmap(JNIEnv *env,
+                                                                                            jobject thiz,
+                                                                                            jlong handle,
+                                                                                            jintArray pixels,
+                                                                                            jobject input) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return JNI_FALSE;
+
+    std::shared_ptr<const Detector> detector;
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        detector = pipeline->detector;
+    }
+
+    float *dst = (float *) env->GetDirectBufferAddress(input);
+    if (detector == nullptr || dst == NULL ||
+        env->GetDirectBufferCapacity(input) < (jlong) (detector->input_length() * sizeof(float)) ||
+        env->GetArrayLength(pixels) < detector->input_size() * detector->input_size())
+        return JNI_FALSE;
+
+    jint *argb = env->GetIntArrayElements(pixels, NULL);
+    if (argb == NULL)
+        return JNI_FALSE;
+    detector->preprocess((const uint32_t *) argb, dst);
+    env->ReleaseIntArrayElements(pixels, argb, JNI_ABORT);
+    return JNI_TRUE;
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeCreate(JNIEnv *env,
+                                                                                  jobject thiz) {
+    return (jlong) new Pipeline();
 }
 
-static void nms_sorted_bboxes(const std::vector<DetectedObject> &objects, std::vector<int> &picked,
-                              float nms_threshold) {
-    picked.clear();
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeRelease(JNIEnv *env,
+                                                                                   jobject thiz,
+                                                                                   jlong handle) {
+    delete (Pipeline *) handle;
+}
 
-    const int n = objects.size();
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetRules(JNIEnv *env,
+                                                                                    jobject thiz,
+                                                                                    jlong handle,
+                                                                                    jobjectArray rules) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
 
-    std::vector<float> areas(n);
+    // each row is [id, type, class index, dwell ms, x0, y0, x1, y1, ...]
+    std::vector<Rule> parsed;
+    const int n = rules == NULL ? 0 : env->GetArrayLength(rules);
     for (int i = 0; i < n; i++) {
-        areas[i] = objects[i].rect.width * objects[i].rect.height;
-    }
+        jfloatArray row = (jfloatArray) env->GetObjectArrayElement(rules, i);
+        const int len = env->GetArrayLength(row);
+        jfloat *rowData = env->GetFloatArrayElements(row, JNI_FALSE);
 
-    for (int i = 0; i < n; i++) {
-        const DetectedObject &a = objects[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int) picked.size(); j++) {
-            const DetectedObject &b = objects[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
+        if (len >= 4) {
+            Rule rule;
+            rule.id = (int) rowData[0];
+            rule.type = (int) rowData[1];
+            rule.class_index = (int) rowData[2];
+            rule.dwell_ns = (int64_t) rowData[3] * 1000000;
+            for (int j = 4; j + 1 < len; j += 2) {
+                rule.points.emplace_back(rowData[j], rowData[j + 1]);
+            }
+            parsed.push_back(rule);
         }
 
-        if (keep)
-            picked.push_back(i);
+        env->ReleaseFloatArrayElements(row, rowData, JNI_ABORT);
+        env->DeleteLocalRef(row);
     }
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->rule_engine.set_rules(parsed);
+    pipeline->events.clear();
 }
 
 extern "C"
 JNIEXPORT jobjectArray JNICALL
-Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_postprocess(JNIEnv *env,
-                                                                                 jobject thiz,
-                                                                                 jobjectArray recognitions,
-                                                                                 jint w, jint h,
-                                                                                 jfloat confidence_threshold,
-                                                                                 jfloat iou_threshold,
-                                                                                 jint num_items_threshold,
-                                                                                 jint num_classes) {
-    std::vector<DetectedObject> proposals;
-    std::vector<DetectedObject> objects;
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeDrainRuleEvents(JNIEnv *env,
+                                                                                           jobject thiz,
+                                                                                           jlong handle) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return NULL;
 
-    // Initialize the C++ vector
-    std::vector<std::vector<float>> vec(h, std::vector<float>(w, 0.0f));
-    for (int i = 0; i < h; ++i) {
-        jfloatArray row = (jfloatArray) env->GetObjectArrayElement(recognitions, i);
+    std::vector<RuleEvent> events;
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        events.swap(pipeline->events);
+    }
+
+    //return 2-dimension array [event][7(rule id, type, track id, class, timestamp ms, x, y)]
+    jclass doubleArray = env->FindClass("[D");
+    if (doubleArray == NULL)
+        return NULL;
+    jobjectArray objArray = env->NewObjectArray(events.size(), doubleArray, NULL);
+    if (objArray == NULL)
+        return NULL;
+    for (int i = 0; i < (int) events.size(); i++) {
+        const RuleEvent &e = events[i];
+        double eventres[7] = {(double) e.rule_id, (double) e.type, (double) e.track_id, (double) e.index,
+                              e.timestamp / 1e6, e.x, e.y};
+        jdoubleArray iarr = env->NewDoubleArray((jsize) 7);
+        if (iarr == NULL)
+            return NULL;
+        env->SetDoubleArrayRegion(iarr, 0, 7, eventres);
+        env->SetObjectArrayElement(objArray, i, iarr);
+        env->DeleteLocalRef(iarr);
+    }
+    return objArray;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetRegionsOfInterest(JNIEnv *env,
+                                                                                                jobject thiz,
+                                                                                                jlong handle,
+                                                                                                jobjectArray regions) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    // each row is a polygon [x0, y0, x1, y1, ...]
+    std::vector<std::vector<Point2f>> polygons;
+    const int n = regions == NULL ? 0 : env->GetArrayLength(regions);
+    for (int i = 0; i < n; i++) {
+        jfloatArray row = (jfloatArray) env->GetObjectArrayElement(regions, i);
+        const int len = env->GetArrayLength(row);
         jfloat *rowData = env->GetFloatArrayElements(row, JNI_FALSE);
 
-        for (int j = 0; j < w; ++j) {
-            vec[i][j] = rowData[j];
+        std::vector<Point2f> polygon;
+        for (int j = 0; j + 1 < len; j += 2) {
+            polygon.emplace_back(rowData[j], rowData[j + 1]);
         }
+        polygons.push_back(polygon);
 
-        // Release the local references
         env->ReleaseFloatArrayElements(row, rowData, JNI_ABORT);
         env->DeleteLocalRef(row);
     }
 
-    // find boxes with score > threshold and class > threshold
-    for (int i = 0; i < w; ++i) {
-        // find class index with max class score
-        int class_index = 0;
-        float class_score = -FLT_MAX;
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->roi_mask.set_polygons(polygons);
+}
 
-        // get scores for all class indexes of current box
-        std::vector<float> classes(num_classes);
-        for (int c = 0; c < num_classes; c++) {
-            classes[c] = vec[c + 4][i];
-        }
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetAutoCrop(JNIEnv *env,
+                                                                                       jobject thiz,
+                                                                                       jlong handle,
+                                                                                       jboolean enabled,
+                                                                                       jfloat min_scale,
+                                                                                       jint refresh_interval) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->zoom_controller.enabled = enabled;
+    pipeline->zoom_controller.min_scale = std::min(1.f, std::max(0.05f, min_scale));
+    pipeline->zoom_controller.refresh_interval = refresh_interval;
+    pipeline->zoom_controller.reset();
+}
+
+extern "C"
+JNIEXPORT jfloatArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeNextCrop(JNIEnv *env,
+                                                                                    jobject thiz,
+                                                                                    jlong handle,
+                                                                                    jfloat viewport_x,
+                                                                                    jfloat viewport_y,
+                                                                                    jfloat viewport_w,
+                                                                                    jfloat viewport_h) {
+    Pipeline *pipeline = (Pipeline *) handle;
+
+    Box crop(viewport_x, viewport_y, viewport_w, viewport_h);
+    if (pipeline != nullptr) {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        crop = pipeline->zoom_controller.next_crop(pipeline->tracker.tracks(), crop);
+    }
 
-        // find class index with max class score
-        for (int c = 0; c < num_classes; ++c) {
-            if (classes[c] > class_score) {
-                class_index = c;
-                class_score = classes[c];
+    //return [x, y, width, height]
+    float cropres[4] = {crop.x, crop.y, crop.width, crop.height};
+    jfloatArray iarr = env->NewFloatArray((jsize) 4);
+    if (iarr == NULL)
+        return NULL;
+    env->SetFloatArrayRegion(iarr, 0, 4, cropres);
+    return iarr;
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeExtrapolate(JNIEnv *env,
+                                                                                       jobject thiz,
+                                                                                       jlong handle,
+                                                                                       jlong timestamp,
+                                                                                       jlong max_horizon) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return pack_objects(env, std::vector<DetectedObject>());
+
+    std::vector<DetectedObject> objects;
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        pipeline->tracker.extrapolate(timestamp, max_horizon, objects);
+    }
+    return pack_objects(env, objects);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetReid(JNIEnv *env,
+                                                                                   jobject thiz,
+                                                                                   jlong handle,
+                                                                                   jint dim,
+                                                                                   jint capacity,
+                                                                                   jfloat threshold) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->reid.configure(dim, capacity, threshold);
+}
+
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeExtractReidCrops(JNIEnv *env,
+                                                                                            jobject thiz,
+                                                                                            jlong handle,
+                                                                                            jobject input,
+                                                                                            jint input_size,
+                                                                                            jfloat crop_x, jfloat crop_y,
+                                                                                            jfloat crop_w, jfloat crop_h,
+                                                                                            jlong timestamp,
+                                                                                            jobject crops,
+                                                                                            jint crop_w_px,
+                                                                                            jint crop_h_px,
+                                                                                            jint max_crops) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return NULL;
+
+    // an empty crop would divide by zero below, a short input would be read past its end
+    const int crop_len = crop_w_px * crop_h_px * 3;
+    if (input_size <= 0 || crop_w_px <= 0 || crop_h_px <= 0 ||
+        env->GetDirectBufferCapacity(input) < (jlong) input_size * input_size * 3 * (jlong) sizeof(float))
+        return NULL;
+
+    const float *src = (const float *) env->GetDirectBufferAddress(input);
+    float *dst = (float *) env->GetDirectBufferAddress(crops);
+    max_crops = std::min<int>(max_crops, env->GetDirectBufferCapacity(crops) / (crop_len * sizeof(float)));
+
+    std::vector<int> track_ids;
+    std::vector<Box> rois;
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        if (src != NULL && dst != NULL && pipeline->reid.enabled())
+            pipeline->reid.select(pipeline->tracker.tracks(), timestamp, max_crops, track_ids);
+
+        for (int id: track_ids) {
+            for (const Track &track: pipeline->tracker.tracks()) {
+                if (track.id != id)
+                    continue;
+
+                // track boxes are in frame coordinates, the input holds the crop region only
+                rois.emplace_back((track.rect.x - crop_x) / crop_w, (track.rect.y - crop_y) / crop_h,
+                                  track.rect.width / crop_w, track.rect.height / crop_h);
             }
         }
+    }
 
-        // if class score is less than threshold, move to next box
-        if (class_score > confidence_threshold) {
-            float dx = vec[0][i];
-            float dy = vec[1][i];
-            float dw = vec[2][i];
-            float dh = vec[3][i];
-
-            DetectedObject obj;
-            obj.rect.x = dx;
-            obj.rect.y = dy;
-            obj.rect.width = dw;
-            obj.rect.height = dh;
-            obj.index = class_index;
-            obj.confidence = class_score;
-
-            proposals.push_back(obj);
-        }
+    for (int i = 0; i < (int) rois.size(); i++) {
+        crop_resize_rgb(src, input_size, input_size, rois[i], dst + (size_t) i * crop_len, crop_w_px, crop_h_px);
     }
 
-    // sort all proposals by score from highest to lowest
-    qsort_descent_inplace(proposals);
+    jintArray ids = env->NewIntArray((jsize) track_ids.size());
+    if (ids == NULL)
+        return NULL;
+    env->SetIntArrayRegion(ids, 0, track_ids.size(), track_ids.data());
+    return ids;
+}
 
-    // apply nms with nms_threshold
-    std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, iou_threshold);
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeAddEmbedding(JNIEnv *env,
+                                                                                        jobject thiz,
+                                                                                        jlong handle,
+                                                                                        jint track_id,
+                                                                                        jobject embedding) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return track_id;
+
+    const float *data = (const float *) env->GetDirectBufferAddress(embedding);
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    if (data == NULL || !pipeline->reid.enabled() ||
+        env->GetDirectBufferCapacity(embedding) < (jlong) (pipeline->reid.dim() * sizeof(float)))
+        return track_id;
+
+    // the embedding joins the gallery under the id the track actually ends up with
+    int id = pipeline->reid.match(track_id, data, pipeline->tracker.tracks());
+    if (id != track_id && pipeline->tracker.relabel(track_id, id)) {
+        pipeline->rule_engine.relabel(track_id, id);
+        pipeline->history.relabel(track_id, id);
+    } else {
+        id = track_id;
+    }
+    pipeline->reid.add(track_id, id, data);
+    return id;
+}
 
-    int count = (int) std::min((float) picked.size(), (float) num_items_threshold);
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetTrackHistory(JNIEnv *env,
+                                                                                           jobject thiz,
+                                                                                           jlong handle,
+                                                                                           jlong memory_budget,
+                                                                                           jint points_per_track,
+                                                                                           jfloat epsilon) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
 
-    objects.resize(count);
-    for (int i = 0; i < count; i++) {
-        objects[i] = proposals[picked[i]];
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->history.configure(memory_budget, points_per_track, epsilon);
+}
 
-        float x0 = std::max(0.f, objects[i].rect.x - objects[i].rect.width / 2);
-        float y0 = std::max(0.f, objects[i].rect.y - objects[i].rect.height / 2);
-        float x1 = std::min(1.f, objects[i].rect.x + objects[i].rect.width / 2);
-        float y1 = std::min(1.f, objects[i].rect.y + objects[i].rect.height / 2);
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetSmoothing(JNIEnv *env,
+                                                                                       jobject thiz,
+                                                                                       jlong handle,
+                                                                                       jboolean enabled,
+                                                                                       jfloat min_cutoff,
+                                                                                       jfloat beta,
+                                                                                       jfloat derivative_cutoff) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
 
-        objects[i].rect.x = x0;
-        objects[i].rect.y = y0;
-        objects[i].rect.width = (x1 - x0);
-        objects[i].rect.height = (y1 - y0);
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->smoother.enabled = enabled;
+    pipeline->smoother.min_cutoff = min_cutoff;
+    pipeline->smoother.beta = beta;
+    pipeline->smoother.derivative_cutoff = derivative_cutoff;
+    if (!enabled)
+        pipeline->smoother.reset();
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeGetTrajectory(JNIEnv *env,
+                                                                                         jobject thiz,
+                                                                                         jlong handle,
+                                                                                         jint track_id,
+                                                                                         jlong window) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return NULL;
+
+    std::vector<uint8_t> packed;
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        pipeline->history.query(track_id, window, packed);
     }
 
-    //return 2-dimension array [detected_box][6(x, y, width, height, conf, class)]
-    jobjectArray objArray;
-    jclass floatArray = env->FindClass("[F");
-    if (floatArray == NULL)
+    jbyteArray arr = env->NewByteArray((jsize) packed.size());
+    if (arr == NULL)
         return NULL;
-    int size = objects.size();
-    objArray = env->NewObjectArray(size, floatArray, NULL);
-    if (objArray == NULL)
+    env->SetByteArrayRegion(arr, 0, packed.size(), (const jbyte *) packed.data());
+    return arr;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetHeatmap(JNIEnv *env,
+                                                                                      jobject thiz,
+                                                                                      jlong handle,
+                                                                                      jint width,
+                                                                                      jint height,
+                                                                                      jlong half_life) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->heatmap.configure(width, height, half_life);
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeHeatmapSnapshot(JNIEnv *env,
+                                                                                           jobject thiz,
+                                                                                           jlong handle,
+                                                                                           jlong timestamp,
+                                                                                           jfloatArray peak) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
         return NULL;
-    for (int i = 0; i < objects.size(); i++) {
-        int index = objects[i].index;
-        float x = objects[i].rect.x;
-        float y = objects[i].rect.y;
-        float width = objects[i].rect.width;
-        float height = objects[i].rect.height;
-        float confidence = objects[i].confidence;
 
-        float boxres[6] = {x, y, width, height, confidence, (float) index};
-        jfloatArray iarr = env->NewFloatArray((jsize) 6);
-        if (iarr == NULL)
-            return NULL;
-        env->SetFloatArrayRegion(iarr, 0, 6, boxres);
-        env->SetObjectArrayElement(objArray, i, iarr);
-        env->DeleteLocalRef(iarr);
+    std::vector<uint8_t> cells;
+    float hottest;
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        hottest = pipeline->heatmap.snapshot(timestamp, cells);
     }
-    return objArray;
-}
\ No newline at end of file
+    env->SetFloatArrayRegion(peak, 0, 1, &hottest);
+
+    jbyteArray arr = env->NewByteArray((jsize) cells.size());
+    if (arr == NULL)
+        return NULL;
+    env->SetByteArrayRegion(arr, 0, cells.size(), (const jbyte *) cells.data());
+    return arr;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetFrameBuffer(JNIEnv *env,
+                                                                                          jobject thiz,
+                                                                                          jlong handle,
+                                                                                          jlong memory_budget,
+                                                                                          jint max_side,
+                                                                                          jint quality) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->frames.configure(memory_budget, max_side, quality);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativePushFrame(JNIEnv *env,
+                                                                                     jobject thiz,
+                                                                                     jlong handle,
+                                                                                     jobject y_buffer,
+                                                                                     jobject u_buffer,
+                                                                                     jobject v_buffer,
+                                                                                     jint y_row_stride,
+                                                                                     jint uv_row_stride,
+                                                                                     jint uv_pixel_stride,
+                                                                                     jint width,
+                                                                                     jint height,
+                                                                                     jint rotation,
+                                                                                     jlong timestamp) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    // the live camera source
+    Frame frame;
+    if (!frame_from_planes(env, y_buffer, u_buffer, v_buffer, y_row_stride, uv_row_stride, uv_pixel_stride,
+                           width, height, rotation, timestamp, frame))
+        return;
+
+    // the frame buffer and recorder copy the frame outside their own locks and stay safe against
+    // reconfiguration, the pipeline lock is not needed
+    pipeline->frames.push(frame);
+    pipeline->recorder.record(frame);
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeDumpFrames(JNIEnv *env,
+                                                                                      jobject thiz,
+                                                                                      jlong handle,
+                                                                                      jlong from,
+                                                                                      jlong to,
+                                                                                      jstring directory) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return 0;
+
+    const char *chars = env->GetStringUTFChars(directory, NULL);
+    std::string path(chars);
+    env->ReleaseStringUTFChars(directory, chars);
+
+    return pipeline->frames.dump(from, to, path);
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetDetectionLog(JNIEnv *env,
+                                                                                           jobject thiz,
+                                                                                           jlong handle,
+                                                                                           jstring directory,
+                                                                                           jint records_per_segment,
+                                                                                           jint max_segments) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return JNI_FALSE;
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    if (directory == NULL) {
+        pipeline->log.close();
+        return JNI_TRUE;
+    }
+
+    const char *chars = env->GetStringUTFChars(directory, NULL);
+    std::string path(chars);
+    env->ReleaseStringUTFChars(directory, chars);
+
+    return pipeline->log.open(path, records_per_segment, max_segments) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetRecording(JNIEnv *env,
+                                                                                        jobject thiz,
+                                                                                        jlong handle,
+                                                                                        jstring path) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return JNI_FALSE;
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    if (path == NULL) {
+        pipeline->recorder.close();
+        return JNI_TRUE;
+    }
+
+    const char *chars = env->GetStringUTFChars(path, NULL);
+    std::string file(chars);
+    env->ReleaseStringUTFChars(path, chars);
+
+    return pipeline->recorder.open(file) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetModel(JNIEnv *env,
+                                                                                    jobject thiz,
+                                                                                    jlong handle,
+                                                                                    jint input_size,
+                                                                                    jint num_classes,
+                                                                                    jint num_anchors) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    // picks the output decoder specialized for the class count, if there is one
+    std::shared_ptr<const Detector> detector = std::make_shared<Detector>(input_size, num_classes, num_anchors);
+
+    std::lock_guard<std::mutex> guard(pipeline->lock);
+    pipeline->detector = detector;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetPostprocessConfig(JNIEnv *env,
+                                                                                                jobject thiz,
+                                                                                                jlong handle,
+                                                                                                jfloat confidence_threshold,
+                                                                                                jfloat iou_threshold,
+                                                                                                jint max_detections,
+                                                                                                jint nms_mode,
+                                                                                                jint max_proposals,
+                                                                                                jintArray classes) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return;
+
+    std::vector<uint8_t> class_filter;
+    const int n = classes == NULL ? 0 : env->GetArrayLength(classes);
+    if (n > 0) {
+        std::vector<jint> indices(n);
+        env->GetIntArrayRegion(classes, 0, n, indices.data());
+        for (jint index: indices) {
+            if (index < 0)
+                continue;
+            if (index >= (int) class_filter.size())
+                class_filter.resize(index + 1, 0);
+            class_filter[index] = 1;
+        }
+    }
+
+    pipeline->config.update([&](PostprocessConfig &config) {
+        config.confidence_threshold = confidence_threshold;
+        config.iou_threshold = iou_threshold;
+        config.max_detections = max_detections;
+        config.nms_mode = nms_mode == NMS_PER_CLASS ? NMS_PER_CLASS : NMS_AGNOSTIC;
+        config.max_proposals = max_proposals;
+        config.classes = std::move(class_filter);
+    });
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetPostprocessor(JNIEnv *env,
+                                                                                            jobject thiz,
+                                                                                            jlong handle,
+                                                                                            jstring name,
+                                                                                            jstring library,
+                                                                                            jint rows,
+                                                                                            jint cols) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return JNI_FALSE;
+
+    std::string name_string;
+    std::string library_string;
+    if (name != NULL) {
+        const char *chars = env->GetStringUTFChars(name, NULL);
+        name_string = chars;
+        env->ReleaseStringUTFChars(name, chars);
+    }
+    if (library != NULL) {
+        const char *chars = env->GetStringUTFChars(library, NULL);
+        library_string = chars;
+        env->ReleaseStringUTFChars(library, chars);
+    }
+
+    // plugin code runs outside the lock: the new one is created before the swap, and the previous
+    // one is destroyed by whoever drops the last reference, this call or a frame still using it
+    std::shared_ptr<CustomPostprocessor> postprocessor;
+    if (!name_string.empty())
+        postprocessor = CustomPostprocessor::create(name_string, library_string, rows, cols);
+    const bool selected = postprocessor != nullptr || name_string.empty();
+    {
+        std::lock_guard<std::mutex> guard(pipeline->lock);
+        pipeline->postprocessor.swap(postprocessor);
+    }
+    return selected ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetRawOutput(JNIEnv *env,
+                                                                                        jobject thiz,
+                                                                                        jlong handle,
+                                                                                        jint rows,
+                                                                                        jint cols) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return 0;
+    return pipeline->outputs.configure(rows, cols);
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeRawOutputSlot(JNIEnv *env,
+                                                                                         jobject thiz,
+                                                                                         jlong handle,
+                                                                                         jint slot) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return NULL;
+    float *data = pipeline->outputs.slot_data(slot);
+    if (data == nullptr)
+        return NULL;
+    return env->NewDirectByteBuffer(data, (jlong) (pipeline->outputs.slot_size() * sizeof(float)));
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeBeginOutput(JNIEnv *env,
+                                                                                       jobject thiz,
+                                                                                       jlong handle) {
+    Pipeline *pipeline = (Pipeline *) handle;
+    if (pipeline == nullptr)
+        return -1;
+    return pipeline->outputs.begin_write();
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeSetMemoryBudget(JNIEnv *env,
+                                                                                           jclass clazz,
+                                                                                           jlong bytes) {
+    set_memory_budget(bytes > 0 ? (size_t) bytes : 0);
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_com_ultralytics_ultralytics_1yolo_predict_detect_TfliteDetector_nativeMemoryStats(JNIEnv *env,
+                                                                                       jclass clazz) {
+    // bytes of each subsystem in MemorySubsystem order, then the budget
+    jlong stats[MEMORY_SUBSYSTEM_COUNT + 1];
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++)
+        stats[i] = (jlong) memory_used((MemorySubsystem) i);
+    stats[MEMORY_SUBSYSTEM_COUNT] = (jlong) memory_budget();
+
+    jlongArray arr = env->NewLongArray(MEMORY_SUBSYSTEM_COUNT + 1);
+    if (arr == NULL)
+        return NULL;
+    env->SetLongArrayRegion(arr, 0, MEMORY_SUBSYSTEM_COUNT + 1, stats);
+    return arr;
+}
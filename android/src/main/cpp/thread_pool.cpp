@@ -0,0 +1,83 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads <= 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < num_threads - 1; i++)
+        workers_.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &worker: workers_)
+        worker.join();
+}
+
+void ThreadPool::parallel_for(int n, const std::function<void(int)> &fn) {
+    if (n <= 0)
+        return;
+
+    if (workers_.empty() || n == 1) {
+        for (int i = 0; i < n; i++)
+            fn(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> loop_guard(loop_mutex_);
+    {
+        // workers still leaving the previous loop would otherwise claim iterations of this one
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return active_ == 0; });
+        fn_ = &fn;
+        n_ = n;
+        next_ = 0;
+        remaining_ = n;
+        generation_++;
+    }
+    wake_.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return remaining_ == 0; });
+}
+
+void ThreadPool::work() {
+    int i;
+    while ((i = next_.fetch_add(1)) < n_) {
+        (*fn_)(i);
+        if (remaining_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            done_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::run() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_)
+            return;
+        seen = generation_;
+        active_++;
+
+        lock.unlock();
+        work();
+        lock.lock();
+
+        if (--active_ == 0)
+            done_.notify_all();
+    }
+}
@@ -0,0 +1,57 @@
+//
+// Fixed size pool of worker threads running parallel loops.
+//
+
+#ifndef ANDROID_THREAD_POOL_H
+#define ANDROID_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // Zero threads uses one per core, the calling thread included.
+    explicit ThreadPool(int num_threads = 0);
+
+    ~ThreadPool();
+
+    // the pool shared by the pipelines of the process, one thread per core
+    static ThreadPool &shared();
+
+    // threads working on a loop, the calling thread included
+    int size() const { return (int) workers_.size() + 1; }
+
+    // Runs fn(i) for every i in [0, n) on the workers and the calling thread, and returns once
+    // all have finished. Loops from different threads are run one after the other.
+    void parallel_for(int n, const std::function<void(int)> &fn);
+
+private:
+    void run();
+
+    // claims and runs iterations of the current loop until none are left
+    void work();
+
+    std::vector<std::thread> workers_;
+
+    // one loop at a time
+    std::mutex loop_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    bool stopping_ = false;
+    uint64_t generation_ = 0;
+    // workers inside work()
+    int active_ = 0;
+
+    const std::function<void(int)> *fn_ = nullptr;
+    int n_ = 0;
+    std::atomic<int> next_{0};
+    std::atomic<int> remaining_{0};
+};
+
+#endif //ANDROID_THREAD_POOL_H
@@ -0,0 +1,196 @@
+//
+// Minimal JSON reader for the host tools, enough for COCO annotation files.
+//
+
+#ifndef ANDROID_TOOLS_JSON_H
+#define ANDROID_TOOLS_JSON_H
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct JsonValue {
+    enum Type {
+        NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT
+    };
+
+    Type type = NUL;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    // member of an object, or a null value
+    const JsonValue &operator[](const char *key) const {
+        static const JsonValue null_value;
+        auto it = object.find(key);
+        return it != object.end() ? it->second : null_value;
+    }
+
+    bool is_null() const { return type == NUL; }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string &text) : p_(text.c_str()), end_(text.c_str() + text.size()) {}
+
+    // Returns false on malformed input.
+    bool parse(JsonValue &value) {
+        if (!parse_value(value))
+            return false;
+        skip_space();
+        return p_ == end_;
+    }
+
+private:
+    void skip_space() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t'))
+            p_++;
+    }
+
+    bool literal(const char *word) {
+        size_t n = strlen(word);
+        if ((size_t) (end_ - p_) < n || strncmp(p_, word, n) != 0)
+            return false;
+        p_ += n;
+        return true;
+    }
+
+    bool parse_string(std::string &out) {
+        if (p_ >= end_ || *p_ != '"')
+            return false;
+        p_++;
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ != '\\') {
+                out += *p_++;
+                continue;
+            }
+            if (++p_ >= end_)
+                return false;
+            char c = *p_++;
+            switch (c) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    if (end_ - p_ < 4)
+                        return false;
+                    unsigned code = (unsigned) strtoul(std::string(p_, 4).c_str(), nullptr, 16);
+                    p_ += 4;
+                    // UTF-8, surrogate pairs are kept as two code points
+                    if (code < 0x80) {
+                        out += (char) code;
+                    } else if (code < 0x800) {
+                        out += (char) (0xc0 | (code >> 6));
+                        out += (char) (0x80 | (code & 0x3f));
+                    } else {
+                        out += (char) (0xe0 | (code >> 12));
+                        out += (char) (0x80 | ((code >> 6) & 0x3f));
+                        out += (char) (0x80 | (code & 0x3f));
+                    }
+                    break;
+                }
+                default: out += c; break;
+            }
+        }
+        if (p_ >= end_)
+            return false;
+        p_++;
+        return true;
+    }
+
+    bool parse_value(JsonValue &value) {
+        skip_space();
+        if (p_ >= end_)
+            return false;
+
+        switch (*p_) {
+            case '{': {
+                p_++;
+                value.type = JsonValue::OBJECT;
+                skip_space();
+                if (p_ < end_ && *p_ == '}') {
+                    p_++;
+                    return true;
+                }
+                while (true) {
+                    skip_space();
+                    std::string key;
+                    if (!parse_string(key))
+                        return false;
+                    skip_space();
+                    if (p_ >= end_ || *p_++ != ':')
+                        return false;
+                    if (!parse_value(value.object[key]))
+                        return false;
+                    skip_space();
+                    if (p_ < end_ && *p_ == ',') {
+                        p_++;
+                        continue;
+                    }
+                    if (p_ < end_ && *p_ == '}') {
+                        p_++;
+                        return true;
+                    }
+                    return false;
+                }
+            }
+            case '[': {
+                p_++;
+                value.type = JsonValue::ARRAY;
+                skip_space();
+                if (p_ < end_ && *p_ == ']') {
+                    p_++;
+                    return true;
+                }
+                while (true) {
+                    value.array.emplace_back();
+                    if (!parse_value(value.array.back()))
+                        return false;
+                    skip_space();
+                    if (p_ < end_ && *p_ == ',') {
+                        p_++;
+                        continue;
+                    }
+                    if (p_ < end_ && *p_ == ']') {
+                        p_++;
+                        return true;
+                    }
+                    return false;
+                }
+            }
+            case '"':
+                value.type = JsonValue::STRING;
+                return parse_string(value.string);
+            case 't':
+                value.type = JsonValue::BOOLEAN;
+                value.boolean = true;
+                return literal("true");
+            case 'f':
+                value.type = JsonValue::BOOLEAN;
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default: {
+                char *num_end;
+                value.type = JsonValue::NUMBER;
+                value.number = strtod(p_, &num_end);
+                if (num_end == p_)
+                    return false;
+                p_ = num_end;
+                return true;
+            }
+        }
+    }
+
+    const char *p_;
+    const char *end_;
+};
+
+#endif //ANDROID_TOOLS_JSON_H
@@ -0,0 +1,69 @@
+//
+// Converts binary detection log segments to CSV or JSON lines.
+//
+//   ultralytics_log_convert [--json] <segment or directory>...
+//
+
+#include <sys/stat.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "detection_log.h"
+
+static void print_record(const LogRecord &r, bool json) {
+    const float scale = 1.f / 65535.f;
+    if (json) {
+        printf("{\"timestamp\":%" PRId64 ",\"frame\":%u,\"trackId\":%d,\"index\":%u,\"confidence\":%.4f,"
+               "\"x\":%.5f,\"y\":%.5f,\"width\":%.5f,\"height\":%.5f}\n",
+               r.timestamp, r.frame_id, r.track_id, r.index, r.score * scale,
+               r.x * scale, r.y * scale, r.w * scale, r.h * scale);
+    } else {
+        printf("%" PRId64 ",%u,%d,%u,%.4f,%.5f,%.5f,%.5f,%.5f\n",
+               r.timestamp, r.frame_id, r.track_id, r.index, r.score * scale,
+               r.x * scale, r.y * scale, r.w * scale, r.h * scale);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool json = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+            continue;
+        }
+
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            for (const std::string &segment: DetectionLogReader::segments(argv[i]))
+                paths.push_back(segment);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        fprintf(stderr, "usage: %s [--json] <segment or directory>...\n", argv[0]);
+        return 1;
+    }
+
+    if (!json)
+        printf("timestamp,frame,track_id,index,confidence,x,y,width,height\n");
+
+    int status = 0;
+    DetectionLogReader reader;
+    for (const std::string &path: paths) {
+        if (!reader.open(path)) {
+            fprintf(stderr, "%s: not a detection log segment\n", path.c_str());
+            status = 1;
+            continue;
+        }
+        for (size_t i = 0; i < reader.size(); i++)
+            print_record(reader[i], json);
+    }
+    return status;
+}
@@ -0,0 +1,188 @@
+//
+// Feeds recorded or synthetic camera frames through the native pipeline on the host and reports
+// throughput per stage, with a digest of the outputs to compare runs frame for frame.
+//
+//   ultralytics_replay [--realtime] [--frames N] [--detections <log directory>] [--verbose]
+//                      <recording | synthetic>
+//
+// Detections come from the synthetic ground truth, or from a detection log recorded alongside the
+// frames, matched by timestamp.
+//
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "detection_log.h"
+#include "frame_recording.h"
+#include "frame_source.h"
+#include "heatmap.h"
+#include "preprocess.h"
+#include "track_history.h"
+#include "tracker.h"
+
+static const int INPUT_SIZE = 640;
+
+enum Stage {
+    STAGE_PREPROCESS,
+    STAGE_TRACK,
+    STAGE_ANALYTICS,
+    STAGE_COUNT
+};
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {"preprocess", "track", "analytics"};
+
+// FNV-1a over 64 bit words, then the remaining bytes
+static void digest(uint64_t &hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    for (; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+static std::map<int64_t, std::vector<DetectedObject>> load_detections(const std::string &directory) {
+    std::map<int64_t, std::vector<DetectedObject>> detections;
+    const float scale = 1.f / 65535.f;
+
+    DetectionLogReader reader;
+    for (const std::string &segment: DetectionLogReader::segments(directory)) {
+        if (!reader.open(segment))
+            continue;
+        for (size_t i = 0; i < reader.size(); i++) {
+            const LogRecord &r = reader[i];
+            DetectedObject obj;
+            obj.rect = Box(r.x * scale, r.y * scale, r.w * scale, r.h * scale);
+            obj.index = r.index;
+            obj.confidence = r.score * scale;
+            detections[r.timestamp].push_back(obj);
+        }
+    }
+    return detections;
+}
+
+int main(int argc, char **argv) {
+    bool realtime = false;
+    bool verbose = false;
+    int64_t max_frames = -1;
+    std::string detections_path;
+    std::string input;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--realtime") == 0)
+            realtime = true;
+        else if (strcmp(argv[i], "--verbose") == 0)
+            verbose = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            max_frames = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--detections") == 0 && i + 1 < argc)
+            detections_path = argv[++i];
+        else
+            input = argv[i];
+    }
+
+    if (input.empty()) {
+        fprintf(stderr, "usage: %s [--realtime] [--frames N] [--detections <log directory>] [--verbose] "
+                        "<recording | synthetic>\n", argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<FrameSource> source;
+    SyntheticFrameSource *synthetic = nullptr;
+    if (input == "synthetic") {
+        synthetic = new SyntheticFrameSource(640, 480, 10, 30, max_frames < 0 ? 300 : max_frames);
+        source.reset(synthetic);
+    } else {
+        auto recording = new RecordingFrameSource();
+        source.reset(recording);
+        if (!recording->open(input, realtime)) {
+            fprintf(stderr, "%s: not a frame recording\n", input.c_str());
+            return 1;
+        }
+        printf("%s: %zu frames, %u dropped while recording\n", input.c_str(), recording->size(),
+               recording->dropped());
+    }
+
+    std::map<int64_t, std::vector<DetectedObject>> logged;
+    if (!detections_path.empty())
+        logged = load_detections(detections_path);
+
+    std::vector<float> input_tensor((size_t) INPUT_SIZE * INPUT_SIZE * 3);
+    const Box full_frame(0.f, 0.f, 1.f, 1.f);
+
+    Tracker tracker;
+    Heatmap heatmap;
+    heatmap.configure(64, 64, 300000000000LL);
+    TrackHistory history;
+    history.configure(1 << 20, 256, 0.002f);
+
+    double stage_us[STAGE_COUNT] = {};
+    uint64_t hash = 14695981039346656037ULL;
+    int64_t frames = 0;
+    std::vector<DetectedObject> objects;
+    std::vector<uint8_t> snapshot;
+
+    auto start = std::chrono::steady_clock::now();
+    Frame frame;
+    while ((max_frames < 0 || frames < max_frames) && source->next(frame)) {
+        auto t0 = std::chrono::steady_clock::now();
+        yuv420_crop_resize_rgb(frame, full_frame, input_tensor.data(), INPUT_SIZE, INPUT_SIZE);
+
+        // the model runs on device only, its results come from the ground truth or the log
+        if (synthetic != nullptr) {
+            objects = synthetic->objects();
+        } else {
+            auto it = logged.find(frame.timestamp);
+            objects = it != logged.end() ? it->second : std::vector<DetectedObject>();
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+        tracker.update(objects, frame.timestamp);
+
+        auto t2 = std::chrono::steady_clock::now();
+        heatmap.accumulate(objects, frame.timestamp);
+        history.update(tracker.tracks(), frame.timestamp);
+
+        auto t3 = std::chrono::steady_clock::now();
+        stage_us[STAGE_PREPROCESS] += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        stage_us[STAGE_TRACK] += std::chrono::duration<double, std::micro>(t2 - t1).count();
+        stage_us[STAGE_ANALYTICS] += std::chrono::duration<double, std::micro>(t3 - t2).count();
+
+        digest(hash, input_tensor.data(), input_tensor.size() * sizeof(float));
+        for (const DetectedObject &obj: objects) {
+            digest(hash, &obj.track_id, sizeof(obj.track_id));
+            digest(hash, &obj.rect, sizeof(obj.rect));
+        }
+        if (verbose)
+            printf("frame %" PRId64 " t=%" PRId64 " objects=%zu digest=%016" PRIx64 "\n",
+                   frames, frame.timestamp, objects.size(), hash);
+        frames++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    heatmap.snapshot(frame.timestamp, snapshot);
+    digest(hash, snapshot.data(), snapshot.size());
+
+    double pipeline_us = 0;
+    for (double us: stage_us)
+        pipeline_us += us;
+    printf("%" PRId64 " frames in %.3f s, %.1f fps, pipeline alone %.1f fps\n", frames, seconds,
+           frames / seconds, pipeline_us > 0 ? frames * 1e6 / pipeline_us : 0.0);
+    for (int s = 0; s < STAGE_COUNT; s++)
+        printf("  %-12s %10.1f us/frame\n", STAGE_NAMES[s], frames ? stage_us[s] / frames : 0.0);
+    printf("digest %016" PRIx64 "\n", hash);
+    return 0;
+}
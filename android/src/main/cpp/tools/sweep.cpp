@@ -0,0 +1,468 @@
+//
+// Sweeps postprocess settings over a COCO format dataset and reports accuracy and latency.
+//
+//   ultralytics_sweep --annotations <instances.json> (--outputs <directory> | --mock)
+//                     [--conf 0.001,0.25] [--iou 0.45,0.7] [--nms agnostic,class]
+//                     [--max-proposals 0,300] [--max-det 100] [--threads N] [--images N]
+//
+// Recorded outputs are raw little endian float32 [4 + classes][anchors] tensors named
+// <image id>.bin or <file name without extension>.bin, produced from the image stretched to the
+// model input. --mock synthesizes outputs from the ground truth instead.
+//
+// mAP follows the COCO bbox evaluation over all areas: IoU thresholds 0.50:0.05:0.95, 101 recall
+// points, crowd boxes ignored, at most --max-det detections per image and class.
+//
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "postprocess.h"
+#include "thread_pool.h"
+
+static const int MOCK_ANCHORS = 8400;
+static const int NUM_IOU_THRESHOLDS = 10;
+static const int NUM_RECALL_POINTS = 101;
+
+struct GroundTruth {
+    float x, y, w, h;
+    int category;
+    bool crowd;
+};
+
+struct Image {
+    int64_t id;
+    std::string file_name;
+    float width;
+    float height;
+    std::vector<GroundTruth> boxes;
+};
+
+struct Detection {
+    float x, y, w, h;
+    float score;
+    int category;
+};
+
+struct SweepResult {
+    PostprocessConfig config;
+    double map = 0;
+    double map50 = 0;
+    double mean_us = 0;
+    double p95_us = 0;
+    double mean_detections = 0;
+};
+
+static std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> parts;
+    std::stringstream stream(s);
+    std::string part;
+    while (std::getline(stream, part, ','))
+        parts.push_back(part);
+    return parts;
+}
+
+static bool load_dataset(const std::string &path, std::vector<Image> &images, int &num_classes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::stringstream text;
+    text << file.rdbuf();
+
+    JsonValue root;
+    if (!JsonParser(text.str()).parse(root))
+        return false;
+
+    // model class indices follow the sorted category ids
+    std::vector<int64_t> category_ids;
+    for (const JsonValue &c: root["categories"].array)
+        category_ids.push_back((int64_t) c["id"].number);
+    std::sort(category_ids.begin(), category_ids.end());
+    num_classes = (int) category_ids.size();
+
+    std::map<int64_t, size_t> image_index;
+    for (const JsonValue &i: root["images"].array) {
+        Image image;
+        image.id = (int64_t) i["id"].number;
+        image.file_name = i["file_name"].string;
+        image.width = (float) i["width"].number;
+        image.height = (float) i["height"].number;
+        image_index[image.id] = images.size();
+        images.push_back(image);
+    }
+
+    size_t unknown_categories = 0;
+    for (const JsonValue &a: root["annotations"].array) {
+        auto it = image_index.find((int64_t) a["image_id"].number);
+        const int64_t category_id = (int64_t) a["category_id"].number;
+        auto category = std::lower_bound(category_ids.begin(), category_ids.end(), category_id);
+        const JsonValue &bbox = a["bbox"];
+        if (it == image_index.end() || bbox.array.size() != 4)
+            continue;
+        // an id missing from the categories would otherwise be counted as the next class
+        if (category == category_ids.end() || *category != category_id) {
+            unknown_categories++;
+            continue;
+        }
+
+        GroundTruth gt;
+        gt.x = (float) bbox.array[0].number;
+        gt.y = (float) bbox.array[1].number;
+        gt.w = (float) bbox.array[2].number;
+        gt.h = (float) bbox.array[3].number;
+        gt.category = (int) (category - category_ids.begin());
+        gt.crowd = a["iscrowd"].number != 0;
+        images[it->second].boxes.push_back(gt);
+    }
+
+    if (unknown_categories > 0)
+        fprintf(stderr, "%s: skipped %zu annotations of unknown categories\n", path.c_str(), unknown_categories);
+    return true;
+}
+
+static bool load_output(const std::string &directory, const Image &image, int num_classes,
+                        std::vector<float> &output, int &num_anchors) {
+    std::string stem = image.file_name.substr(0, image.file_name.find_last_of('.'));
+    for (const std::string &name: {std::to_string(image.id), stem}) {
+        std::ifstream file(directory + "/" + name + ".bin", std::ios::binary | std::ios::ate);
+        if (!file)
+            continue;
+        size_t floats = (size_t) file.tellg() / sizeof(float);
+        num_anchors = (int) (floats / (4 + num_classes));
+        output.resize((size_t) num_anchors * (4 + num_classes));
+        file.seekg(0);
+        file.read((char *) output.data(), output.size() * sizeof(float));
+        return num_anchors > 0;
+    }
+    return false;
+}
+
+// xorshift32
+static float next_random(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.f / 16777216.f);
+}
+
+// A plausible detector output: several jittered candidates per object, some with the wrong class,
+// and low scoring clutter.
+static void mock_output(const Image &image, int num_classes, std::vector<float> &output) {
+    const int n = MOCK_ANCHORS;
+    output.assign((size_t) n * (4 + num_classes), 0.f);
+    uint32_t state = (uint32_t) (image.id * 2654435761u) | 1u;
+
+    int anchor = 0;
+    auto emit = [&](float cx, float cy, float w, float h, int category, float score) {
+        if (anchor >= n)
+            return;
+        output[anchor] = cx;
+        output[n + anchor] = cy;
+        output[2 * n + anchor] = w;
+        output[3 * n + anchor] = h;
+        output[(size_t) (4 + category) * n + anchor] = score;
+        anchor++;
+    };
+
+    for (const GroundTruth &gt: image.boxes) {
+        if (gt.crowd)
+            continue;
+        float cx = (gt.x + gt.w / 2) / image.width;
+        float cy = (gt.y + gt.h / 2) / image.height;
+        float w = gt.w / image.width;
+        float h = gt.h / image.height;
+        float quality = 0.3f + 0.65f * next_random(state);
+
+        int candidates = 2 + (int) (next_random(state) * 5);
+        for (int c = 0; c < candidates; c++) {
+            float jitter = 0.15f * (1.f - quality);
+            int category = next_random(state) < 0.1f ? (int) (next_random(state) * num_classes) : gt.category;
+            emit(cx + (next_random(state) - 0.5f) * jitter * w, cy + (next_random(state) - 0.5f) * jitter * h,
+                 w * (1.f + (next_random(state) - 0.5f) * jitter), h * (1.f + (next_random(state) - 0.5f) * jitter),
+                 category, quality * (0.6f + 0.4f * next_random(state)));
+        }
+    }
+
+    // the long tail that makes low thresholds expensive
+    while (anchor < n) {
+        float w = 0.02f + 0.3f * next_random(state);
+        float h = 0.02f + 0.3f * next_random(state);
+        float r = next_random(state);
+        emit(next_random(state), next_random(state), w, h, (int) (next_random(state) * num_classes),
+             0.3f * std::exp(-20.f * r));
+    }
+}
+
+static float box_iou(const Detection &d, const GroundTruth &g) {
+    float ix = std::max(0.f, std::min(d.x + d.w, g.x + g.w) - std::max(d.x, g.x));
+    float iy = std::max(0.f, std::min(d.y + d.h, g.y + g.h) - std::max(d.y, g.y));
+    float inter = ix * iy;
+    // crowd regions count the detection covered by them
+    float denominator = g.crowd ? d.w * d.h : d.w * d.h + g.w * g.h - inter;
+    return denominator > 0 ? inter / denominator : 0.f;
+}
+
+// COCO average precision per IoU threshold, averaged over the classes that have ground truth
+static void evaluate(const std::vector<Image> &images, const std::vector<std::vector<Detection>> &detections,
+                     int num_classes, int max_detections, double &map, double &map50) {
+    struct Scored {
+        float score;
+        bool matched;
+    };
+
+    double sum[NUM_IOU_THRESHOLDS] = {};
+    int classes_with_gt = 0;
+
+    for (int c = 0; c < num_classes; c++) {
+        std::vector<Scored> scored[NUM_IOU_THRESHOLDS];
+        int num_gt = 0;
+
+        for (size_t i = 0; i < images.size(); i++) {
+            std::vector<const GroundTruth *> gts;
+            for (const GroundTruth &g: images[i].boxes)
+                if (g.category == c)
+                    gts.push_back(&g);
+            // crowd boxes last, so they only match what nothing else does
+            std::stable_sort(gts.begin(), gts.end(), [](const GroundTruth *a, const GroundTruth *b) {
+                return !a->crowd && b->crowd;
+            });
+            for (const GroundTruth *g: gts)
+                num_gt += !g->crowd;
+
+            std::vector<const Detection *> dts;
+            for (const Detection &d: detections[i])
+                if (d.category == c)
+                    dts.push_back(&d);
+            std::stable_sort(dts.begin(), dts.end(), [](const Detection *a, const Detection *b) {
+                return a->score > b->score;
+            });
+            if ((int) dts.size() > max_detections)
+                dts.resize(max_detections);
+
+            for (int t = 0; t < NUM_IOU_THRESHOLDS; t++) {
+                float threshold = 0.5f + 0.05f * t;
+                std::vector<bool> taken(gts.size(), false);
+                for (const Detection *d: dts) {
+                    int best = -1;
+                    float best_iou = std::min(threshold, 1.f - 1e-10f);
+                    for (int g = 0; g < (int) gts.size(); g++) {
+                        if (taken[g] && !gts[g]->crowd)
+                            continue;
+                        if (best >= 0 && !gts[best]->crowd && gts[g]->crowd)
+                            break;
+                        float iou = box_iou(*d, *gts[g]);
+                        if (iou < best_iou)
+                            continue;
+                        best_iou = iou;
+                        best = g;
+                    }
+                    if (best >= 0) {
+                        taken[best] = true;
+                        // matches with crowd regions are neither true nor false positives
+                        if (gts[best]->crowd)
+                            continue;
+                    }
+                    scored[t].push_back({d->score, best >= 0});
+                }
+            }
+        }
+
+        if (num_gt == 0)
+            continue;
+        classes_with_gt++;
+
+        for (int t = 0; t < NUM_IOU_THRESHOLDS; t++) {
+            std::vector<Scored> &s = scored[t];
+            std::stable_sort(s.begin(), s.end(), [](const Scored &a, const Scored &b) {
+                return a.score > b.score;
+            });
+
+            std::vector<double> recall(s.size());
+            std::vector<double> precision(s.size());
+            int tp = 0;
+            for (size_t k = 0; k < s.size(); k++) {
+                tp += s[k].matched;
+                recall[k] = (double) tp / num_gt;
+                precision[k] = (double) tp / (k + 1);
+            }
+            for (int k = (int) s.size() - 2; k >= 0; k--)
+                precision[k] = std::max(precision[k], precision[k + 1]);
+
+            double ap = 0;
+            for (int r = 0; r < NUM_RECALL_POINTS; r++) {
+                double target = r / 100.0;
+                size_t k = std::lower_bound(recall.begin(), recall.end(), target) - recall.begin();
+                ap += k < precision.size() ? precision[k] : 0.0;
+            }
+            sum[t] += ap / NUM_RECALL_POINTS;
+        }
+    }
+
+    map = 0;
+    map50 = 0;
+    if (classes_with_gt == 0)
+        return;
+    for (int t = 0; t < NUM_IOU_THRESHOLDS; t++)
+        map += sum[t] / classes_with_gt;
+    map /= NUM_IOU_THRESHOLDS;
+    map50 = sum[0] / classes_with_gt;
+}
+
+static SweepResult run_config(const PostprocessConfig &config, const std::vector<Image> &images, int num_classes,
+                              const std::string &outputs, bool mock) {
+    SweepResult result;
+    result.config = config;
+
+    std::vector<std::vector<Detection>> detections(images.size());
+    std::vector<double> latencies;
+    std::vector<float> output;
+    Detections proposals;
+    Detections selected;
+    std::vector<DetectedObject> objects;
+    size_t total_detections = 0;
+
+    for (size_t i = 0; i < images.size(); i++) {
+        const Image &image = images[i];
+        int num_anchors = MOCK_ANCHORS;
+        if (mock)
+            mock_output(image, num_classes, output);
+        else if (!load_output(outputs, image, num_classes, output, num_anchors))
+            continue;
+
+        auto start = std::chrono::steady_clock::now();
+        proposals.clear();
+        generate_proposals(output.data(), num_anchors, num_classes, config.confidence_threshold, nullptr, proposals);
+        select_detections(proposals, config, selected);
+        auto end = std::chrono::steady_clock::now();
+
+        objects.clear();
+        selected.append_objects(objects);
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+
+        for (const DetectedObject &obj: objects) {
+            detections[i].push_back({obj.rect.x * image.width, obj.rect.y * image.height,
+                                     obj.rect.width * image.width, obj.rect.height * image.height,
+                                     obj.confidence, obj.index});
+        }
+        total_detections += objects.size();
+    }
+
+    if (!latencies.empty()) {
+        double sum = 0;
+        for (double l: latencies)
+            sum += l;
+        result.mean_us = sum / latencies.size();
+        std::sort(latencies.begin(), latencies.end());
+        result.p95_us = latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)];
+        result.mean_detections = (double) total_detections / latencies.size();
+    }
+
+    evaluate(images, detections, num_classes, config.max_detections, result.map, result.map50);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    std::string annotations;
+    std::string outputs;
+    bool mock = false;
+    int threads = 0;
+    int max_images = -1;
+    int max_detections = 100;
+    std::vector<std::string> conf_values = {"0.001", "0.05", "0.25"};
+    std::vector<std::string> iou_values = {"0.45", "0.6", "0.7"};
+    std::vector<std::string> nms_values = {"agnostic", "class"};
+    std::vector<std::string> cap_values = {"0", "300", "1000"};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--mock")
+            mock = true;
+        else if (arg == "--annotations" && has_value)
+            annotations = argv[++i];
+        else if (arg == "--outputs" && has_value)
+            outputs = argv[++i];
+        else if (arg == "--conf" && has_value)
+            conf_values = split(argv[++i]);
+        else if (arg == "--iou" && has_value)
+            iou_values = split(argv[++i]);
+        else if (arg == "--nms" && has_value)
+            nms_values = split(argv[++i]);
+        else if (arg == "--max-proposals" && has_value)
+            cap_values = split(argv[++i]);
+        else if (arg == "--max-det" && has_value)
+            max_detections = atoi(argv[++i]);
+        else if (arg == "--threads" && has_value)
+            threads = atoi(argv[++i]);
+        else if (arg == "--images" && has_value)
+            max_images = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "unknown argument %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    if (annotations.empty() || (outputs.empty() && !mock)) {
+        fprintf(stderr, "usage: %s --annotations <instances.json> (--outputs <directory> | --mock)\n"
+                        "       [--conf list] [--iou list] [--nms agnostic,class] [--max-proposals list]\n"
+                        "       [--max-det N] [--threads N] [--images N]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Image> images;
+    int num_classes = 0;
+    if (!load_dataset(annotations, images, num_classes)) {
+        fprintf(stderr, "%s: could not read COCO annotations\n", annotations.c_str());
+        return 1;
+    }
+    if (max_images >= 0 && (int) images.size() > max_images)
+        images.resize(max_images);
+
+    std::vector<PostprocessConfig> configs;
+    for (const std::string &conf: conf_values) {
+        for (const std::string &iou: iou_values) {
+            for (const std::string &nms: nms_values) {
+                for (const std::string &cap: cap_values) {
+                    PostprocessConfig config;
+                    config.confidence_threshold = (float) atof(conf.c_str());
+                    config.iou_threshold = (float) atof(iou.c_str());
+                    config.nms_mode = nms == "class" ? NMS_PER_CLASS : NMS_AGNOSTIC;
+                    config.max_proposals = atoi(cap.c_str());
+                    config.max_detections = max_detections;
+                    configs.push_back(config);
+                }
+            }
+        }
+    }
+
+    ThreadPool pool(threads);
+    fprintf(stderr, "%zu images, %d classes, %zu configurations on %d threads\n",
+            images.size(), num_classes, configs.size(), pool.size());
+
+    // one configuration per task, latency is measured within each task
+    std::vector<SweepResult> results(configs.size());
+    pool.parallel_for((int) configs.size(), [&](int i) {
+        results[i] = run_config(configs[i], images, num_classes, outputs, mock);
+    });
+
+    printf("%8s %6s %9s %8s %10s %10s %10s %10s %8s\n",
+           "conf", "iou", "nms", "max_prop", "mAP50-95", "mAP50", "mean_us", "p95_us", "dets");
+    for (const SweepResult &r: results) {
+        printf("%8.3f %6.2f %9s %8d %10.4f %10.4f %10.1f %10.1f %8.1f\n",
+               r.config.confidence_threshold, r.config.iou_threshold,
+               r.config.nms_mode == NMS_PER_CLASS ? "class" : "agnostic", r.config.max_proposals,
+               r.map, r.map50, r.mean_us, r.p95_us, r.mean_detections);
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include "track_history.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const float QUANT_SCALE = 32767.f;
+static const float PI = 3.14159265f;
+
+static int16_t quantize(float v) {
+    return (int16_t) std::lround(std::min(std::max(v, 0.f), 1.f) * QUANT_SCALE);
+}
+
+// `angle` moved by whole turns to the nearest of `center`
+static float unwrap(float angle, float center) {
+    return angle + 2.f * PI * std::round((center - angle) / (2.f * PI));
+}
+
+void TrackHistory::configure(size_t memory_budget, int points_per_track, float epsilon) {
+    points_per_track_ = std::max(points_per_track, 3);
+    epsilon_ = epsilon * QUANT_SCALE;
+
+    size_t ring_bytes = points_per_track_ * sizeof(HistoryPoint) + sizeof(Ring);
+    size_t max_tracks = memory_budget / ring_bytes;
+
+    pool_.assign(max_tracks * points_per_track_, HistoryPoint());
+    rings_.assign(max_tracks, Ring());
+    ring_index_.clear();
+    has_epoch_ = false;
+}
+
+int TrackHistory::acquire_ring(int track_id) {
+    auto it = ring_index_.find(track_id);
+    if (it != ring_index_.end())
+        return it->second;
+
+    // a free ring, or the one updated longest ago
+    int victim = 0;
+    for (int r = 0; r < (int) rings_.size(); r++) {
+        if (rings_[r].track_id < 0) {
+            victim = r;
+            break;
+        }
+        if (rings_[r].last_update < rings_[victim].last_update)
+            victim = r;
+    }
+
+    if (rings_[victim].track_id >= 0)
+        ring_index_.erase(rings_[victim].track_id);
+
+    rings_[victim] = Ring();
+    rings_[victim].track_id = track_id;
+    ring_index_[track_id] = victim;
+    return victim;
+}
+
+// The cone is an interval of directions, every direction while it is infinite and none once it is
+// inverted. A run point closer than epsilon to the anchor is near every segment from it, a farther
+// one at distance d is within epsilon of the rays less than asin(epsilon / d) away from it. Those
+// rays also project it between the anchor and any endpoint at least as far away.
+void TrackHistory::narrow(Ring &ring, const HistoryPoint &anchor, const HistoryPoint &p) const {
+    float dx = p.x - anchor.x;
+    float dy = p.y - anchor.y;
+    float d = std::sqrt(dx * dx + dy * dy);
+    ring.reach = std::max(ring.reach, d);
+    if (d <= epsilon_)
+        return;
+
+    float half = std::asin(epsilon_ / d);
+    if (std::isinf(ring.cone_lo)) {
+        float theta = std::atan2(dy, dx);
+        ring.cone_lo = theta - half;
+        ring.cone_hi = theta + half;
+    } else if (ring.cone_lo <= ring.cone_hi) {
+        float theta = unwrap(std::atan2(dy, dx), (ring.cone_lo + ring.cone_hi) / 2);
+        ring.cone_lo = std::max(ring.cone_lo, theta - half);
+        ring.cone_hi = std::min(ring.cone_hi, theta + half);
+    }
+}
+
+bool TrackHistory::covers(const Ring &ring, const HistoryPoint &anchor, const HistoryPoint &p) const {
+    float dx = p.x - anchor.x;
+    float dy = p.y - anchor.y;
+    if (std::sqrt(dx * dx + dy * dy) < ring.reach)
+        return false;
+    if (std::isinf(ring.cone_lo))
+        return true;
+
+    float theta = unwrap(std::atan2(dy, dx), (ring.cone_lo + ring.cone_hi) / 2);
+    return theta >= ring.cone_lo && theta <= ring.cone_hi;
+}
+
+void TrackHistory::append(Ring &ring, HistoryPoint *points, const HistoryPoint &p) {
+    const int n = points_per_track_;
+
+    if (ring.count >= 1) {
+        HistoryPoint &last = points[(ring.start + ring.count - 1) % n];
+        const HistoryPoint *anchor = ring.open ? &points[(ring.start + ring.count - 2) % n] : nullptr;
+
+        // drop points that do not move, unless they are needed to keep the time resolution. They
+        // stay part of the run, a later replacement of the last point has to pass near them too.
+        if (std::abs(p.x - last.x) + std::abs(p.y - last.y) <= epsilon_ && p.t - last.t < max_gap_ms_) {
+            if (anchor != nullptr)
+                narrow(ring, *anchor, p);
+            return;
+        }
+
+        // the last point and the ones dropped before it lie on the way to the new one, replace it
+        if (anchor != nullptr && p.t - anchor->t < max_gap_ms_ && covers(ring, *anchor, p)) {
+            narrow(ring, *anchor, p);
+            last = p;
+            return;
+        }
+    }
+
+    if (ring.count < n) {
+        points[(ring.start + ring.count) % n] = p;
+        ring.count++;
+    } else {
+        // full, overwrite the oldest point
+        points[ring.start] = p;
+        ring.start = (ring.start + 1) % n;
+    }
+
+    // a new run from the previous point
+    ring.open = ring.count >= 2;
+    ring.cone_lo = -INFINITY;
+    ring.cone_hi = INFINITY;
+    ring.reach = 0.f;
+    if (ring.open)
+        narrow(ring, points[(ring.start + ring.count - 2) % n], p);
+}
+
+void TrackHistory::update(const TrackList &tracks, int64_t timestamp) {
+    if (rings_.empty())
+        return;
+
+    if (!has_epoch_) {
+        epoch_ = timestamp;
+        has_epoch_ = true;
+    }
+    last_timestamp_ = timestamp;
+
+    for (const Track &track: tracks) {
+        if (track.missed > 0)
+            continue;
+
+        HistoryPoint p;
+        p.x = quantize(track.rect.x + track.rect.width / 2);
+        p.y = quantize(track.rect.y + track.rect.height / 2);
+        p.t = (uint32_t) ((timestamp - epoch_) / 1000000);
+
+        int r = acquire_ring(track.id);
+        rings_[r].last_update = timestamp;
+        append(rings_[r], &pool_[(size_t) r * points_per_track_], p);
+    }
+}
+
+void TrackHistory::relabel(int from, int to) {
+    auto it = ring_index_.find(from);
+    if (it == ring_index_.end())
+        return;
+
+    // the trajectory before the occlusion is kept, the short one of the new track is dropped
+    int r = it->second;
+    ring_index_.erase(it);
+    if (ring_index_.find(to) != ring_index_.end()) {
+        rings_[r] = Ring();
+        return;
+    }
+    rings_[r].track_id = to;
+    ring_index_[to] = r;
+}
+
+int TrackHistory::query(int track_id, int64_t window_ns, std::vector<uint8_t> &out) const {
+    auto it = ring_index_.find(track_id);
+    if (it == ring_index_.end())
+        return 0;
+
+    const Ring &ring = rings_[it->second];
+    const HistoryPoint *points = &pool_[(size_t) it->second * points_per_track_];
+    const int64_t now_ms = (last_timestamp_ - epoch_) / 1000000;
+    const int64_t window_ms = window_ns / 1000000;
+
+    int count = 0;
+    for (int i = 0; i < ring.count; i++) {
+        const HistoryPoint &p = points[(ring.start + i) % points_per_track_];
+        uint32_t age = (uint32_t) (now_ms - p.t);
+        if (age > window_ms)
+            continue;
+
+        uint8_t record[8];
+        memcpy(record, &p.x, 2);
+        memcpy(record + 2, &p.y, 2);
+        memcpy(record + 4, &age, 4);
+        out.insert(out.end(), record, record + 8);
+        count++;
+    }
+    return count;
+}
+
+void TrackHistory::shed() {
+    if (rings_.size() <= 1)
+        return;
+
+    std::vector<int> order(rings_.size());
+    for (int r = 0; r < (int) order.size(); r++)
+        order[r] = r;
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return rings_[a].last_update > rings_[b].last_update;
+    });
+    order.resize(rings_.size() / 2);
+
+    CountedVector<HistoryPoint, MEMORY_HISTORY> pool(order.size() * points_per_track_);
+    CountedVector<Ring, MEMORY_HISTORY> rings(order.size());
+    ring_index_.clear();
+    for (int r = 0; r < (int) order.size(); r++) {
+        std::copy_n(&pool_[(size_t) order[r] * points_per_track_], points_per_track_,
+                    &pool[(size_t) r * points_per_track_]);
+        rings[r] = rings_[order[r]];
+        if (rings[r].track_id >= 0)
+            ring_index_[rings[r].track_id] = r;
+    }
+    pool_.swap(pool);
+    rings_.swap(rings);
+}
@@ -0,0 +1,86 @@
+//
+// Per-track trajectories stored as quantized points in fixed size ring
+// buffers, simplified online and bounded by a total memory budget.
+//
+
+#ifndef ANDROID_TRACK_HISTORY_H
+#define ANDROID_TRACK_HISTORY_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_budget.h"
+#include "tracker.h"
+
+struct HistoryPoint {
+    // normalized center scaled to [0, 32767]
+    int16_t x;
+    int16_t y;
+    // milliseconds since the first update
+    uint32_t t;
+};
+
+class TrackHistory {
+public:
+    // A zero budget disables the history. `epsilon` is the largest normalized distance a dropped
+    // point may lie from the simplified trajectory.
+    void configure(size_t memory_budget, int points_per_track, float epsilon);
+
+    bool enabled() const { return !rings_.empty(); }
+
+    void update(const TrackList &tracks, int64_t timestamp);
+
+    void relabel(int from, int to);
+
+    // Appends the points of `track_id` from the last `window_ns` before the latest update, oldest
+    // first, packed as {int16 x, int16 y, uint32 age ms} in native byte order. Returns the count.
+    int query(int track_id, int64_t window_ns, std::vector<uint8_t> &out) const;
+
+    size_t memory_usage() const { return pool_.size() * sizeof(HistoryPoint) + rings_.size() * sizeof(Ring); }
+
+    // Halves the number of tracks kept when memory is short, keeping the ones updated last.
+    void shed();
+
+private:
+    struct Ring {
+        int track_id = -1;
+        int start = 0;
+        int count = 0;
+        int64_t last_update = 0;
+        // the last point may still be moved along a run starting at the point before it
+        bool open = false;
+        // directions from that anchor passing within epsilon of every point of the run, and the
+        // farthest distance of one from it
+        float cone_lo = 0.f;
+        float cone_hi = 0.f;
+        float reach = 0.f;
+    };
+
+    void append(Ring &ring, HistoryPoint *points, const HistoryPoint &p);
+
+    // Adds point `p` of the run to the cone of `ring`.
+    void narrow(Ring &ring, const HistoryPoint &anchor, const HistoryPoint &p) const;
+
+    // Whether the segment from the anchor to `p` passes within epsilon of every point of the run.
+    bool covers(const Ring &ring, const HistoryPoint &anchor, const HistoryPoint &p) const;
+
+    int acquire_ring(int track_id);
+
+    int points_per_track_ = 0;
+    float epsilon_ = 0.f;
+    // points have a minimum spacing in time even when the object does not move
+    uint32_t max_gap_ms_ = 1000;
+
+    bool has_epoch_ = false;
+    int64_t epoch_ = 0;
+    int64_t last_timestamp_ = 0;
+
+    // one slab of points_per_track_ points per ring
+    CountedVector<HistoryPoint, MEMORY_HISTORY> pool_;
+    CountedVector<Ring, MEMORY_HISTORY> rings_;
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+            CountingAllocator<std::pair<const int, int>, MEMORY_HISTORY>> ring_index_;
+};
+
+#endif //ANDROID_TRACK_HISTORY_H
@@ -0,0 +1,140 @@
+#include "tracker.h"
+
+#include <algorithm>
+
+static float rect_iou(const Box &a, const Box &b) {
+    float inter_area = (a & b).area();
+    float union_area = a.area() + b.area() - inter_area;
+    return union_area > 0.f ? inter_area / union_area : 0.f;
+}
+
+void Tracker::update(std::vector<DetectedObject> &objects, int64_t timestamp) {
+    struct Candidate {
+        float iou;
+        int track;
+        int object;
+    };
+
+    // collect every same-class (track, object) pair above the threshold
+    std::vector<Candidate> candidates;
+    for (int t = 0; t < (int) tracks_.size(); t++) {
+        for (int o = 0; o < (int) objects.size(); o++) {
+            if (tracks_[t].index != objects[o].index)
+                continue;
+
+            float iou = rect_iou(tracks_[t].rect, objects[o].rect);
+            if (iou > iou_threshold)
+                candidates.push_back({iou, t, o});
+        }
+    }
+
+    // greedy assignment, best overlap first
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate &a, const Candidate &b) { return a.iou > b.iou; });
+
+    std::vector<char> track_matched(tracks_.size(), 0);
+    std::vector<char> object_matched(objects.size(), 0);
+    for (const Candidate &c: candidates) {
+        if (track_matched[c.track] || object_matched[c.object])
+            continue;
+
+        track_matched[c.track] = 1;
+        object_matched[c.object] = 1;
+
+        Track &track = tracks_[c.track];
+        const Box &rect = objects[c.object].rect;
+        if (timestamp > track.timestamp) {
+            float dt = (timestamp - track.timestamp) / 1e9f;
+            float a = velocity_smoothing;
+            track.vx = a * (rect.x - track.rect.x) / dt + (1 - a) * track.vx;
+            track.vy = a * (rect.y - track.rect.y) / dt + (1 - a) * track.vy;
+            track.vw = a * (rect.width - track.rect.width) / dt + (1 - a) * track.vw;
+            track.vh = a * (rect.height - track.rect.height) / dt + (1 - a) * track.vh;
+        }
+        track.rect = rect;
+        track.confidence = objects[c.object].confidence;
+        track.hits++;
+        track.missed = 0;
+        track.timestamp = timestamp;
+
+        objects[c.object].track_id = track.id;
+    }
+
+    for (int t = 0; t < (int) tracks_.size(); t++) {
+        if (!track_matched[t])
+            tracks_[t].missed++;
+    }
+
+    tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                                 [this](const Track &t) { return t.missed > max_missed; }),
+                  tracks_.end());
+
+    // unmatched objects start new tracks
+    for (int o = 0; o < (int) objects.size(); o++) {
+        if (object_matched[o])
+            continue;
+
+        Track track;
+        track.id = next_id_++;
+        track.rect = objects[o].rect;
+        track.index = objects[o].index;
+        track.confidence = objects[o].confidence;
+        track.hits = 1;
+        track.missed = 0;
+        track.timestamp = timestamp;
+        track.vx = track.vy = track.vw = track.vh = 0.f;
+        tracks_.push_back(track);
+
+        objects[o].track_id = track.id;
+    }
+}
+
+void Tracker::extrapolate(int64_t timestamp, int64_t max_horizon_ns,
+                          std::vector<DetectedObject> &objects) const {
+    for (const Track &track: tracks_) {
+        if (track.missed > 0)
+            continue;
+
+        int64_t horizon = std::min(std::max(timestamp - track.timestamp, (int64_t) 0), max_horizon_ns);
+        float dt = horizon / 1e9f;
+
+        DetectedObject obj;
+        obj.rect.x = track.rect.x + track.vx * dt;
+        obj.rect.y = track.rect.y + track.vy * dt;
+        obj.rect.width = std::max(0.f, track.rect.width + track.vw * dt);
+        obj.rect.height = std::max(0.f, track.rect.height + track.vh * dt);
+        obj.index = track.index;
+        obj.confidence = track.confidence;
+        obj.track_id = track.id;
+        objects.push_back(obj);
+    }
+}
+
+bool Tracker::relabel(int from, int to) {
+    auto source = std::find_if(tracks_.begin(), tracks_.end(), [from](const Track &t) { return t.id == from; });
+    if (source == tracks_.end())
+        return false;
+
+    auto target = std::find_if(tracks_.begin(), tracks_.end(), [to](const Track &t) { return t.id == to; });
+    if (target != tracks_.end()) {
+        // the old track was seen in the same frame, it is a different object
+        if (target->missed == 0)
+            return false;
+        tracks_.erase(target);
+        source = std::find_if(tracks_.begin(), tracks_.end(), [from](const Track &t) { return t.id == from; });
+    }
+
+    source->id = to;
+    return true;
+}
+
+void Tracker::reset() {
+    tracks_.clear();
+    next_id_ = 1;
+}
+
+void Tracker::shed() {
+    tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), [](const Track &t) { return t.missed > 0; }),
+                  tracks_.end());
+    tracks_.shrink_to_fit();
+}
@@ -0,0 +1,57 @@
+//
+// Greedy IoU tracker assigning persistent ids to detections across frames.
+//
+
+#ifndef ANDROID_TRACKER_H
+#define ANDROID_TRACKER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "memory_budget.h"
+#include "ultralytics.h"
+
+struct Track {
+    int id;
+    Box rect;
+    int index;
+    float confidence;
+    int hits;
+    int missed;
+    int64_t timestamp;
+    // smoothed box velocity in normalized units per second
+    float vx, vy, vw, vh;
+};
+
+typedef CountedVector<Track, MEMORY_TRACKER> TrackList;
+
+class Tracker {
+public:
+    // Matches objects against the live tracks and writes the track id back into each object.
+    void update(std::vector<DetectedObject> &objects, int64_t timestamp);
+
+    // Appends the tracks seen in the last frame with their boxes moved to `timestamp` by a
+    // constant velocity model, extrapolating at most `max_horizon_ns` ahead.
+    void extrapolate(int64_t timestamp, int64_t max_horizon_ns, std::vector<DetectedObject> &objects) const;
+
+    // Gives track `from` the id `to`, replacing a lost track that still holds it.
+    bool relabel(int from, int to);
+
+    void reset();
+
+    // Drops the lost tracks kept for re-association and their spare capacity when memory is short.
+    void shed();
+
+    const TrackList &tracks() const { return tracks_; }
+
+    float iou_threshold = 0.3f;
+    int max_missed = 15;
+    // weight of the newest measurement in the velocity estimate
+    float velocity_smoothing = 0.5f;
+
+private:
+    TrackList tracks_;
+    int next_id_ = 1;
+};
+
+#endif //ANDROID_TRACKER_H
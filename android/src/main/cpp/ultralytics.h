@@ -5,12 +5,13 @@
 #ifndef ANDROID_ULTRALYTICS_H
 #define ANDROID_ULTRALYTICS_H
 
-#include <opencv2/core/core.hpp>
+#include "geometry.h"
 
 struct DetectedObject {
-    cv::Rect_<float> rect;
+    Box rect;
     int index;
     float confidence;
+    int track_id = -1;
 };
 
 #endif //ANDROID_ULTRALYTICS_H
@@ -0,0 +1,96 @@
+/*
+ * Stable C ABI for custom postprocessors running inside the native pipeline.
+ *
+ * A postprocessor turns the raw output tensors of a model into detections. It is either registered
+ * with ultralytics_register_postprocessor() by code loaded into the process, or exported by a
+ * shared library as ultralytics_get_postprocessor() and loaded by name from the plugin. The
+ * pipeline maps the detections back to the frame, then tracks and reports them like its own.
+ *
+ * Only plain C types cross the boundary. Structures only grow at their end, guarded by
+ * ULTRALYTICS_POSTPROCESSOR_ABI_VERSION.
+ */
+
+#ifndef ANDROID_ULTRALYTICS_POSTPROCESSOR_H
+#define ANDROID_ULTRALYTICS_POSTPROCESSOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ULTRALYTICS_POSTPROCESSOR_ABI_VERSION 1
+
+#define ULTRALYTICS_MAX_TENSOR_RANK 8
+
+#define ULTRALYTICS_EXPORT __attribute__((visibility("default")))
+
+typedef enum {
+    ULTRALYTICS_FLOAT32 = 0
+} UltralyticsTensorType;
+
+typedef struct {
+    const char *name;
+    int32_t type;
+    int32_t rank;
+    int32_t shape[ULTRALYTICS_MAX_TENSOR_RANK];
+} UltralyticsTensorDesc;
+
+/* A detection in the packed result format, the top left corner and size normalized to the model
+ * input. */
+typedef struct {
+    float x;
+    float y;
+    float width;
+    float height;
+    float confidence;
+    int32_t class_index;
+} UltralyticsDetection;
+
+typedef struct {
+    float confidence_threshold;
+    float iou_threshold;
+    int32_t max_detections;
+    int32_t input_width;
+    int32_t input_height;
+} UltralyticsPostprocessParams;
+
+/* Services of the pipeline, valid for the lifetime of the postprocessor state. */
+typedef struct {
+    uint32_t abi_version;
+    void *context;
+    /* Memory aligned to 64 bytes that stays valid until process() returns. Callable from any
+     * thread. */
+    void *(*scratch)(void *context, size_t bytes);
+    /* Runs fn(user, i) for every i in [0, n) on the shared thread pool and the calling thread.
+     * Must not be called from inside fn. */
+    void (*parallel_for)(void *context, int32_t n, void (*fn)(void *user, int32_t i), void *user);
+    int32_t num_threads;
+} UltralyticsHost;
+
+typedef struct {
+    uint32_t abi_version;
+    const char *name;
+    /* Prepares for the given output tensors and returns the state passed to the other functions,
+     * or NULL if the model is not supported. */
+    void *(*init)(const UltralyticsTensorDesc *outputs, int32_t num_outputs, const UltralyticsHost *host);
+    /* Decodes one frame from the outputs, in the order of init(), into at most `capacity`
+     * detections. Returns the number written, or a negative value on failure. */
+    int32_t (*process)(void *state, const void *const *outputs, const UltralyticsPostprocessParams *params,
+                       UltralyticsDetection *detections, int32_t capacity);
+    void (*destroy)(void *state);
+} UltralyticsPostprocessor;
+
+/* Makes a postprocessor selectable by its name. The structure must outlive the process. Returns
+ * 0 on success, -1 if it is invalid or of a newer ABI. */
+ULTRALYTICS_EXPORT int32_t ultralytics_register_postprocessor(const UltralyticsPostprocessor *postprocessor);
+
+/* Exported by postprocessor libraries. */
+typedef const UltralyticsPostprocessor *(*UltralyticsGetPostprocessor)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANDROID_ULTRALYTICS_POSTPROCESSOR_H */
@@ -0,0 +1,64 @@
+#include "zoom_controller.h"
+
+#include <algorithm>
+
+static Box fit_inside(Box r, const Box &bounds) {
+    r.width = std::min(r.width, bounds.width);
+    r.height = std::min(r.height, bounds.height);
+    r.x = std::min(std::max(r.x, bounds.x), bounds.x + bounds.width - r.width);
+    r.y = std::min(std::max(r.y, bounds.y), bounds.y + bounds.height - r.height);
+    return r;
+}
+
+Box ZoomController::next_crop(const TrackList &tracks, const Box &viewport) {
+    if (!enabled)
+        return viewport;
+
+    // confirmed tracks seen in the last frame
+    Box target_union;
+    bool any = false;
+    for (const Track &track: tracks) {
+        if (track.missed > 0 || track.hits < 2)
+            continue;
+
+        target_union = any ? (target_union | track.rect) : track.rect;
+        any = true;
+    }
+
+    frame_count_++;
+    if (!any) {
+        has_crop_ = false;
+        return viewport;
+    }
+    if (refresh_interval > 0 && frame_count_ % refresh_interval == 0)
+        return viewport;
+
+    // keep the viewport aspect ratio so objects are scaled the same way as in full frame mode
+    float scale = std::max(target_union.width * (1 + 2 * margin) / viewport.width,
+                           target_union.height * (1 + 2 * margin) / viewport.height);
+    scale = std::min(1.f, std::max(min_scale, scale));
+
+    Box target;
+    target.width = viewport.width * scale;
+    target.height = viewport.height * scale;
+    target.x = target_union.x + target_union.width / 2 - target.width / 2;
+    target.y = target_union.y + target_union.height / 2 - target.height / 2;
+    target = fit_inside(target, viewport);
+
+    if (!has_crop_) {
+        crop_ = target;
+        has_crop_ = true;
+    } else {
+        crop_.x += smoothing * (target.x - crop_.x);
+        crop_.y += smoothing * (target.y - crop_.y);
+        crop_.width += smoothing * (target.width - crop_.width);
+        crop_.height += smoothing * (target.height - crop_.height);
+        crop_ = fit_inside(crop_, viewport);
+    }
+    return crop_;
+}
+
+void ZoomController::reset() {
+    has_crop_ = false;
+    frame_count_ = 0;
+}
@@ -0,0 +1,36 @@
+//
+// Picks the region of the next frame fed to the model from the current tracks,
+// trading field of view for resolution on small distant objects.
+//
+
+#ifndef ANDROID_ZOOM_CONTROLLER_H
+#define ANDROID_ZOOM_CONTROLLER_H
+
+#include <vector>
+
+#include "tracker.h"
+
+class ZoomController {
+public:
+    // Returns the normalized crop for the next frame, always inside `viewport`.
+    Box next_crop(const TrackList &tracks, const Box &viewport);
+
+    void reset();
+
+    bool enabled = false;
+    // smallest crop allowed, as a fraction of the viewport size
+    float min_scale = 0.25f;
+    // space kept around the tracked objects, as a fraction of their union size
+    float margin = 0.5f;
+    // weight of the new target in the exponential smoothing
+    float smoothing = 0.3f;
+    // every n-th frame uses the whole viewport to pick up new objects
+    int refresh_interval = 10;
+
+private:
+    Box crop_;
+    bool has_crop_ = false;
+    int frame_count_ = 0;
+};
+
+#endif //ANDROID_ZOOM_CONTROLLER_H
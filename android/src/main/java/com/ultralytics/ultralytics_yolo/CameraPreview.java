@@ -24,26 +24,56 @@ import java.util.concurrent.ExecutionException;
 public class CameraPreview {
     public final static Size CAMERA_PREVIEW_SIZE = new Size(640, 480);
     private final Context context;
-    private Predictor predictor;
+    private final PipelineStartup startup;
+    // CameraX is initialized in the background from the start, while the model loads
+    private final ListenableFuture<ProcessCameraProvider> cameraProviderFuture;
+    private volatile Predictor predictor;
     private ProcessCameraProvider cameraProvider;
     private CameraControl cameraControl;
     private Activity activity;
     private PreviewView mPreviewView;
     private boolean busy = false;
+    private int viewWidth = 0;
+    private int viewHeight = 0;
 
-    public CameraPreview(Context context) {
+    public CameraPreview(Context context, PipelineStartup startup) {
         this.context = context;
+        this.startup = startup;
+        cameraProviderFuture = ProcessCameraProvider.getInstance(context);
     }
 
     public void openCamera(int facing, Activity activity, PreviewView mPreviewView) {
         this.activity = activity;
         this.mPreviewView = mPreviewView;
+        startup.beginCamera();
+        final long start = System.nanoTime();
+
+        // Only the visible part of each frame is fed to the predictor. A view laid out already
+        // reports no layout change until it is resized, so its current size is taken first
+        viewWidth = mPreviewView.getWidth();
+        viewHeight = mPreviewView.getHeight();
+        Predictor current = this.predictor;
+        if (current != null) {
+            current.setViewport(viewWidth, viewHeight);
+        }
+        mPreviewView.addOnLayoutChangeListener((v, left, top, right, bottom, oldLeft, oldTop, oldRight, oldBottom) -> {
+            viewWidth = right - left;
+            viewHeight = bottom - top;
+            Predictor predictor = this.predictor;
+            if (predictor != null) {
+                predictor.setViewport(viewWidth, viewHeight);
+            }
+        });
 
-        final ListenableFuture<ProcessCameraProvider> cameraProviderFuture = ProcessCameraProvider.getInstance(context);
         cameraProviderFuture.addListener(() -> {
             try {
                 cameraProvider = cameraProviderFuture.get();
+                startup.step("cameraProvider", System.nanoTime() - start);
+
+                long bindStart = System.nanoTime();
                 bindPreview(facing);
+                startup.step("cameraBind", System.nanoTime() - bindStart);
+                startup.cameraReady();
             } catch (ExecutionException | InterruptedException e) {
                 // No errors need to be handled for this Future.
                 // This should never be reached.
@@ -69,7 +99,11 @@ public class CameraPreview {
                             .setTargetAspectRatio(AspectRatio.RATIO_4_3)
                             .build();
             imageAnalysis.setAnalyzer(Runnable::run, imageProxy -> {
-                predictor.predict(imageProxy, facing == CameraSelector.LENS_FACING_FRONT);
+                // frames arriving before the model is loaded are skipped
+                Predictor predictor = this.predictor;
+                if (predictor != null) {
+                    predictor.predict(imageProxy, facing == CameraSelector.LENS_FACING_FRONT);
+                }
 
                 //clear stream for next image
                 imageProxy.close();
@@ -91,6 +125,7 @@ public class CameraPreview {
 
     public void setPredictorFrameProcessor(Predictor predictor) {
         this.predictor = predictor;
+        predictor.setViewport(viewWidth, viewHeight);
     }
 
     public void setCameraFacing(int facing) {
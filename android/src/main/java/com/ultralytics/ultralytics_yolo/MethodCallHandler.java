@@ -5,6 +5,8 @@ import static com.ultralytics.ultralytics_yolo.CameraPreview.CAMERA_PREVIEW_SIZE
 import android.content.Context;
 import android.graphics.Bitmap;
 import android.graphics.BitmapFactory;
+import android.os.Handler;
+import android.os.Looper;
 import android.util.DisplayMetrics;
 
 import androidx.annotation.NonNull;
@@ -24,6 +26,8 @@ import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
 import java.util.Objects;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 import io.flutter.plugin.common.BinaryMessenger;
 import io.flutter.plugin.common.EventChannel;
@@ -31,20 +35,32 @@ import io.flutter.plugin.common.MethodCall;
 import io.flutter.plugin.common.MethodChannel;
 
 public class MethodCallHandler implements MethodChannel.MethodCallHandler {
+    // in the order of the native memory stats
+    private static final String[] MEMORY_SUBSYSTEMS = {"frames", "tensors", "scratch", "tracker", "history", "caches"};
     private final Context context;
     private final CameraPreview cameraPreview;
     private Predictor predictor;
     private final ResultStreamHandler resultStreamHandler;
     private final InferenceTimeStreamHandler inferenceTimeStreamHandler;
     private final FpsRateStreamHandler fpsRateStreamHandler;
+    private final RuleEventStreamHandler ruleEventStreamHandler;
+    private final HeatmapStreamHandler heatmapStreamHandler;
+    private final MemoryStatsStreamHandler memoryStatsStreamHandler;
+    private final PipelineStartup startup;
+    // models load here while the camera comes up on the main thread
+    private final ExecutorService modelLoader = Executors.newSingleThreadExecutor();
+    private final Handler mainHandler = new Handler(Looper.getMainLooper());
+    private boolean resultStreamEnabled = true;
     private final float widthDp;
     private final float density;
     private final float heightDp;
 
-    public MethodCallHandler(BinaryMessenger binaryMessenger, Context context, CameraPreview cameraPreview) {
+    public MethodCallHandler(BinaryMessenger binaryMessenger, Context context, CameraPreview cameraPreview,
+                             PipelineStartup startup) {
         this.context = context;
 
         this.cameraPreview = cameraPreview;
+        this.startup = startup;
 
         EventChannel predictionResultEventChannel = new EventChannel(binaryMessenger, "ultralytics_yolo_prediction_results");
         resultStreamHandler = new ResultStreamHandler();
@@ -58,6 +74,22 @@ public class MethodCallHandler implements MethodChannel.MethodCallHandler {
         fpsRateStreamHandler = new FpsRateStreamHandler();
         fpsRateEventChannel.setStreamHandler(fpsRateStreamHandler);
 
+        EventChannel ruleEventChannel = new EventChannel(binaryMessenger, "ultralytics_yolo_rule_events");
+        ruleEventStreamHandler = new RuleEventStreamHandler();
+        ruleEventChannel.setStreamHandler(ruleEventStreamHandler);
+
+        EventChannel heatmapChannel = new EventChannel(binaryMessenger, "ultralytics_yolo_heatmap");
+        heatmapStreamHandler = new HeatmapStreamHandler();
+        heatmapChannel.setStreamHandler(heatmapStreamHandler);
+
+        EventChannel memoryStatsChannel = new EventChannel(binaryMessenger, "ultralytics_yolo_memory_stats");
+        memoryStatsStreamHandler = new MemoryStatsStreamHandler();
+        memoryStatsChannel.setStreamHandler(memoryStatsStreamHandler);
+
+        EventChannel pipelineReadyChannel = new EventChannel(binaryMessenger, "ultralytics_yolo_pipeline_ready");
+        PipelineReadyStreamHandler pipelineReadyStreamHandler = new PipelineReadyStreamHandler();
+        pipelineReadyChannel.setStreamHandler(pipelineReadyStreamHandler);
+        startup.setReadyCallback(pipelineReadyStreamHandler::sink);
 
         DisplayMetrics displayMetrics = context.getResources().getDisplayMetrics();
         int widthPixels = displayMetrics.widthPixels;
@@ -85,6 +117,63 @@ public class MethodCallHandler implements MethodChannel.MethodCallHandler {
             case "setNumItemsThreshold":
                 setNumItemsThreshold(call, result);
                 break;
+            case "setRules":
+                setRules(call, result);
+                break;
+            case "setRegionsOfInterest":
+                setRegionsOfInterest(call, result);
+                break;
+            case "setAutoCrop":
+                setAutoCrop(call, result);
+                break;
+            case "setLatencyCompensation":
+                setLatencyCompensation(call, result);
+                break;
+            case "extrapolateDetections":
+                extrapolateDetections(call, result);
+                break;
+            case "setReidModel":
+                setReidModel(call, result);
+                break;
+            case "setTrackHistory":
+                setTrackHistory(call, result);
+                break;
+            case "setSmoothing":
+                setSmoothing(call, result);
+                break;
+            case "getTrajectory":
+                getTrajectory(call, result);
+                break;
+            case "setHeatmap":
+                setHeatmap(call, result);
+                break;
+            case "setFrameBuffer":
+                setFrameBuffer(call, result);
+                break;
+            case "setMemoryBudget":
+                setMemoryBudget(call, result);
+                break;
+            case "saveFrames":
+                saveFrames(call, result);
+                break;
+            case "setFrameRecording":
+                setFrameRecording(call, result);
+                break;
+            case "setDetectionLog":
+                setDetectionLog(call, result);
+                break;
+            case "setPostprocessOptions":
+                setPostprocessOptions(call, result);
+                break;
+            case "setPostprocessor":
+                setPostprocessor(call, result);
+                break;
+            case "setRawOutputEnabled":
+                setRawOutputEnabled(call, result);
+                break;
+            case "setResultStreamEnabled":
+                setResultStreamEnabled(call, result);
+                break;
             case "detectImage":
                 detectImage(call, result);
                 break;
@@ -126,15 +215,11 @@ public class MethodCallHandler implements MethodChannel.MethodCallHandler {
         String type = (String) model.get("type");
         String task = (String) model.get("task");
         String format = (String) model.get("format");
-        if (Objects.equals(task, "detect")) {
-            if (Objects.equals(format, "tflite")) {
-                predictor = new TfliteDetector(context);
-            }
-        } else if (Objects.equals(task, "classify")) {
-            if (Objects.equals(format, "tflite")) {
-                predictor = new TfliteClassifier(context);
-            }
-        } else {
+        if (!Objects.equals(task, "detect") && !Objects.equals(task, "classify")) {
+            return;
+        }
+        if (!Objects.equals(format, "tflite")) {
+            result.error("PredictorError", "Invalid model", null);
             return;
         }
 
@@ -152,22 +237,40 @@ public class MethodCallHandler implements MethodChannel.MethodCallHandler {
                 break;
         }
 
-        try {
-            Object useGpuObject = call.argument("useGpu");
-            boolean useGpu = false;
-            if (useGpuObject != null) {
-                useGpu = (boolean) useGpuObject;
-            }
+        Object useGpuObject = call.argument("useGpu");
+        boolean useGpu = false;
+        if (useGpuObject != null) {
+            useGpu = (boolean) useGpuObject;
+        }
 
-            predictor.loadModel(yoloModel, true);
+        // The model is mapped, its interpreter built and warmed up in the background, the current
+        // predictor keeps running until the new one is ready
+        startup.beginModel();
+        final YoloModel loadedModel = yoloModel;
+        modelLoader.execute(() -> {
+            Predictor next = Objects.equals(task, "detect") ? new TfliteDetector(context) : new TfliteClassifier(context);
+            try {
+                next.loadModel(loadedModel, true);
+            } catch (Exception e) {
+                next.release();
+                mainHandler.post(() -> result.error("PredictorError", "Invalid model", null));
+                return;
+            }
 
-            setPredictorFrameProcessor();
-            setPredictorCallbacks();
+            mainHandler.post(() -> {
+                Predictor previous = predictor;
+                predictor = next;
+                setPredictorFrameProcessor();
+                setPredictorCallbacks();
+                if (previous != null) {
+                    previous.release();
+                }
 
-            result.success("Success");
-        } catch (Exception e) {
-            result.error("PredictorError", "Invalid model", null);
-        }
+                startup.steps(next.getLoadNanos());
+                startup.modelReady();
+                result.success("Success");
+            });
+        });
     }
 
     private void setPredictorFrameProcessor() {
@@ -182,34 +285,61 @@ public class MethodCallHandler implements MethodChannel.MethodCallHandler {
             final float offsetX = (widthDp - newWidth) / 2;
 
             ((Detector) predictor).setObjectDetectionResultCallback(result -> {
+                startup.onResult();
+                if (!resultStreamEnabled) return;
+
+                resultStreamHandler.sink(toObjectMaps(result, newWidth, offsetX));
+            });
+
+            ((Detector) predictor).setRuleEventCallback(events -> {
                 List<Map<String, Object>> objects = new ArrayList<>();
 
-                for (float[] obj : result) {
+                for (double[] event : events) {
                     Map<String, Object> objectMap = new HashMap<>();
 
-                    float x = obj[0] * newWidth + offsetX;
-                    float y = obj[1] * heightDp;
-                    float width = obj[2] * newWidth;
-                    float height = obj[3] * heightDp;
-                    float confidence = obj[4];
-                    int index = (int) obj[5];
+                    int index = (int) event[3];
                     String label = index < predictor.labels.size() ? predictor.labels.get(index) : "";
 
-                    objectMap.put("x", x);
-                    objectMap.put("y", y);
-                    objectMap.put("width", width);
-                    objectMap.put("height", height);
-                    objectMap.put("confidence", confidence);
+                    objectMap.put("ruleId", (int) event[0]);
+                    objectMap.put("type", (int) event[1]);
+                    objectMap.put("trackId", (int) event[2]);
                     objectMap.put("index", index);
                     objectMap.put("label", label);
+                    objectMap.put("timestamp", event[4]);
+                    objectMap.put("x", event[5]);
+                    objectMap.put("y", event[6]);
 
                     objects.add(objectMap);
                 }
 
-                resultStreamHandler.sink(objects);
+                ruleEventStreamHandler.sink(objects);
+            });
+
+            ((Detector) predictor).setHeatmapCallback((cells, width, height, peakSeconds) -> {
+                Map<String, Object> snapshot = new HashMap<>();
+                snapshot.put("cells", cells);
+                snapshot.put("width", width);
+                snapshot.put("height", height);
+                snapshot.put("peakSeconds", (double) peakSeconds);
+
+                heatmapStreamHandler.sink(snapshot);
+            });
+
+            ((Detector) predictor).setMemoryStatsCallback(stats -> {
+                Map<String, Object> bytes = new HashMap<>();
+                long total = 0;
+                for (int i = 0; i < MEMORY_SUBSYSTEMS.length; i++) {
+                    bytes.put(MEMORY_SUBSYSTEMS[i], stats[i]);
+                    total += stats[i];
+                }
+                bytes.put("total", total);
+                bytes.put("budget", stats[MEMORY_SUBSYSTEMS.length]);
+
+                memoryStatsStreamHandler.sink(bytes);
             });
         } else if (predictor instanceof Classifier) {
             ((Classifier) predictor).setClassificationResultCallback(result -> {
+                startup.onResult();
                 List<Map<String, Object>> objects = new ArrayList<>();
 
                 for (ClassificationResult classificationResult : result) {
@@ -229,6 +359,38 @@ public class MethodCallHandler implements MethodChannel.MethodCallHandler {
         predictor.setInferenceTimeCallback(inferenceTimeStreamHandler::sink);
     }
 
+    private List<Map<String, Object>> toObjectMaps(float[][] result, float newWidth, float offsetX) {
+        List<Map<String, Object>> objects = new ArrayList<>();
+
+        for (float[] obj : result) {
+            Map<String, Object> objectMap = new HashMap<>();
+
+            float x = obj[0] * newWidth + offsetX;
+            float y = obj[1] * heightDp;
+            float width = obj[2] * newWidth;
+            float height = obj[3] * heightDp;
+            float confidence = obj[4];
+            int index = (int) obj[5];
+            int trackId = (int) obj[6];
+            String label = index < predictor.labels.size() ? predictor.labels.get(index) : "";
+
+            objectMap.put("x", x);
+            objectMap.put("y", y);
+            objectMap.put("width", width);
+            objectMap.put("height", height);
+            objectMap.put("confidence", confidence);
+            objectMap.put("index", index);
+            objectMap.put("label", label);
+            if (trackId >= 0) {
+                objectMap.put("trackId", trackId);
+            }
+
+            objects.add(objectMap);
+        }
+
+        return objects;
+    }
+
     private void setConfidenceThreshold(MethodCall call, MethodChannel.Result result) {
         Object confidenceObject = call.argument("confidence");
         if (confidenceObject != null) {
@@ -253,6 +415,248 @@ public class MethodCallHandler implements MethodChannel.MethodCallHandler {
         }
     }
 
+    private void setRules(MethodCall call, MethodChannel.Result result) {
+        List<Map<String, Object>> rules = call.argument("rules");
+        if (rules != null && predictor instanceof Detector) {
+            float[][] rows = new float[rules.size()][];
+            for (int i = 0; i < rules.size(); i++) {
+                Map<String, Object> rule = rules.get(i);
+                List<Double> points = (List<Double>) rule.get("points");
+                int numPoints = points == null ? 0 : points.size();
+
+                float[] row = new float[4 + numPoints];
+                row[0] = ((Number) Objects.requireNonNull(rule.get("id"))).floatValue();
+                row[1] = ((Number) Objects.requireNonNull(rule.get("type"))).floatValue();
+                row[2] = ((Number) Objects.requireNonNull(rule.get("classIndex"))).floatValue();
+                row[3] = ((Number) Objects.requireNonNull(rule.get("dwellMs"))).floatValue();
+                for (int j = 0; j < numPoints; j++) {
+                    row[4 + j] = points.get(j).floatValue();
+                }
+                rows[i] = row;
+            }
+            ((Detector) predictor).setRules(rows);
+        }
+    }
+
+    private void setRegionsOfInterest(MethodCall call, MethodChannel.Result result) {
+        List<List<Double>> regions = call.argument("regions");
+        if (regions != null && predictor instanceof Detector) {
+            float[][] rows = new float[regions.size()][];
+            for (int i = 0; i < regions.size(); i++) {
+                List<Double> points = regions.get(i);
+                float[] row = new float[points.size()];
+                for (int j = 0; j < points.size(); j++) {
+                    row[j] = points.get(j).floatValue();
+                }
+                rows[i] = row;
+            }
+            ((Detector) predictor).setRegionsOfInterest(rows);
+        }
+    }
+
+    private void setAutoCrop(MethodCall call, MethodChannel.Result result) {
+        Object enabledObject = call.argument("enabled");
+        Object minScaleObject = call.argument("minScale");
+        Object refreshIntervalObject = call.argument("refreshInterval");
+        if (enabledObject != null && minScaleObject != null && refreshIntervalObject != null
+                && predictor instanceof Detector) {
+            final boolean enabled = (boolean) enabledObject;
+            final double minScale = (double) minScaleObject;
+            final int refreshInterval = (int) refreshIntervalObject;
+            ((Detector) predictor).setAutoCrop(enabled, (float) minScale, refreshInterval);
+        }
+    }
+
+    private void setLatencyCompensation(MethodCall call, MethodChannel.Result result) {
+        Object enabledObject = call.argument("enabled");
+        Object presentDelayObject = call.argument("presentDelayUs");
+        Object refreshObject = call.argument("refreshAtDisplayRate");
+        if (enabledObject != null && presentDelayObject != null && refreshObject != null
+                && predictor instanceof Detector) {
+            final long presentDelayNanos = ((Number) presentDelayObject).longValue() * 1000;
+            ((Detector) predictor).setLatencyCompensation((boolean) enabledObject, presentDelayNanos,
+                    (boolean) refreshObject);
+        }
+    }
+
+    private void extrapolateDetections(MethodCall call, MethodChannel.Result result) {
+        Object presentDelayObject = call.argument("presentDelayUs");
+        if (presentDelayObject != null && predictor instanceof Detector) {
+            final long presentDelayNanos = ((Number) presentDelayObject).longValue() * 1000;
+            float[][] res = ((Detector) predictor).extrapolate(presentDelayNanos);
+
+            float newWidth = heightDp * CAMERA_PREVIEW_SIZE.getHeight() / CAMERA_PREVIEW_SIZE.getWidth();
+            float offsetX = (widthDp - newWidth) / 2;
+            result.success(toObjectMaps(res, newWidth, offsetX));
+        }
+    }
+
+    private void setReidModel(MethodCall call, MethodChannel.Result result) {
+        String modelPath = call.argument("modelPath");
+        Object thresholdObject = call.argument("threshold");
+        Object capacityObject = call.argument("capacity");
+        if (thresholdObject != null && capacityObject != null && predictor instanceof Detector) {
+            try {
+                ((Detector) predictor).setReidModel(modelPath, (float) (double) thresholdObject,
+                        (int) capacityObject);
+                result.success("Success");
+            } catch (Exception e) {
+                result.error("PredictorError", "Invalid re-identification model", null);
+            }
+        }
+    }
+
+    private void setTrackHistory(MethodCall call, MethodChannel.Result result) {
+        Object memoryBudgetObject = call.argument("memoryBudget");
+        Object pointsPerTrackObject = call.argument("pointsPerTrack");
+        Object epsilonObject = call.argument("epsilon");
+        if (memoryBudgetObject != null && pointsPerTrackObject != null && epsilonObject != null
+                && predictor instanceof Detector) {
+            ((Detector) predictor).setTrackHistory(((Number) memoryBudgetObject).longValue(),
+                    (int) pointsPerTrackObject, (float) (double) epsilonObject);
+            result.success("Success");
+        }
+    }
+
+    private void setSmoothing(MethodCall call, MethodChannel.Result result) {
+        Object enabledObject = call.argument("enabled");
+        Object minCutoffObject = call.argument("minCutoff");
+        Object betaObject = call.argument("beta");
+        Object derivativeCutoffObject = call.argument("derivativeCutoff");
+        if (enabledObject != null && minCutoffObject != null && betaObject != null && derivativeCutoffObject != null
+                && predictor instanceof Detector) {
+            ((Detector) predictor).setSmoothing((boolean) enabledObject, (float) (double) minCutoffObject,
+                    (float) (double) betaObject, (float) (double) derivativeCutoffObject);
+            result.success("Success");
+        }
+    }
+
+    private void getTrajectory(MethodCall call, MethodChannel.Result result) {
+        Object trackIdObject = call.argument("trackId");
+        Object windowObject = call.argument("windowMs");
+        if (trackIdObject != null && windowObject != null && predictor instanceof Detector) {
+            final long windowNanos = ((Number) windowObject).longValue() * 1000000;
+            result.success(((Detector) predictor).getTrajectory((int) trackIdObject, windowNanos));
+        }
+    }
+
+    private void setHeatmap(MethodCall call, MethodChannel.Result result) {
+        Object widthObject = call.argument("width");
+        Object heightObject = call.argument("height");
+        Object halfLifeObject = call.argument("halfLifeMs");
+        Object snapshotIntervalObject = call.argument("snapshotIntervalMs");
+        if (widthObject != null && heightObject != null && halfLifeObject != null
+                && snapshotIntervalObject != null && predictor instanceof Detector) {
+            ((Detector) predictor).setHeatmap((int) widthObject, (int) heightObject,
+                    ((Number) halfLifeObject).longValue() * 1000000,
+                    ((Number) snapshotIntervalObject).longValue() * 1000000);
+            result.success("Success");
+        }
+    }
+
+    private void setMemoryBudget(MethodCall call, MethodChannel.Result result) {
+        Object bytesObject = call.argument("bytes");
+        Object statsIntervalObject = call.argument("statsIntervalMs");
+        if (bytesObject != null && statsIntervalObject != null && predictor instanceof Detector) {
+            ((Detector) predictor).setMemoryBudget(((Number) bytesObject).longValue(),
+                    ((Number) statsIntervalObject).longValue() * 1000000);
+            result.success("Success");
+        }
+    }
+
+    private void setFrameBuffer(MethodCall call, MethodChannel.Result result) {
+        Object memoryBudgetObject = call.argument("memoryBudget");
+        Object maxSideObject = call.argument("maxSide");
+        Object qualityObject = call.argument("quality");
+        if (memoryBudgetObject != null && maxSideObject != null && qualityObject != null
+                && predictor instanceof Detector) {
+            ((Detector) predictor).setFrameBuffer(((Number) memoryBudgetObject).longValue(),
+                    (int) maxSideObject, (int) qualityObject);
+            result.success("Success");
+        }
+    }
+
+    private void saveFrames(MethodCall call, MethodChannel.Result result) {
+        String directory = call.argument("directory");
+        Object windowObject = call.argument("windowMs");
+        if (directory != null && windowObject != null && predictor instanceof Detector) {
+            final long windowNanos = ((Number) windowObject).longValue() * 1000000;
+            result.success(((Detector) predictor).saveFrames(windowNanos, directory));
+        }
+    }
+
+    private void setFrameRecording(MethodCall call, MethodChannel.Result result) {
+        String path = call.argument("path");
+        if (predictor instanceof Detector) {
+            try {
+                ((Detector) predictor).setFrameRecording(path);
+                result.success("Success");
+            } catch (Exception e) {
+                result.error("PredictorError", "Could not create the frame recording", null);
+            }
+        }
+    }
+
+    private void setDetectionLog(MethodCall call, MethodChannel.Result result) {
+        String directory = call.argument("directory");
+        Object recordsPerSegmentObject = call.argument("recordsPerSegment");
+        Object maxSegmentsObject = call.argument("maxSegments");
+        if (recordsPerSegmentObject != null && maxSegmentsObject != null && predictor instanceof Detector) {
+            try {
+                ((Detector) predictor).setDetectionLog(directory, (int) recordsPerSegmentObject,
+                        (int) maxSegmentsObject);
+                result.success("Success");
+            } catch (Exception e) {
+                result.error("PredictorError", "Could not open the detection log", null);
+            }
+        }
+    }
+
+    private void setPostprocessOptions(MethodCall call, MethodChannel.Result result) {
+        Object perClassNmsObject = call.argument("perClassNms");
+        Object maxProposalsObject = call.argument("maxProposals");
+        List<Integer> classes = call.argument("classes");
+        if (perClassNmsObject != null && maxProposalsObject != null && predictor instanceof Detector) {
+            int[] classIndices = null;
+            if (classes != null) {
+                classIndices = new int[classes.size()];
+                for (int i = 0; i < classIndices.length; i++) {
+                    classIndices[i] = classes.get(i);
+                }
+            }
+            ((Detector) predictor).setPostprocessOptions((boolean) perClassNmsObject, (int) maxProposalsObject,
+                    classIndices);
+            result.success("Success");
+        }
+    }
+
+    private void setPostprocessor(MethodCall call, MethodChannel.Result result) {
+        String name = call.argument("name");
+        String library = call.argument("library");
+        if (predictor instanceof Detector) {
+            try {
+                ((Detector) predictor).setPostprocessor(name, library);
+                result.success("Success");
+            } catch (Exception e) {
+                result.error("PredictorError", "Could not use the postprocessor", null);
+            }
+        }
+    }
+
+    private void setRawOutputEnabled(MethodCall call, MethodChannel.Result result) {
+        Object enabledObject = call.argument("enabled");
+        if (enabledObject != null && predictor instanceof Detector) {
+            result.success(((Detector) predictor).setRawOutputEnabled((boolean) enabledObject));
+        }
+    }
+
+    private void setResultStreamEnabled(MethodCall call, MethodChannel.Result result) {
+        Object enabledObject = call.argument("enabled");
+        if (enabledObject != null) {
+            resultStreamEnabled = (boolean) enabledObject;
+        }
+    }
+
     private void setLensDirection(MethodCall call, MethodChannel.Result result) {
         Object directionObject = call.argument("direction");
         if (directionObject != null) {
@@ -0,0 +1,38 @@
+package com.ultralytics.ultralytics_yolo;
+
+import android.os.Handler;
+import android.os.Looper;
+
+import java.util.Map;
+
+import io.flutter.plugin.common.EventChannel;
+
+class PipelineReadyStreamHandler implements EventChannel.StreamHandler {
+    final private Handler handler = new Handler(Looper.getMainLooper());
+    private EventChannel.EventSink eventSink;
+
+    @Override
+    public void onListen(Object arguments, EventChannel.EventSink events) {
+        eventSink = events;
+    }
+
+    @Override
+    public void onCancel(Object arguments) {
+        eventSink = null;
+    }
+
+    public void sink(Map<String, Object> timings) {
+        handler.post(() -> {
+            if (eventSink != null) {
+                eventSink.success(timings);
+            }
+        });
+    }
+
+    public void close() {
+        if (eventSink != null) {
+            eventSink.endOfStream();
+            eventSink = null;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+package com.ultralytics.ultralytics_yolo;
+
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Times the startup of the live pipeline. The camera and the model come up concurrently, each step
+ * reports how long it took, and once both are ready the first result sends a single report with
+ * every step and the time to first detection.
+ */
+class PipelineStartup {
+    private final Map<String, Object> timings = new HashMap<>();
+    private long startNanos = 0;
+    private boolean cameraReady = false;
+    private boolean modelReady = false;
+    private volatile boolean waitingForResult = false;
+    private ReadyCallback readyCallback;
+
+    public synchronized void setReadyCallback(ReadyCallback callback) {
+        readyCallback = callback;
+    }
+
+    /**
+     * Timing starts when the camera is opened or a model is requested, whichever comes first. A
+     * new model or camera once the pipeline is up starts it again, timing only that side.
+     */
+    private void begin() {
+        if (startNanos == 0 || !waitingForResult && cameraReady && modelReady) {
+            startNanos = System.nanoTime();
+            timings.clear();
+        }
+        waitingForResult = false;
+    }
+
+    public synchronized void beginCamera() {
+        begin();
+        cameraReady = false;
+    }
+
+    public synchronized void beginModel() {
+        begin();
+        modelReady = false;
+    }
+
+    public synchronized void step(String name, long nanos) {
+        timings.put(name, nanos / 1e6);
+    }
+
+    public synchronized void steps(Map<String, Long> nanos) {
+        for (Map.Entry<String, Long> entry : nanos.entrySet()) {
+            step(entry.getKey(), entry.getValue());
+        }
+    }
+
+    public synchronized void cameraReady() {
+        cameraReady = true;
+        timings.put("cameraReady", sinceStart());
+        waitingForResult = modelReady;
+    }
+
+    public synchronized void modelReady() {
+        modelReady = true;
+        timings.put("modelReady", sinceStart());
+        waitingForResult = cameraReady;
+    }
+
+    /**
+     * Called with every result, sends the report with the first one after the pipeline is ready.
+     */
+    public void onResult() {
+        if (!waitingForResult) {
+            return;
+        }
+        Map<String, Object> report;
+        ReadyCallback callback;
+        synchronized (this) {
+            if (!waitingForResult) {
+                return;
+            }
+            waitingForResult = false;
+            timings.put("firstDetection", sinceStart());
+            report = new HashMap<>(timings);
+            callback = readyCallback;
+        }
+        if (callback != null) {
+            callback.onReady(report);
+        }
+    }
+
+    private double sinceStart() {
+        return (System.nanoTime() - startNanos) / 1e6;
+    }
+
+    public interface ReadyCallback {
+        void onReady(Map<String, Object> timings);
+    }
+}
@@ -25,11 +25,12 @@ public class UltralyticsYoloPlugin implements FlutterPlugin, ActivityAware {
         BinaryMessenger binaryMessenger = flutterPluginBinding.getBinaryMessenger();
         Context context = flutterPluginBinding.getApplicationContext();
 
-        cameraPreview = new CameraPreview(context);
+        PipelineStartup startup = new PipelineStartup();
+        cameraPreview = new CameraPreview(context, startup);
 
         MethodCallHandler methodCallHandler = new MethodCallHandler(
                 binaryMessenger,
-                context, cameraPreview);
+                context, cameraPreview, startup);
         new MethodChannel(binaryMessenger, "ultralytics_yolo")
                 .setMethodCallHandler(methodCallHandler);
     }
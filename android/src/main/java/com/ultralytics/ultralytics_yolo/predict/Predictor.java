@@ -3,6 +3,9 @@ package com.ultralytics.ultralytics_yolo.predict;
 import android.content.Context;
 import android.content.res.AssetManager;
 import android.graphics.Bitmap;
+import android.os.Handler;
+import android.os.Looper;
+import android.util.Log;
 
 import androidx.annotation.Keep;
 import androidx.camera.core.ImageProxy;
@@ -18,22 +21,75 @@ import java.nio.file.Paths;
 import java.util.ArrayList;
 import java.util.List;
 import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.FutureTask;
 
 public abstract class Predictor {
-public static  int INPUT_SIZE = 320;
         protected final Context context;
+    // side of the square model input, from the metadata of the model this predictor loads
+    protected int inputSize = 320;
     public final ArrayList<String> labels = new ArrayList<>();
 
+    // time System.loadLibrary took, to compare the library built with and without OpenCV
+    public static final long LIBRARY_LOAD_NANOS;
+
     static {
+        long start = System.nanoTime();
         System.loadLibrary("ultralytics");
+        LIBRARY_LOAD_NANOS = System.nanoTime() - start;
+        Log.i("Predictor", String.format("libultralytics loaded in %.2f ms", LIBRARY_LOAD_NANOS / 1e6));
     }
 
+    // nanoseconds taken by each step of the last loadModel, for the startup report
+    protected final Map<String, Long> loadNanos = new ConcurrentHashMap<>();
+
     protected Predictor(Context context) {
         this.context = context;
     }
 
+    /**
+     * Loads the model and warms it up. Safe to call off the main thread, the steps bound to the
+     * inference thread are run there.
+     */
     public abstract void loadModel(YoloModel yoloModel, boolean useGpu) throws Exception;
 
+    public Map<String, Long> getLoadNanos() {
+        return loadNanos;
+    }
+
+    /**
+     * Parses the metadata on its own thread, while the caller maps the model and builds the
+     * interpreter.
+     */
+    protected FutureTask<Void> loadLabelsAsync(AssetManager assetManager, String metadataPath) {
+        FutureTask<Void> task = new FutureTask<>(() -> {
+            long start = System.nanoTime();
+            loadLabels(assetManager, metadataPath);
+            loadNanos.put("labels", System.nanoTime() - start);
+            return null;
+        });
+        new Thread(task, "ultralytics-labels").start();
+        return task;
+    }
+
+    /**
+     * Runs a load step and times it. Steps touching a GPU interpreter run on the main thread, as a
+     * GPU delegate must be used on the thread that created it: camera frames are preprocessed on
+     * CameraX's analysis thread, but predict(ImageProxy) posts each interpreter call to the main
+     * looper.
+     */
+    protected void loadStep(String name, boolean onMainThread, Runnable step) throws Exception {
+        long start = System.nanoTime();
+        if (!onMainThread || Looper.myLooper() == Looper.getMainLooper()) {
+            step.run();
+        } else {
+            FutureTask<Void> task = new FutureTask<>(step, null);
+            new Handler(Looper.getMainLooper()).post(task);
+            task.get();
+        }
+        loadNanos.put(name, System.nanoTime() - start);
+    }
+
     protected void loadLabels(AssetManager assetManager, String metadataPath) throws IOException {
         InputStream inputStream;
         Yaml yaml = new Yaml();
@@ -53,8 +109,8 @@ public static  int INPUT_SIZE = 320;
         List<Integer> imgszArray = (List<Integer>) data.get("imgsz");    
         if(imgszArray!=null&&imgszArray.size()==2){
             
-            INPUT_SIZE = imgszArray.get(0)>=imgszArray.get(1)?imgszArray.get(0):imgszArray.get(1);
-            System.out.println("INPUT_SIZE:"+ INPUT_SIZE);
+            inputSize = imgszArray.get(0)>=imgszArray.get(1)?imgszArray.get(0):imgszArray.get(1);
+            System.out.println("INPUT_SIZE:"+ inputSize);
         }  
 
         labels.clear();
@@ -73,6 +129,19 @@ public static  int INPUT_SIZE = 320;
 
     public abstract void setFpsRateCallback(FloatResultCallback callback);
 
+    /**
+     * Updates the size of the view the camera frames are displayed in, so that only the visible
+     * part of each frame is used as input.
+     */
+    public void setViewport(int viewWidth, int viewHeight) {
+    }
+
+    /**
+     * Frees the native resources held by this predictor.
+     */
+    public void release() {
+    }
+
     public interface FloatResultCallback {
         @Keep()
         void onResult(float result);
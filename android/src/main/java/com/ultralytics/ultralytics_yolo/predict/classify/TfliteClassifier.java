@@ -1,19 +1,14 @@
 package com.ultralytics.ultralytics_yolo.predict.classify;
 
-import static com.ultralytics.ultralytics_yolo.CameraPreview.CAMERA_PREVIEW_SIZE;
-
 import android.content.Context;
 import android.content.res.AssetFileDescriptor;
 import android.content.res.AssetManager;
 import android.graphics.Bitmap;
-import android.graphics.Canvas;
-import android.graphics.Matrix;
 import android.os.Handler;
 import android.os.Looper;
 
 import androidx.camera.core.ImageProxy;
 
-import com.ultralytics.ultralytics_yolo.ImageUtils;
 import com.ultralytics.ultralytics_yolo.predict.PredictorException;
 import com.ultralytics.ultralytics_yolo.models.LocalYoloModel;
 import com.ultralytics.ultralytics_yolo.models.YoloModel;
@@ -33,32 +28,41 @@ import java.util.ArrayList;
 import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
-import java.util.stream.Collectors;
+import java.util.concurrent.FutureTask;
+import java.util.concurrent.atomic.AtomicBoolean;
 
 public class TfliteClassifier extends Classifier {
 
+    static {
+        System.loadLibrary("ultralytics");
+    }
+
     private static final long FPS_INTERVAL_MS = 1000; // Update FPS every 1000 milliseconds (1 second)
     private static final int NUM_BYTES_PER_CHANNEL = 4;
+    // input of the camera analysis, the image is rotated to portrait
+    private static final int INPUT_ROTATION = 90;
     private final Handler handler = new Handler(Looper.getMainLooper());
     private long lastFpsTime = System.currentTimeMillis();
     private int frameCount = 0;
     private Interpreter interpreter;
-    private Object[] inputArray;
+    private ByteBuffer inputBuffer;
+    // set from the camera thread filling inputBuffer until the main thread is done with it
+    private final AtomicBoolean inputBusy = new AtomicBoolean(false);
+    private ByteBuffer stillInput;
+    private ByteBuffer outputBuffer;
     private int outputShape2;
     private Map<Integer, Object> outputMap;
+    // 0 once released, the native side ignores calls made with it
+    private volatile long nativeHandle;
+    // held around every native call and while the handle is replaced, so that the camera thread
+    // never uses a handle after it is released
+    private final Object nativeLock = new Object();
     private ClassificationResultCallback classificationResultCallback;
     private FloatResultCallback inferenceTimeCallback;
     private FloatResultCallback fpsRateCallback;
-    private final Matrix transformationMatrix;
-    private final Bitmap pendingBitmapFrame;
 
     public TfliteClassifier(Context context) {
         super(context);
-
-        pendingBitmapFrame = Bitmap.createBitmap(INPUT_SIZE, INPUT_SIZE, Bitmap.Config.ARGB_8888);
-        transformationMatrix = ImageUtils.getTransformationMatrix(CAMERA_PREVIEW_SIZE.getWidth(), CAMERA_PREVIEW_SIZE.getHeight(),
-                INPUT_SIZE, INPUT_SIZE,
-                90, false);
     }
 
     @Override
@@ -82,22 +86,44 @@ public class TfliteClassifier extends Classifier {
             }
 
             final AssetManager assetManager = context.getAssets();
-            loadLabels(assetManager, localYoloModel.metadataPath);
+            loadNanos.clear();
+            FutureTask<Void> labelsTask = loadLabelsAsync(assetManager, localYoloModel.metadataPath);
+            final CompatibilityList gpu = gpuCompatibility(useGpu);
             try {
+                long start = System.nanoTime();
                 MappedByteBuffer modelFile = loadModelFile(assetManager, localYoloModel.modelPath);
-                initDelegate(modelFile, useGpu);
+                loadNanos.put("modelMap", System.nanoTime() - start);
+                loadStep("interpreter", gpu != null, () -> initDelegate(modelFile, gpu));
             } catch (Exception e) {
                 throw new PredictorException("Error model");
             }
+            // the input size comes with the metadata
+            labelsTask.get();
+            // preprocessing and ranking run natively, around the interpreter
+            long handle = nativeCreate(inputSize, outputShape2);
+            synchronized (nativeLock) {
+                if (nativeHandle != 0) {
+                    nativeRelease(nativeHandle);
+                }
+                nativeHandle = handle;
+            }
+            allocateBuffers();
+            loadStep("warmUp", gpu != null, this::warmUp);
         }
     }
 
     @Override
     public List<ClassificationResult> predict(Bitmap bitmap) {
         try {
-            Bitmap resizedBitmap = Bitmap.createScaledBitmap(bitmap, INPUT_SIZE, INPUT_SIZE, true);
-            setInput(resizedBitmap);
-            return runInference();
+            Bitmap resizedBitmap = Bitmap.createScaledBitmap(bitmap, inputSize, inputSize, true);
+            int[] pixels = new int[inputSize * inputSize];
+            resizedBitmap.getPixels(pixels, 0, inputSize, 0, 0, inputSize, inputSize);
+            synchronized (nativeLock) {
+                if (!nativePreprocessBitmap(nativeHandle, pixels, stillInput)) {
+                    return new ArrayList<>();
+                }
+            }
+            return runInference(stillInput);
         } catch (Exception e) {
             return new ArrayList<>();
         }
@@ -117,12 +143,34 @@ public class TfliteClassifier extends Classifier {
         fpsRateCallback = callback;
     }
 
-    private void initDelegate(MappedByteBuffer buffer, boolean useGpu) {
-        Interpreter.Options interpreterOptions = new Interpreter.Options();
+    @Override
+    public void release() {
+        synchronized (nativeLock) {
+            long handle = nativeHandle;
+            nativeHandle = 0;
+            if (handle != 0) {
+                nativeRelease(handle);
+            }
+        }
+    }
+
+    // the device's GPU compatibility when the GPU is requested and supported, null for the CPU
+    private static CompatibilityList gpuCompatibility(boolean useGpu) {
+        if (!useGpu) {
+            return null;
+        }
         try {
-            // Check if GPU support is available
             CompatibilityList compatibilityList = new CompatibilityList();
-            if (useGpu && compatibilityList.isDelegateSupportedOnThisDevice()) {
+            return compatibilityList.isDelegateSupportedOnThisDevice() ? compatibilityList : null;
+        } catch (Exception e) {
+            return null;
+        }
+    }
+
+    private void initDelegate(MappedByteBuffer buffer, CompatibilityList compatibilityList) {
+        Interpreter.Options interpreterOptions = new Interpreter.Options();
+        try {
+            if (compatibilityList != null) {
                 GpuDelegateFactory.Options delegateOptions = compatibilityList.getBestOptionsForThisDevice();
                 GpuDelegate gpuDelegate = new GpuDelegate(delegateOptions.setQuantizedModelsAllowed(true));
                 interpreterOptions.addDelegate(gpuDelegate);
@@ -162,21 +210,31 @@ public class TfliteClassifier extends Classifier {
     }
 
     public void predict(ImageProxy imageProxy, boolean isMirrored) {
-        if (interpreter == null || imageProxy == null) {
+        if (interpreter == null || imageProxy == null || nativeHandle == 0) {
             return;
         }
 
-        Bitmap bitmap = ImageUtils.toBitmap(imageProxy);
-        Canvas canvas = new Canvas(pendingBitmapFrame);
-        Matrix cropToFrameTransform = new Matrix();
-        transformationMatrix.invert(cropToFrameTransform);
-        canvas.drawBitmap(bitmap, transformationMatrix, null);
+        // the whole frame, converted while the camera still holds it, dropped while the input is busy
+        if (!inputBusy.compareAndSet(false, true)) {
+            return;
+        }
+        ImageProxy.PlaneProxy[] planes = imageProxy.getPlanes();
+        boolean preprocessed;
+        synchronized (nativeLock) {
+            preprocessed = nativePreprocessFrame(nativeHandle, planes[0].getBuffer(), planes[1].getBuffer(),
+                    planes[2].getBuffer(), planes[0].getRowStride(), planes[1].getRowStride(),
+                    planes[1].getPixelStride(), imageProxy.getWidth(), imageProxy.getHeight(), INPUT_ROTATION,
+                    inputBuffer);
+        }
+        if (!preprocessed) {
+            inputBusy.set(false);
+            return;
+        }
 
         handler.post(() -> {
-            setInput(pendingBitmapFrame);
-
             long start = System.currentTimeMillis();
-            List<ClassificationResult> result = runInference();
+            List<ClassificationResult> result = runInference(inputBuffer);
+            inputBusy.set(false);
             long end = System.currentTimeMillis();
 
             // Increment frame count
@@ -201,67 +259,57 @@ public class TfliteClassifier extends Classifier {
         });
     }
 
-    private void setInput(Bitmap resizedbitmap) {
-        ByteBuffer imgData = ByteBuffer.allocateDirect(1 * INPUT_SIZE * INPUT_SIZE * 3 * NUM_BYTES_PER_CHANNEL);
-        int[] intValues = new int[INPUT_SIZE * INPUT_SIZE];
-
-        resizedbitmap.getPixels(intValues, 0, resizedbitmap.getWidth(), 0, 0, resizedbitmap.getWidth(), resizedbitmap.getHeight());
-
-        imgData.order(ByteOrder.nativeOrder());
-        imgData.rewind();
-        for (int i = 0; i < INPUT_SIZE; ++i) {
-            for (int j = 0; j < INPUT_SIZE; ++j) {
-                int pixelValue = intValues[i * INPUT_SIZE + j];
-                float r = (((pixelValue >> 16) & 0xFF)) / 255.0f;
-                float g = (((pixelValue >> 8) & 0xFF)) / 255.0f;
-                float b = ((pixelValue & 0xFF)) / 255.0f;
-                imgData.putFloat(r);
-                imgData.putFloat(g);
-                imgData.putFloat(b);
-            }
-        }
-        this.inputArray = new Object[]{imgData};
-        this.outputMap = new HashMap<>();
-        ByteBuffer outData = ByteBuffer.allocateDirect(outputShape2 * NUM_BYTES_PER_CHANNEL);
-        outData.order(ByteOrder.nativeOrder());
-        outData.rewind();
-        outputMap.put(0, outData);
+    private void allocateBuffers() {
+        int inputBytes = inputSize * inputSize * 3 * NUM_BYTES_PER_CHANNEL;
+        inputBuffer = ByteBuffer.allocateDirect(inputBytes).order(ByteOrder.nativeOrder());
+        stillInput = ByteBuffer.allocateDirect(inputBytes).order(ByteOrder.nativeOrder());
+        outputBuffer = ByteBuffer.allocateDirect(outputShape2 * NUM_BYTES_PER_CHANNEL).order(ByteOrder.nativeOrder());
+        outputMap = new HashMap<>();
+        outputMap.put(0, outputBuffer);
     }
 
-    private List<ClassificationResult> runInference() {
-        List<ClassificationResult> classificationResults = new ArrayList<>();
-
-        if (interpreter != null) {
-            interpreter.runForMultipleInputsOutputs(inputArray, outputMap);
-
-            ByteBuffer byteBuffer = (ByteBuffer) outputMap.get(0);
-            if (byteBuffer != null) {
-                byteBuffer.rewind();
-
-                final List<HashMap<String, Object>> list = new ArrayList<>();
-                for (int j = 0; j < outputShape2; ++j) {
-                    final HashMap<String, Object> map = new HashMap<>();
-                    float confidence = byteBuffer.getFloat();
-                    String label = labels.get(j);
+    // One inference on the blank still input, so tensors are allocated and the delegate is ready
+    // before the first camera frame
+    private void warmUp() {
+        stillInput.rewind();
+        outputBuffer.rewind();
+        interpreter.runForMultipleInputsOutputs(new Object[]{stillInput}, outputMap);
+    }
 
-                    map.put("index", j);
-                    map.put("label", label);
-                    map.put("confidence", confidence);
-                    list.add(map);
-                }
+    private List<ClassificationResult> runInference(ByteBuffer input) {
+        List<ClassificationResult> classificationResults = new ArrayList<>();
 
-                classificationResults = list.stream()
-                        .sorted((map1, map2) -> {
-                            float confidence1 = (float) map1.get("confidence");
-                            float confidence2 = (float) map2.get("confidence");
-                            return Float.compare(confidence2, confidence1);
-                        })
-                        .map(map -> new ClassificationResult((String) map.get("label"), (int) map.get("index"), (float) map.get("confidence")))
-                        .collect(Collectors.toList());
+        if (interpreter != null && nativeHandle != 0) {
+            input.rewind();
+            outputBuffer.rewind();
+            interpreter.runForMultipleInputsOutputs(new Object[]{input}, outputMap);
 
+            // [class, confidence] pairs, most confident first
+            float[] ranked;
+            synchronized (nativeLock) {
+                ranked = nativeClassify(nativeHandle, outputBuffer, 0);
+            }
+            if (ranked == null) {
+                return classificationResults;
+            }
+            for (int i = 0; i + 1 < ranked.length; i += 2) {
+                int index = (int) ranked[i];
+                classificationResults.add(new ClassificationResult(labels.get(index), index, ranked[i + 1]));
             }
         }
 
         return classificationResults;
     }
+
+    private native long nativeCreate(int inputSize, int numClasses);
+
+    private native void nativeRelease(long handle);
+
+    private native boolean nativePreprocessFrame(long handle, ByteBuffer y, ByteBuffer u, ByteBuffer v,
+                                                 int yRowStride, int uvRowStride, int uvPixelStride,
+                                                 int width, int height, int rotation, ByteBuffer input);
+
+    private native boolean nativePreprocessBitmap(long handle, int[] pixels, ByteBuffer input);
+
+    private native float[] nativeClassify(long handle, ByteBuffer output, int topK);
 }
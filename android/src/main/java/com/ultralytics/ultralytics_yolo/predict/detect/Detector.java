@@ -4,6 +4,8 @@ import android.content.Context;
 
 import androidx.annotation.Keep;
 
+import java.io.IOException;
+
 import com.ultralytics.ultralytics_yolo.predict.Predictor;
 
 public abstract class Detector extends Predictor {
@@ -17,8 +19,156 @@ public abstract class Detector extends Predictor {
 
     public abstract void setNumItemsThreshold(int numItems);
 
+    /**
+     * Selects per-class instead of class agnostic NMS, caps the proposals entering NMS to the
+     * maxProposals most confident ones (all when 0), and reports only the given classes (all
+     * when null).
+     */
+    public abstract void setPostprocessOptions(boolean perClassNms, int maxProposals, int[] classes);
+
+    /**
+     * Replaces the zone and line rules evaluated on the tracked objects. Each row is
+     * [id, type, class index, dwell ms, x0, y0, x1, y1, ...] in normalized coordinates.
+     */
+    public abstract void setRules(float[][] rules);
+
+    public abstract void setRuleEventCallback(RuleEventCallback callback);
+
+    /**
+     * Restricts decoding to the anchors whose center lies inside one of the polygons. Each row is
+     * [x0, y0, x1, y1, ...] in normalized coordinates, an empty array decodes every anchor.
+     */
+    public abstract void setRegionsOfInterest(float[][] regions);
+
+    /**
+     * Runs inference on a window around the tracked objects instead of the whole visible frame.
+     * The window never shrinks below minScale of the visible frame, and every refreshInterval
+     * frames the whole visible frame is used again to pick up new objects.
+     */
+    public abstract void setAutoCrop(boolean enabled, float minScale, int refreshInterval);
+
+    /**
+     * Extrapolates the reported boxes to the time they are expected to be displayed, presentDelay
+     * after they are produced. With refreshAtDisplayRate, extrapolated boxes are also reported on
+     * every display frame between inference results.
+     */
+    public abstract void setLatencyCompensation(boolean enabled, long presentDelayNanos, boolean refreshAtDisplayRate);
+
+    /**
+     * Returns the tracked boxes extrapolated to presentDelay from now, in the same layout as the
+     * detection results.
+     */
+    public abstract float[][] extrapolate(long presentDelayNanos);
+
+    /**
+     * Loads an appearance embedding model used to re-identify tracks lost after an occlusion,
+     * or disables re-identification when modelPath is null. A new track takes over the id of a
+     * lost track when the cosine similarity of their embeddings reaches threshold.
+     */
+    public abstract void setReidModel(String modelPath, float threshold, int capacity) throws IOException;
+
+    /**
+     * Keeps the trajectories of tracked objects within memoryBudget bytes, at most pointsPerTrack
+     * points each. Points closer than epsilon to the simplified trajectory are dropped. A zero
+     * budget disables the history.
+     */
+    public abstract void setTrackHistory(long memoryBudget, int pointsPerTrack, float epsilon);
+
+    /**
+     * Smooths the reported boxes of each object with a One Euro filter. minCutoff in Hz is the
+     * smoothing at rest, beta how fast it gives way to movement, derivativeCutoff in Hz filters
+     * the speed estimate.
+     */
+    public abstract void setSmoothing(boolean enabled, float minCutoff, float beta, float derivativeCutoff);
+
+    /**
+     * Returns the trajectory of a track over the last window, oldest point first, packed as
+     * {int16 x, int16 y, uint32 age in ms} records in native byte order with coordinates scaled
+     * to [0, 32767].
+     */
+    public abstract byte[] getTrajectory(int trackId, long windowNanos);
+
+    /**
+     * Accumulates how long objects stand on each cell of a width x height grid over the frame,
+     * with the heat halving every halfLife. Every snapshotInterval the grid is reported to the
+     * heatmap callback. A zero sized grid disables the heatmap.
+     */
+    public abstract void setHeatmap(int width, int height, long halfLifeNanos, long snapshotIntervalNanos);
+
+    public abstract void setHeatmapCallback(HeatmapCallback callback);
+
+    /**
+     * Sets the bytes the native subsystems of all detectors together should stay under. Above it
+     * they shed caches and capacity between frames. Zero removes the limit. Every statsInterval
+     * the bytes held by each subsystem are reported to the memory stats callback.
+     */
+    public abstract void setMemoryBudget(long bytes, long statsIntervalNanos);
+
+    public abstract void setMemoryStatsCallback(MemoryStatsCallback callback);
+
+    /**
+     * Keeps the recent camera frames, scaled to at most maxSide pixels and JPEG encoded with
+     * quality in the background, until they take up memoryBudget bytes. A zero budget disables
+     * the buffer.
+     */
+    public abstract void setFrameBuffer(long memoryBudget, int maxSide, int quality);
+
+    /**
+     * Writes the buffered frames from the last window and their detections into directory
+     * without blocking, and returns the number of frames that will be written.
+     */
+    public abstract int saveFrames(long windowNanos, String directory);
+
+    /**
+     * Records the raw camera frames with their timestamps to path, for replaying the session
+     * through the native pipeline on a host. A null path stops the recording.
+     */
+    public abstract void setFrameRecording(String path) throws IOException;
+
+    /**
+     * Appends every live detection as a fixed size binary record to memory-mapped log segments
+     * in directory, each holding recordsPerSegment records. Only the newest maxSegments segments
+     * are kept, all of them when it is 0. A null directory closes the log.
+     */
+    public abstract void setDetectionLog(String directory, int recordsPerSegment, int maxSegments) throws IOException;
+
+    /**
+     * Lets the interpreter write the raw output tensor of live frames into native slots that Dart
+     * maps through dart:ffi. Returns the id to acquire the slots with, 0 when disabled.
+     */
+    public abstract long setRawOutputEnabled(boolean enabled);
+
+    /**
+     * Decodes the model output with the native postprocessor registered as name, after loading
+     * the shared library if it is not null. A null name goes back to the built-in decoding.
+     */
+    public abstract void setPostprocessor(String name, String library);
+
     public interface ObjectDetectionResultCallback {
         @Keep()
         void onResult(float[][] detections);
     }
+
+    public interface RuleEventCallback {
+        @Keep()
+        void onResult(double[][] events);
+    }
+
+    public interface HeatmapCallback {
+        /**
+         * cells holds width x height values row by row, scaled so the hottest cell is 255, and
+         * peakSeconds is the heat of the hottest cell.
+         */
+        @Keep()
+        void onResult(byte[] cells, int width, int height, float peakSeconds);
+    }
+
+    public interface MemoryStatsCallback {
+        /**
+         * stats holds the bytes held by the frames, tensors, scratch, tracker, history and caches
+         * subsystems, followed by the budget.
+         */
+        @Keep()
+        void onResult(long[] stats);
+    }
 }
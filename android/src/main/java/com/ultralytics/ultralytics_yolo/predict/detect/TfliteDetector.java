@@ -6,10 +6,11 @@ import android.content.Context;
 import android.content.res.AssetFileDescriptor;
 import android.content.res.AssetManager;
 import android.graphics.Bitmap;
-import android.graphics.Canvas;
-import android.graphics.Matrix;
+import android.graphics.RectF;
 import android.os.Handler;
 import android.os.Looper;
+import android.os.SystemClock;
+import android.view.Choreographer;
 
 import androidx.camera.core.ImageProxy;
 
@@ -31,6 +32,8 @@ import java.nio.MappedByteBuffer;
 import java.nio.channels.FileChannel;
 import java.util.HashMap;
 import java.util.Map;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.FutureTask;
 
 
 public class TfliteDetector extends Detector {
@@ -41,32 +44,73 @@ public class TfliteDetector extends Detector {
 
     private static final long FPS_INTERVAL_MS = 1000; // Update FPS every 1000 milliseconds (1 second)
     private static final int NUM_BYTES_PER_CHANNEL = 4;
+    private static final RectF FULL_FRAME = new RectF(0, 0, 1, 1);
+    private static final long MAX_EXTRAPOLATION_NS = 250_000_000L;
+    private static final long CLOCK_MATCH_NS = 1_000_000_000L;
+    private static final int MAX_REID_CROPS_PER_FRAME = 2;
+    private static final int RAW_OUTPUT_SLOTS = 3; // OutputExchange::NUM_SLOTS
+    private static final int INPUT_BUFFERS = 2;
+    // input of the camera analysis, the image is rotated to portrait
+    private static final int INPUT_ROTATION = 90;
     private final Handler handler = new Handler(Looper.getMainLooper());
-    private final Matrix transformationMatrix;
-    private final Bitmap pendingBitmapFrame;
+    // region of the rotated camera frame fed to the model, boxes are mapped back to the full frame
+    // natively using the same region
+    private volatile RectF inputCrop = FULL_FRAME;
+    private volatile boolean autoCrop = false;
+    private volatile boolean frameBuffer = false;
+    private volatile boolean frameRecording = false;
+    private boolean latencyCompensation = false;
+    private boolean refreshAtDisplayRate = false;
+    private long presentDelayNanos = 0;
+    private final Choreographer.FrameCallback displayFrameCallback = this::onDisplayFrame;
+    private Interpreter reidInterpreter;
+    private int reidInputWidth;
+    private int reidInputHeight;
+    private ByteBuffer reidCrops;
+    private ByteBuffer reidOutput;
+    // model inputs filled on the camera thread, returned once the main thread is done with them
+    private final ArrayBlockingQueue<ByteBuffer> freeInputs = new ArrayBlockingQueue<>(INPUT_BUFFERS);
+    private ByteBuffer stillInput;
+    private ByteBuffer outputBuffer;
     private int numClasses;
     private int frameCount = 0;
     private double confidenceThreshold = 0.25f;
     private double iouThreshold = 0.45f;
     private int numItemsThreshold = 30;
+    private boolean perClassNms = false;
+    private int maxProposals = 0;
+    private int[] classFilter = null;
     private Interpreter interpreter;
-    private Object[] inputArray;
     private int outputShape2;
     private int outputShape3;
-    private float[][] output;
+    // native slots the interpreter writes into while the raw output is exposed to Dart
+    private volatile ByteBuffer[] rawOutputSlots;
     private long lastFpsTime = System.currentTimeMillis();
     private Map<Integer, Object> outputMap;
     private ObjectDetectionResultCallback objectDetectionResultCallback;
     private FloatResultCallback inferenceTimeCallback;
     private FloatResultCallback fpsRateCallback;
+    private RuleEventCallback ruleEventCallback;
+    private HeatmapCallback heatmapCallback;
+    private int heatmapWidth;
+    private int heatmapHeight;
+    private long heatmapSnapshotIntervalNanos;
+    private long lastHeatmapSnapshot;
+    private final float[] heatmapPeak = new float[1];
+    private MemoryStatsCallback memoryStatsCallback;
+    private long memoryStatsIntervalNanos;
+    private long lastMemoryStats;
+    // 0 once released, the native side ignores calls made with it
+    private volatile long nativeHandle;
+    // held around every native call and while the handle is freed, so that neither the camera
+    // thread nor the main thread ever uses a pipeline after it is deleted
+    private final Object nativeLock = new Object();
 
     public TfliteDetector(Context context) {
         super(context);
 
-        pendingBitmapFrame = Bitmap.createBitmap(INPUT_SIZE, INPUT_SIZE, Bitmap.Config.ARGB_8888);
-        transformationMatrix = ImageUtils.getTransformationMatrix(CAMERA_PREVIEW_SIZE.getWidth(), CAMERA_PREVIEW_SIZE.getHeight(),
-                INPUT_SIZE, INPUT_SIZE,
-                90, false);
+        nativeHandle = nativeCreate();
+        publishConfig();
     }
 
     @Override
@@ -80,23 +124,41 @@ public class TfliteDetector extends Detector {
             }
 
             final AssetManager assetManager = context.getAssets();
-            loadLabels(assetManager, localYoloModel.metadataPath);
-            numClasses = labels.size();
+            loadNanos.clear();
+            FutureTask<Void> labelsTask = loadLabelsAsync(assetManager, localYoloModel.metadataPath);
+            final CompatibilityList gpu = gpuCompatibility(useGpu);
             try {
+                long start = System.nanoTime();
                 MappedByteBuffer modelFile = loadModelFile(assetManager, localYoloModel.modelPath);
-                initDelegate(modelFile, useGpu);
+                loadNanos.put("modelMap", System.nanoTime() - start);
+                loadStep("interpreter", gpu != null, () -> initDelegate(modelFile, gpu));
             } catch (Exception e) {
                 throw new PredictorException("Error model");
             }
+            // the input size comes with the metadata
+            labelsTask.get();
+            numClasses = labels.size();
+            // preprocessing and decoding run natively, around the interpreter
+            synchronized (nativeLock) {
+                nativeSetModel(nativeHandle, inputSize, numClasses, outputShape3);
+            }
+            allocateBuffers();
+            loadStep("warmUp", gpu != null, this::warmUp);
         }
     }
 
     @Override
     public float[][] predict(Bitmap bitmap) {
         try {
-            Bitmap resizedBitmap = Bitmap.createScaledBitmap(bitmap, INPUT_SIZE, INPUT_SIZE, true);
-            setInput(resizedBitmap);
-            return runInference();
+            Bitmap resizedBitmap = Bitmap.createScaledBitmap(bitmap, inputSize, inputSize, true);
+            int[] pixels = new int[inputSize * inputSize];
+            resizedBitmap.getPixels(pixels, 0, inputSize, 0, 0, inputSize, inputSize);
+            synchronized (nativeLock) {
+                if (!nativePreprocessBitmap(nativeHandle, pixels, stillInput)) {
+                    return new float[0][];
+                }
+            }
+            return runInference(stillInput, FULL_FRAME, 0, false);
         } catch (Exception e) {
             return new float[0][];
         }
@@ -105,16 +167,231 @@ public class TfliteDetector extends Detector {
     @Override
     public void setConfidenceThreshold(float confidence) {
         this.confidenceThreshold = confidence;
+        publishConfig();
     }
 
     @Override
     public void setIouThreshold(float iou) {
         this.iouThreshold = iou;
+        publishConfig();
     }
 
     @Override
     public void setNumItemsThreshold(int numItems) {
         this.numItemsThreshold = numItems;
+        publishConfig();
+    }
+
+    @Override
+    public void setPostprocessOptions(boolean perClassNms, int maxProposals, int[] classes) {
+        this.perClassNms = perClassNms;
+        this.maxProposals = maxProposals;
+        this.classFilter = classes;
+        publishConfig();
+    }
+
+    /**
+     * Hands the settings to the native pipeline as one snapshot, which the inference thread
+     * picks up at its next frame without locking.
+     */
+    private synchronized void publishConfig() {
+        synchronized (nativeLock) {
+            nativeSetPostprocessConfig(nativeHandle, (float) confidenceThreshold, (float) iouThreshold,
+                    numItemsThreshold, perClassNms ? 1 : 0, maxProposals, classFilter);
+        }
+    }
+
+    @Override
+    public void setViewport(int viewWidth, int viewHeight) {
+        // The analysis frame is rotated 90° before being displayed
+        RectF visibleRegion = ImageUtils.getVisibleRegion(
+                CAMERA_PREVIEW_SIZE.getHeight(), CAMERA_PREVIEW_SIZE.getWidth(),
+                viewWidth, viewHeight);
+        inputCrop = visibleRegion;
+    }
+
+    @Override
+    public void setAutoCrop(boolean enabled, float minScale, int refreshInterval) {
+        synchronized (nativeLock) {
+            nativeSetAutoCrop(nativeHandle, enabled, minScale, refreshInterval);
+        }
+        autoCrop = enabled;
+    }
+
+    @Override
+    public void setLatencyCompensation(boolean enabled, long presentDelayNanos, boolean refreshAtDisplayRate) {
+        handler.post(() -> {
+            boolean wasRefreshing = latencyCompensation && this.refreshAtDisplayRate;
+            this.latencyCompensation = enabled;
+            this.presentDelayNanos = presentDelayNanos;
+            this.refreshAtDisplayRate = refreshAtDisplayRate;
+            if (enabled && refreshAtDisplayRate && !wasRefreshing) {
+                Choreographer.getInstance().postFrameCallback(displayFrameCallback);
+            }
+        });
+    }
+
+    @Override
+    public float[][] extrapolate(long presentDelayNanos) {
+        synchronized (nativeLock) {
+            if (nativeHandle == 0) {
+                return new float[0][];
+            }
+            return nativeExtrapolate(nativeHandle, System.nanoTime() + presentDelayNanos, MAX_EXTRAPOLATION_NS);
+        }
+    }
+
+    @Override
+    public void setReidModel(String modelPath, float threshold, int capacity) throws IOException {
+        if (reidInterpreter != null) {
+            reidInterpreter.close();
+            reidInterpreter = null;
+        }
+        if (modelPath == null) {
+            synchronized (nativeLock) {
+                nativeSetReid(nativeHandle, 0, 0, threshold);
+            }
+            return;
+        }
+
+        Interpreter.Options interpreterOptions = new Interpreter.Options();
+        interpreterOptions.setNumThreads(2);
+        Interpreter interpreter = new Interpreter(loadModelFile(context.getAssets(), modelPath), interpreterOptions);
+
+        // [1, height, width, 3] crops in, [1, dim] embedding out
+        int[] inputShape = interpreter.getInputTensor(0).shape();
+        int[] outputShape = interpreter.getOutputTensor(0).shape();
+        reidInputHeight = inputShape[1];
+        reidInputWidth = inputShape[2];
+        int dim = outputShape[outputShape.length - 1];
+
+        reidCrops = ByteBuffer.allocateDirect(MAX_REID_CROPS_PER_FRAME * reidInputWidth * reidInputHeight * 3 * NUM_BYTES_PER_CHANNEL);
+        reidCrops.order(ByteOrder.nativeOrder());
+        reidOutput = ByteBuffer.allocateDirect(dim * NUM_BYTES_PER_CHANNEL);
+        reidOutput.order(ByteOrder.nativeOrder());
+
+        synchronized (nativeLock) {
+            nativeSetReid(nativeHandle, dim, capacity, threshold);
+        }
+        reidInterpreter = interpreter;
+    }
+
+    @Override
+    public void setTrackHistory(long memoryBudget, int pointsPerTrack, float epsilon) {
+        synchronized (nativeLock) {
+            nativeSetTrackHistory(nativeHandle, memoryBudget, pointsPerTrack, epsilon);
+        }
+    }
+
+    @Override
+    public void setSmoothing(boolean enabled, float minCutoff, float beta, float derivativeCutoff) {
+        synchronized (nativeLock) {
+            nativeSetSmoothing(nativeHandle, enabled, minCutoff, beta, derivativeCutoff);
+        }
+    }
+
+    @Override
+    public byte[] getTrajectory(int trackId, long windowNanos) {
+        synchronized (nativeLock) {
+            if (nativeHandle == 0) {
+                return new byte[0];
+            }
+            return nativeGetTrajectory(nativeHandle, trackId, windowNanos);
+        }
+    }
+
+    @Override
+    public void setHeatmap(int width, int height, long halfLifeNanos, long snapshotIntervalNanos) {
+        synchronized (nativeLock) {
+            nativeSetHeatmap(nativeHandle, width, height, halfLifeNanos);
+        }
+        handler.post(() -> {
+            heatmapWidth = width;
+            heatmapHeight = height;
+            heatmapSnapshotIntervalNanos = snapshotIntervalNanos;
+        });
+    }
+
+    @Override
+    public void setMemoryBudget(long bytes, long statsIntervalNanos) {
+        nativeSetMemoryBudget(bytes);
+        memoryStatsIntervalNanos = statsIntervalNanos;
+    }
+
+    @Override
+    public void setFrameBuffer(long memoryBudget, int maxSide, int quality) {
+        synchronized (nativeLock) {
+            nativeSetFrameBuffer(nativeHandle, memoryBudget, maxSide, quality);
+        }
+        frameBuffer = memoryBudget > 0;
+    }
+
+    @Override
+    public int saveFrames(long windowNanos, String directory) {
+        long now = System.nanoTime();
+        synchronized (nativeLock) {
+            return nativeDumpFrames(nativeHandle, now - windowNanos, now, directory);
+        }
+    }
+
+    @Override
+    public void setFrameRecording(String path) throws IOException {
+        synchronized (nativeLock) {
+            if (!nativeSetRecording(nativeHandle, path)) {
+                throw new IOException("Could not create the recording " + path);
+            }
+        }
+        frameRecording = path != null;
+    }
+
+    @Override
+    public void setDetectionLog(String directory, int recordsPerSegment, int maxSegments) throws IOException {
+        synchronized (nativeLock) {
+            if (!nativeSetDetectionLog(nativeHandle, directory, recordsPerSegment, maxSegments)) {
+                throw new IOException("Could not open the detection log in " + directory);
+            }
+        }
+    }
+
+    @Override
+    public void setPostprocessor(String name, String library) {
+        synchronized (nativeLock) {
+            if (!nativeSetPostprocessor(nativeHandle, name, library, outputShape2, outputShape3)) {
+                throw new IllegalArgumentException("Could not use the postprocessor " + name);
+            }
+        }
+    }
+
+    @Override
+    public long setRawOutputEnabled(boolean enabled) {
+        synchronized (nativeLock) {
+            if (!enabled || nativeHandle == 0 || outputShape2 == 0) {
+                rawOutputSlots = null;
+                return 0;
+            }
+
+            long exchangeId = nativeSetRawOutput(nativeHandle, outputShape2, outputShape3);
+            ByteBuffer[] slots = new ByteBuffer[RAW_OUTPUT_SLOTS];
+            for (int i = 0; i < slots.length; i++) {
+                slots[i] = nativeRawOutputSlot(nativeHandle, i).order(ByteOrder.nativeOrder());
+            }
+            rawOutputSlots = slots;
+            return exchangeId;
+        }
+    }
+
+    @Override
+    public void setRules(float[][] rules) {
+        synchronized (nativeLock) {
+            nativeSetRules(nativeHandle, rules);
+        }
+    }
+
+    @Override
+    public void setRegionsOfInterest(float[][] regions) {
+        synchronized (nativeLock) {
+            nativeSetRegionsOfInterest(nativeHandle, regions);
+        }
     }
 
     @Override
@@ -132,6 +409,37 @@ public class TfliteDetector extends Detector {
         fpsRateCallback = callback;
     }
 
+    @Override
+    public void setRuleEventCallback(RuleEventCallback callback) {
+        ruleEventCallback = callback;
+    }
+
+    @Override
+    public void setHeatmapCallback(HeatmapCallback callback) {
+        heatmapCallback = callback;
+    }
+
+    @Override
+    public void setMemoryStatsCallback(MemoryStatsCallback callback) {
+        memoryStatsCallback = callback;
+    }
+
+    @Override
+    public void release() {
+        handler.post(() -> Choreographer.getInstance().removeFrameCallback(displayFrameCallback));
+        if (reidInterpreter != null) {
+            reidInterpreter.close();
+            reidInterpreter = null;
+        }
+        synchronized (nativeLock) {
+            long handle = nativeHandle;
+            nativeHandle = 0;
+            if (handle != 0) {
+                nativeRelease(handle);
+            }
+        }
+    }
+
     private MappedByteBuffer loadModelFile(AssetManager assetManager, String modelPath) throws IOException {
         // Local model from Flutter project
         if (modelPath.startsWith("flutter_assets")) {
@@ -151,12 +459,23 @@ public class TfliteDetector extends Detector {
         }
     }
 
-    private void initDelegate(MappedByteBuffer buffer, boolean useGpu) {
-        Interpreter.Options interpreterOptions = new Interpreter.Options();
+    // the device's GPU compatibility when the GPU is requested and supported, null for the CPU
+    private static CompatibilityList gpuCompatibility(boolean useGpu) {
+        if (!useGpu) {
+            return null;
+        }
         try {
-            // Check if GPU support is available
             CompatibilityList compatibilityList = new CompatibilityList();
-            if (useGpu && compatibilityList.isDelegateSupportedOnThisDevice()) {
+            return compatibilityList.isDelegateSupportedOnThisDevice() ? compatibilityList : null;
+        } catch (Exception e) {
+            return null;
+        }
+    }
+
+    private void initDelegate(MappedByteBuffer buffer, CompatibilityList compatibilityList) {
+        Interpreter.Options interpreterOptions = new Interpreter.Options();
+        try {
+            if (compatibilityList != null) {
                 GpuDelegateFactory.Options delegateOptions = compatibilityList.getBestOptionsForThisDevice();
                 GpuDelegate gpuDelegate = new GpuDelegate(delegateOptions.setQuantizedModelsAllowed(true));
                 interpreterOptions.addDelegate(gpuDelegate);
@@ -175,7 +494,6 @@ public class TfliteDetector extends Detector {
         int[] outputShape = interpreter.getOutputTensor(0).shape();
         outputShape2 = outputShape[1];
         outputShape3 = outputShape[2];
-        output = new float[outputShape2][outputShape3];
     }
 
     public void predict(ImageProxy imageProxy, boolean isMirrored) {
@@ -183,17 +501,50 @@ public class TfliteDetector extends Detector {
             return;
         }
 
-        Bitmap bitmap = ImageUtils.toBitmap(imageProxy);
-        Canvas canvas = new Canvas(pendingBitmapFrame);
-        Matrix cropToFrameTransform = new Matrix();
-        transformationMatrix.invert(cropToFrameTransform);
-        canvas.drawBitmap(bitmap, transformationMatrix, null);
+        final long timestamp = toNanoTime(imageProxy.getImageInfo().getTimestamp());
+        if (frameBuffer || frameRecording) {
+            ImageProxy.PlaneProxy[] planes = imageProxy.getPlanes();
+            synchronized (nativeLock) {
+                nativePushFrame(nativeHandle, planes[0].getBuffer(), planes[1].getBuffer(), planes[2].getBuffer(),
+                        planes[0].getRowStride(), planes[1].getRowStride(), planes[1].getPixelStride(),
+                        imageProxy.getWidth(), imageProxy.getHeight(),
+                        imageProxy.getImageInfo().getRotationDegrees(), timestamp);
+            }
+        }
 
-        handler.post(() -> {
-            setInput(pendingBitmapFrame);
+        // the frame is converted while the camera still holds it, dropped while both inputs are busy
+        final ByteBuffer input = freeInputs.poll();
+        if (input == null) {
+            return;
+        }
+
+        RectF viewport = inputCrop;
+        if (autoCrop) {
+            // Zoom into the tracked objects, within the visible region
+            float[] next;
+            synchronized (nativeLock) {
+                next = nativeNextCrop(nativeHandle, viewport.left, viewport.top, viewport.width(), viewport.height());
+            }
+            viewport = new RectF(next[0], next[1], next[0] + next[2], next[1] + next[3]);
+        }
+        final RectF crop = viewport;
+
+        ImageProxy.PlaneProxy[] planes = imageProxy.getPlanes();
+        boolean preprocessed;
+        synchronized (nativeLock) {
+            preprocessed = nativePreprocessFrame(nativeHandle, planes[0].getBuffer(), planes[1].getBuffer(),
+                    planes[2].getBuffer(), planes[0].getRowStride(), planes[1].getRowStride(),
+                    planes[1].getPixelStride(), imageProxy.getWidth(), imageProxy.getHeight(), INPUT_ROTATION,
+                    crop.left, crop.top, crop.width(), crop.height(), input);
+        }
+        if (!preprocessed) {
+            freeInputs.offer(input);
+            return;
+        }
 
+        handler.post(() -> {
             long start = System.currentTimeMillis();
-            float[][] result = runInference();
+            float[][] result = runInference(input, crop, timestamp, true);
             long end = System.currentTimeMillis();
 
             // Increment frame count
@@ -213,60 +564,253 @@ public class TfliteDetector extends Detector {
                 fpsRateCallback.onResult(fps);
             }
 
+            if (latencyCompensation) {
+                // Move the boxes to where the objects will be when this result is displayed
+                result = extrapolate(presentDelayNanos);
+            }
+
             objectDetectionResultCallback.onResult(result);
             inferenceTimeCallback.onResult(end - start);
+
+            runReid(input, crop, timestamp);
+            freeInputs.offer(input);
+
+            if (ruleEventCallback != null) {
+                double[][] events;
+                synchronized (nativeLock) {
+                    events = nativeDrainRuleEvents(nativeHandle);
+                }
+                if (events != null && events.length > 0) {
+                    ruleEventCallback.onResult(events);
+                }
+            }
+
+            reportHeatmap(timestamp);
+            reportMemoryStats(timestamp);
         });
     }
 
-    private void setInput(Bitmap resizedbitmap) {
-        ByteBuffer imgData = ByteBuffer.allocateDirect(1 * INPUT_SIZE * INPUT_SIZE * 3 * NUM_BYTES_PER_CHANNEL);
-        int[] intValues = new int[INPUT_SIZE * INPUT_SIZE];
+    private void reportMemoryStats(long timestamp) {
+        if (memoryStatsCallback == null || memoryStatsIntervalNanos <= 0
+                || timestamp - lastMemoryStats < memoryStatsIntervalNanos) {
+            return;
+        }
+        lastMemoryStats = timestamp;
 
-        resizedbitmap.getPixels(intValues, 0, resizedbitmap.getWidth(), 0, 0, resizedbitmap.getWidth(), resizedbitmap.getHeight());
+        long[] stats = nativeMemoryStats();
+        if (stats != null) {
+            memoryStatsCallback.onResult(stats);
+        }
+    }
 
-        imgData.order(ByteOrder.nativeOrder());
-        imgData.rewind();
-        for (int i = 0; i < INPUT_SIZE; ++i) {
-            for (int j = 0; j < INPUT_SIZE; ++j) {
-                int pixelValue = intValues[i * INPUT_SIZE + j];
-                float r = (((pixelValue >> 16) & 0xFF)) / 255.0f;
-                float g = (((pixelValue >> 8) & 0xFF)) / 255.0f;
-                float b = ((pixelValue & 0xFF)) / 255.0f;
-                imgData.putFloat(r);
-                imgData.putFloat(g);
-                imgData.putFloat(b);
+    private void reportHeatmap(long timestamp) {
+        if (heatmapCallback == null || heatmapWidth <= 0 || heatmapHeight <= 0
+                || timestamp - lastHeatmapSnapshot < heatmapSnapshotIntervalNanos) {
+            return;
+        }
+        lastHeatmapSnapshot = timestamp;
+
+        byte[] cells;
+        synchronized (nativeLock) {
+            cells = nativeHeatmapSnapshot(nativeHandle, timestamp, heatmapPeak);
+        }
+        if (cells != null) {
+            heatmapCallback.onResult(cells, heatmapWidth, heatmapHeight, heatmapPeak[0]);
+        }
+    }
+
+    private void runReid(ByteBuffer input, RectF crop, long timestamp) {
+        if (reidInterpreter == null) {
+            return;
+        }
+
+        // Crops of the tracks due for a new embedding, cut from the model input natively
+        int[] trackIds;
+        synchronized (nativeLock) {
+            trackIds = nativeExtractReidCrops(nativeHandle, input, inputSize,
+                    crop.left, crop.top, crop.width(), crop.height(), timestamp,
+                    reidCrops, reidInputWidth, reidInputHeight, MAX_REID_CROPS_PER_FRAME);
+        }
+        if (trackIds == null) {
+            return;
+        }
+
+        int cropBytes = reidInputWidth * reidInputHeight * 3 * NUM_BYTES_PER_CHANNEL;
+        for (int i = 0; i < trackIds.length; i++) {
+            reidCrops.limit((i + 1) * cropBytes).position(i * cropBytes);
+            ByteBuffer cropBuffer = reidCrops.slice().order(ByteOrder.nativeOrder());
+            reidCrops.clear();
+
+            reidOutput.rewind();
+            reidInterpreter.run(cropBuffer, reidOutput);
+            synchronized (nativeLock) {
+                nativeAddEmbedding(nativeHandle, trackIds[i], reidOutput);
             }
         }
-        this.inputArray = new Object[]{imgData};
-        this.outputMap = new HashMap<>();
-        ByteBuffer outData = ByteBuffer.allocateDirect(outputShape2 * outputShape3 * NUM_BYTES_PER_CHANNEL);
-        outData.order(ByteOrder.nativeOrder());
-        outData.rewind();
-        outputMap.put(0, outData);
     }
 
-    private float[][] runInference() {
-        if (interpreter != null) {
-            interpreter.runForMultipleInputsOutputs(inputArray, outputMap);
+    private void onDisplayFrame(long frameTimeNanos) {
+        if (!latencyCompensation || !refreshAtDisplayRate || nativeHandle == 0) {
+            return;
+        }
+
+        // Choreographer frame times share the System.nanoTime() clock with the tracks
+        float[][] result;
+        synchronized (nativeLock) {
+            result = nativeExtrapolate(nativeHandle, frameTimeNanos + presentDelayNanos, MAX_EXTRAPOLATION_NS);
+        }
+        if (objectDetectionResultCallback != null) {
+            objectDetectionResultCallback.onResult(result);
+        }
+        Choreographer.getInstance().postFrameCallback(displayFrameCallback);
+    }
 
-            ByteBuffer byteBuffer = (ByteBuffer) outputMap.get(0);
-            if (byteBuffer != null) {
-                byteBuffer.rewind();
+    /**
+     * Converts a camera timestamp to the System.nanoTime() clock. Camera timestamps are based on
+     * either the realtime or the monotonic clock depending on the device, anything else falls
+     * back to the time the frame was received.
+     */
+    private static long toNanoTime(long cameraTimestamp) {
+        long now = System.nanoTime();
+        long realtimeOffset = SystemClock.elapsedRealtimeNanos() - cameraTimestamp;
+        if (realtimeOffset >= 0 && realtimeOffset < CLOCK_MATCH_NS) {
+            return now - realtimeOffset;
+        }
+        long monotonicOffset = now - cameraTimestamp;
+        if (monotonicOffset >= 0 && monotonicOffset < CLOCK_MATCH_NS) {
+            return cameraTimestamp;
+        }
+        return now;
+    }
 
-                for (int j = 0; j < outputShape2; ++j) {
-                    for (int k = 0; k < outputShape3; ++k) {
-                        output[j][k] = byteBuffer.getFloat();
-                    }
+    private void allocateBuffers() {
+        int inputBytes = inputSize * inputSize * 3 * NUM_BYTES_PER_CHANNEL;
+        freeInputs.clear();
+        for (int i = 0; i < INPUT_BUFFERS; i++) {
+            freeInputs.offer(ByteBuffer.allocateDirect(inputBytes).order(ByteOrder.nativeOrder()));
+        }
+        stillInput = ByteBuffer.allocateDirect(inputBytes).order(ByteOrder.nativeOrder());
+        outputBuffer = ByteBuffer.allocateDirect(outputShape2 * outputShape3 * NUM_BYTES_PER_CHANNEL)
+                .order(ByteOrder.nativeOrder());
+        outputMap = new HashMap<>();
+    }
+
+    // One inference on the blank still input, so tensors are allocated and the delegate is ready
+    // before the first camera frame
+    private void warmUp() {
+        stillInput.rewind();
+        outputBuffer.rewind();
+        outputMap.put(0, outputBuffer);
+        interpreter.runForMultipleInputsOutputs(new Object[]{stillInput}, outputMap);
+    }
+
+    private float[][] runInference(ByteBuffer input, RectF crop, long timestamp, boolean track) {
+        if (interpreter != null && nativeHandle != 0) {
+            ByteBuffer byteBuffer = outputBuffer;
+
+            // Live frames go straight into a slot Dart can map, when one is free. They run on the
+            // main thread like release(), so the slot stays valid until postprocess
+            ByteBuffer[] slots = rawOutputSlots;
+            if (slots != null && track) {
+                int slot;
+                synchronized (nativeLock) {
+                    slot = nativeBeginOutput(nativeHandle);
+                }
+                if (slot >= 0) {
+                    byteBuffer = slots[slot];
                 }
+            }
+            // chosen again for every frame, a slot handed to Dart never stays in the map
+            byteBuffer.rewind();
+            input.rewind();
+            outputMap.put(0, byteBuffer);
 
-                return postprocess(output, outputShape3, outputShape2, (float) confidenceThreshold,
-                        (float) iouThreshold, numItemsThreshold, numClasses);
+            interpreter.runForMultipleInputsOutputs(new Object[]{input}, outputMap);
+
+            synchronized (nativeLock) {
+                return postprocess(nativeHandle, byteBuffer, crop.left, crop.top, crop.width(), crop.height(),
+                        timestamp, track);
             }
         }
         return new float[0][];
     }
 
-    private native float[][] postprocess(float[][] recognitions, int w, int h,
-                                         float confidenceThreshold, float iouThreshold,
-                                         int numItemsThreshold, int numClasses);
+    private native long nativeCreate();
+
+    private native void nativeRelease(long handle);
+
+    private native void nativeSetRules(long handle, float[][] rules);
+
+    private native double[][] nativeDrainRuleEvents(long handle);
+
+    private native void nativeSetRegionsOfInterest(long handle, float[][] regions);
+
+    private native void nativeSetAutoCrop(long handle, boolean enabled, float minScale, int refreshInterval);
+
+    private native void nativeSetReid(long handle, int dim, int capacity, float threshold);
+
+    private native int[] nativeExtractReidCrops(long handle, ByteBuffer input, int inputSize,
+                                                float cropX, float cropY, float cropWidth, float cropHeight,
+                                                long timestamp, ByteBuffer crops, int cropWidthPx,
+                                                int cropHeightPx, int maxCrops);
+
+    private native int nativeAddEmbedding(long handle, int trackId, ByteBuffer embedding);
+
+    private native void nativeSetTrackHistory(long handle, long memoryBudget, int pointsPerTrack, float epsilon);
+
+    private native void nativeSetSmoothing(long handle, boolean enabled, float minCutoff, float beta,
+                                           float derivativeCutoff);
+
+    private native byte[] nativeGetTrajectory(long handle, int trackId, long window);
+
+    private native void nativeSetHeatmap(long handle, int width, int height, long halfLife);
+
+    private native byte[] nativeHeatmapSnapshot(long handle, long timestamp, float[] peak);
+
+    private native void nativeSetFrameBuffer(long handle, long memoryBudget, int maxSide, int quality);
+
+    private static native void nativeSetMemoryBudget(long bytes);
+
+    private static native long[] nativeMemoryStats();
+
+    private native void nativePushFrame(long handle, ByteBuffer y, ByteBuffer u, ByteBuffer v,
+                                        int yRowStride, int uvRowStride, int uvPixelStride,
+                                        int width, int height, int rotation, long timestamp);
+
+    private native int nativeDumpFrames(long handle, long from, long to, String directory);
+
+    private native boolean nativeSetRecording(long handle, String path);
+
+    private native boolean nativeSetDetectionLog(long handle, String directory, int recordsPerSegment, int maxSegments);
+
+    private native float[][] nativeExtrapolate(long handle, long timestamp, long maxHorizon);
+
+    private native float[] nativeNextCrop(long handle, float viewportX, float viewportY,
+                                          float viewportWidth, float viewportHeight);
+
+    private native void nativeSetModel(long handle, int inputSize, int numClasses, int numAnchors);
+
+    private native boolean nativePreprocessFrame(long handle, ByteBuffer y, ByteBuffer u, ByteBuffer v,
+                                                 int yRowStride, int uvRowStride, int uvPixelStride,
+                                                 int width, int height, int rotation,
+                                                 float cropX, float cropY, float cropWidth, float cropHeight,
+                                                 ByteBuffer input);
+
+    private native boolean nativePreprocessBitmap(long handle, int[] pixels, ByteBuffer input);
+
+    private native void nativeSetPostprocessConfig(long handle, float confidenceThreshold, float iouThreshold,
+                                                   int maxDetections, int nmsMode, int maxProposals,
+                                                   int[] classes);
+
+    private native boolean nativeSetPostprocessor(long handle, String name, String library, int rows, int cols);
+
+    private native long nativeSetRawOutput(long handle, int rows, int cols);
+
+    private native ByteBuffer nativeRawOutputSlot(long handle, int slot);
+
+    private native int nativeBeginOutput(long handle);
+
+    private native float[][] postprocess(long handle, ByteBuffer recognitions,
+                                         float cropX, float cropY, float cropWidth, float cropHeight,
+                                         long timestamp, boolean track);
 }
@@ -50,6 +50,9 @@ class MethodCallHandler: VideoCaptureDelegate, InferenceTimeListener, ResultsLis
         else if call.method == "setNumItemsThreshold"{
             setNumItemsThreshold(args: args, result: result)
         }
+        else if call.method == "setSmoothing"{
+            setSmoothing(args: args, result: result)
+        }
         else if call.method == "setLensDirection"{
             setLensDirection(args: args, result: result)
         }
@@ -133,6 +136,14 @@ class MethodCallHandler: VideoCaptureDelegate, InferenceTimeListener, ResultsLis
         (predictor as? ObjectDetector)?.setIouThreshold(iou: iou)
     }
     
+    private func setSmoothing(args:[String: Any], result:@escaping FlutterResult) {
+        let enabled = args["enabled"] as! Bool
+        let minCutoff = args["minCutoff"] as! Double
+        let beta = args["beta"] as! Double
+        let derivativeCutoff = args["derivativeCutoff"] as! Double
+        (predictor as? ObjectDetector)?.setSmoothing(enabled: enabled, minCutoff: minCutoff, beta: beta, derivativeCutoff: derivativeCutoff)
+    }
+    
     private func setNumItemsThreshold(args:[String: Any], result:@escaping FlutterResult) {
         let numItems = args["numItems"] as! Int
         (predictor as? ObjectDetector)?.setNumItemsThreshold(numItems: numItems)
@@ -11,6 +11,9 @@ public class ObjectDetector: Predictor {
     private var currentOnFpsRateListener: FpsRateListener?
     private var screenSize: CGSize?
     private var labels = [String]()
+    // set for models exported without the NMS pipeline, their raw output is decoded natively
+    private var postprocessor: YoloPostprocessor?
+    private var currentTimestamp: Int64 = 0
     var t0 = 0.0  // inference start
     var t1 = 0.0  // inference dt
     var t2 = 0.0  // inference dt smoothed
@@ -70,7 +73,24 @@ public class ObjectDetector: Predictor {
         screenSize = CGSize(width: bounds.width, height: bounds.height)
             
         detector = try! VNCoreMLModel(for: mlModel)
-        detector.featureProvider = ThresholdProvider()
+
+        // A single [1, 4 + classes, anchors] output is the raw model, without the NMS pipeline
+        let outputs = mlModel.modelDescription.outputDescriptionsByName.values
+        if outputs.count == 1,
+           let shape = outputs.first?.multiArrayConstraint?.shape, shape.count >= 2,
+           let input = mlModel.modelDescription.inputDescriptionsByName.values.first?.imageConstraint {
+            let postprocessor = YoloPostprocessor(
+                numClasses: shape[shape.count - 2].intValue - 4,
+                numAnchors: shape[shape.count - 1].intValue,
+                inputWidth: input.pixelsWide,
+                inputHeight: input.pixelsHigh)
+            postprocessor.confidenceThreshold = Float(confidenceThreshold)
+            postprocessor.iouThreshold = Float(iouThreshold)
+            postprocessor.maxDetections = numItemsThreshold
+            self.postprocessor = postprocessor
+        } else {
+            detector.featureProvider = ThresholdProvider()
+        }
 
         visionRequest = {
             let request = VNCoreMLRequest(model: detector, completionHandler: {
@@ -88,6 +108,7 @@ public class ObjectDetector: Predictor {
             currentOnResultsListener = onResultsListener
             currentOnInferenceTimeListener = onInferenceTime
             currentOnFpsRateListener = onFpsRate
+            currentTimestamp = Int64(CMTimeGetSeconds(CMSampleBufferGetPresentationTimeStamp(sampleBuffer)) * 1e9)
             
             /// - Tag: MappingOrientation
             // The frame is always oriented based on the camera sensor,
@@ -129,98 +150,161 @@ public class ObjectDetector: Predictor {
     private var confidenceThreshold = 0.2
     public func setConfidenceThreshold(confidence: Double) {
         confidenceThreshold = confidence
-        detector.featureProvider = ThresholdProvider(iouThreshold: iouThreshold, confidenceThreshold: confidenceThreshold)
+        updateThresholds()
     }
     
     private var iouThreshold = 0.4
     public func setIouThreshold(iou: Double){
         iouThreshold = iou
-        detector.featureProvider = ThresholdProvider(iouThreshold: iouThreshold, confidenceThreshold: confidenceThreshold)
+        updateThresholds()
     }
     
     private var numItemsThreshold = 30
     public func setNumItemsThreshold(numItems: Int){
         numItemsThreshold = numItems
+        postprocessor?.maxDetections = numItems
+    }
+    
+    /// One Euro smoothing of the live boxes, for models decoded natively.
+    public func setSmoothing(enabled: Bool, minCutoff: Double, beta: Double, derivativeCutoff: Double) {
+        guard let postprocessor = postprocessor else { return }
+        postprocessor.smoothingEnabled = enabled
+        postprocessor.smoothingMinCutoff = Float(minCutoff)
+        postprocessor.smoothingBeta = Float(beta)
+        postprocessor.smoothingDerivativeCutoff = Float(derivativeCutoff)
+    }
+    
+    private func updateThresholds() {
+        if let postprocessor = postprocessor {
+            postprocessor.confidenceThreshold = Float(confidenceThreshold)
+            postprocessor.iouThreshold = Float(iouThreshold)
+        } else {
+            detector.featureProvider = ThresholdProvider(iouThreshold: iouThreshold, confidenceThreshold: confidenceThreshold)
+        }
+    }
+    
+    /// A detection with its box normalized, origin lower left as Vision reports them.
+    private struct Detection {
+        var rect: CGRect
+        var label: String
+        var index: Int
+        var confidence: Float
+        var trackId: Int
+    }
+    
+    /// The detections of a request, at most numItemsThreshold, from the NMS pipeline or decoded
+    /// natively from the raw output.
+    private func detections(for request: VNRequest, timestamp: Int64, track: Bool) -> [Detection] {
+        if let results = request.results as? [VNRecognizedObjectObservation] {
+            // The labels array is a list of VNClassificationObservation objects,
+            // with the highest scoring class first in the list.
+            return results.prefix(numItemsThreshold).map { prediction in
+                Detection(rect: prediction.boundingBox,
+                          label: prediction.labels[0].identifier,
+                          index: labels.firstIndex(of: prediction.labels[0].identifier) ?? 0,
+                          confidence: prediction.labels[0].confidence,
+                          trackId: -1)
+            }
+        }
+        guard let postprocessor = postprocessor,
+              let results = request.results as? [VNCoreMLFeatureValueObservation],
+              let output = results.first?.featureValue.multiArrayValue
+        else { return [] }
+        
+        // 7 floats per detection, origin top left
+        let packed = postprocessor.process(output, timestamp: timestamp, track: track)
+        return packed.withUnsafeBytes { (buffer: UnsafeRawBufferPointer) in
+            let values = buffer.bindMemory(to: Float.self)
+            return stride(from: 0, to: values.count - 6, by: 7).map { i in
+                let index = Int(values[i + 5])
+                return Detection(rect: CGRect(x: CGFloat(values[i]),
+                                              y: CGFloat(1 - values[i + 1] - values[i + 3]),
+                                              width: CGFloat(values[i + 2]),
+                                              height: CGFloat(values[i + 3])),
+                                 label: index < labels.count ? labels[index] : "",
+                                 index: index,
+                                 confidence: values[i + 4],
+                                 trackId: Int(values[i + 6]))
+            }
+        }
+    }
+    
+    private func recognition(_ detection: Detection, rect: CGRect) -> [String:Any] {
+        var recognition: [String:Any] = ["label": detection.label,
+                                         "confidence": detection.confidence,
+                                         "index": detection.index,
+                                         "x": rect.origin.x,
+                                         "y": rect.origin.y,
+                                         "width": rect.size.width,
+                                         "height": rect.size.height]
+        if detection.trackId >= 0 {
+            recognition["trackId"] = detection.trackId
+        }
+        return recognition
     }
     
     private func processObservations(for request: VNRequest, error: Error?) {
+        // Raw outputs are decoded here on the capture queue, the main queue only maps the boxes
+        let detections = self.detections(for: request, timestamp: currentTimestamp, track: true)
         DispatchQueue.main.async {
-            if let results = request.results as? [VNRecognizedObjectObservation] {
-                var recognitions: [[String:Any]] = []
-                
-                let width = self.screenSize?.width ?? 375  // 375 pix
-                let height = self.screenSize?.height ?? 816  // 812 pix
-                let ratio: CGFloat = (height / width) / (4.0 / 3.0)  // .photo
-
-                for i in 0..<100 {
-                    if i < results.count && i < self.numItemsThreshold {
-                        let prediction = results[i]
-                        
-                        var rect = prediction.boundingBox  // normalized xywh, origin lower left
-                        switch UIDevice.current.orientation {
-                        case .portraitUpsideDown:
-                            rect = CGRect(x: 1.0 - rect.origin.x - rect.width,
-                                          y: 1.0 - rect.origin.y - rect.height,
-                                          width: rect.width,
-                                          height: rect.height)
-                        case .landscapeLeft:
-                            rect = CGRect(x: rect.origin.y,
-                                          y: 1.0 - rect.origin.x - rect.width,
-                                          width: rect.height,
-                                          height: rect.width)
-                        case .landscapeRight:
-                            rect = CGRect(x: 1.0 - rect.origin.y - rect.height,
-                                          y: rect.origin.x,
-                                          width: rect.height,
-                                          height: rect.width)
-                        case .unknown:
-                            print("The device orientation is unknown, the predictions may be affected")
-                            fallthrough
-                        default: break
-                        }
-                        
-                        if ratio >= 1 { // iPhone ratio = 1.218
-                            let offset = (1 - ratio) * (0.5 - rect.minX)
-                            let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: offset, y: -1)
-                            rect = rect.applying(transform)
-                            rect.size.width *= ratio
-                        } else { // iPad ratio = 0.75
-                            let offset = (ratio - 1) * (0.5 - rect.maxY)
-                            let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: 0, y: offset - 1)
-                            rect = rect.applying(transform)
-                            rect.size.height /= ratio
-                        }
+            var recognitions: [[String:Any]] = []
+            
+            let width = self.screenSize?.width ?? 375  // 375 pix
+            let height = self.screenSize?.height ?? 816  // 812 pix
+            let ratio: CGFloat = (height / width) / (4.0 / 3.0)  // .photo
 
-                        // Scale normalized to pixels [375, 812] [width, height]
-                        rect = VNImageRectForNormalizedRect(rect, Int(width), Int(height))
-                        
-                        // The labels array is a list of VNClassificationObservation objects,
-                        // with the highest scoring class first in the list.
-                        let label = prediction.labels[0].identifier
-                        let index = self.labels.firstIndex(of: label) ?? 0
-                        let confidence = prediction.labels[0].confidence
-                        recognitions.append(["label": label,
-                                             "confidence": confidence,
-                                             "index": index,
-                                             "x": rect.origin.x,
-                                             "y": rect.origin.y,
-                                             "width": rect.size.width,
-                                             "height": rect.size.height])
-                    }
+            for detection in detections {
+                var rect = detection.rect  // normalized xywh, origin lower left
+                switch UIDevice.current.orientation {
+                case .portraitUpsideDown:
+                    rect = CGRect(x: 1.0 - rect.origin.x - rect.width,
+                                  y: 1.0 - rect.origin.y - rect.height,
+                                  width: rect.width,
+                                  height: rect.height)
+                case .landscapeLeft:
+                    rect = CGRect(x: rect.origin.y,
+                                  y: 1.0 - rect.origin.x - rect.width,
+                                  width: rect.height,
+                                  height: rect.width)
+                case .landscapeRight:
+                    rect = CGRect(x: 1.0 - rect.origin.y - rect.height,
+                                  y: rect.origin.x,
+                                  width: rect.height,
+                                  height: rect.width)
+                case .unknown:
+                    print("The device orientation is unknown, the predictions may be affected")
+                    fallthrough
+                default: break
                 }
                 
-                self.currentOnResultsListener?.on(predictions: recognitions)
-                
-                // Measure FPS
-                if self.t1 < 10.0 {  // valid dt
-                    self.t2 = self.t1 * 0.05 + self.t2 * 0.95  // smoothed inference time
+                if ratio >= 1 { // iPhone ratio = 1.218
+                    let offset = (1 - ratio) * (0.5 - rect.minX)
+                    let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: offset, y: -1)
+                    rect = rect.applying(transform)
+                    rect.size.width *= ratio
+                } else { // iPad ratio = 0.75
+                    let offset = (ratio - 1) * (0.5 - rect.maxY)
+                    let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: 0, y: offset - 1)
+                    rect = rect.applying(transform)
+                    rect.size.height /= ratio
                 }
-                self.t4 = (CACurrentMediaTime() - self.t3) * 0.05 + self.t4 * 0.95  // smoothed delivered FPS
-                self.t3 = CACurrentMediaTime()
 
-                self.currentOnInferenceTimeListener?.on(inferenceTime: self.t2 * 1000)  // t2 seconds to ms
-                self.currentOnFpsRateListener?.on(fpsRate: 1 / self.t4)
+                // Scale normalized to pixels [375, 812] [width, height]
+                rect = VNImageRectForNormalizedRect(rect, Int(width), Int(height))
+                recognitions.append(self.recognition(detection, rect: rect))
+            }
+            
+            self.currentOnResultsListener?.on(predictions: recognitions)
+            
+            // Measure FPS
+            if self.t1 < 10.0 {  // valid dt
+                self.t2 = self.t1 * 0.05 + self.t2 * 0.95  // smoothed inference time
             }
+            self.t4 = (CACurrentMediaTime() - self.t3) * 0.05 + self.t4 * 0.95  // smoothed delivered FPS
+            self.t3 = CACurrentMediaTime()
+
+            self.currentOnInferenceTimeListener?.on(inferenceTime: self.t2 * 1000)  // t2 seconds to ms
+            self.currentOnFpsRateListener?.on(fpsRate: 1 / self.t4)
         }
     }
     
@@ -239,43 +323,25 @@ public class ObjectDetector: Predictor {
         
         do {
             try requestHandler.perform([request])
-            if let results = request.results as? [VNRecognizedObjectObservation] {
-                for i in 0..<100 {
-                    if i < results.count && i < self.numItemsThreshold {
-                        let prediction = results[i]
-                        
-                        var rect = prediction.boundingBox  // normalized xywh, origin lower left
-                        print("rect: \(rect)")
-                        
-                        if screenRatio >= 1 { // iPhone ratio = 1.218
-                            let offset = (1 - screenRatio) * (0.5 - rect.minX)
-                            let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: offset, y: -1)
-                            rect = rect.applying(transform)
-    //                        rect.size.width *= screenRatio
-                        } else { // iPad ratio = 0.75
-                            let offset = (screenRatio - 1) * (0.5 - rect.maxY)
-                            let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: 0, y: offset - 1)
-                            rect = rect.applying(transform)
-                            rect.size.height /= screenRatio
-                        }
-
-                        rect = VNImageRectForNormalizedRect(rect, Int(screenWidth), Int(newHeight))
-                        print("rect: \(rect)")
-                        
-                        // The labels array is a list of VNClassificationObservation objects,
-                        // with the highest scoring class first in the list.
-                        let label = prediction.labels[0].identifier
-                        let index = self.labels.firstIndex(of: label) ?? 0
-                        let confidence = prediction.labels[0].confidence
-                        recognitions.append(["label": label,
-                                             "confidence": confidence,
-                                             "index": index,
-                                             "x": rect.origin.x,
-                                             "y": rect.origin.y,
-                                             "width": rect.size.width,
-                                             "height": rect.size.height])
-                    }
+            for detection in detections(for: request, timestamp: 0, track: false) {
+                var rect = detection.rect  // normalized xywh, origin lower left
+                print("rect: \(rect)")
+                
+                if screenRatio >= 1 { // iPhone ratio = 1.218
+                    let offset = (1 - screenRatio) * (0.5 - rect.minX)
+                    let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: offset, y: -1)
+                    rect = rect.applying(transform)
+//                        rect.size.width *= screenRatio
+                } else { // iPad ratio = 0.75
+                    let offset = (screenRatio - 1) * (0.5 - rect.maxY)
+                    let transform = CGAffineTransform(scaleX: 1, y: -1).translatedBy(x: 0, y: offset - 1)
+                    rect = rect.applying(transform)
+                    rect.size.height /= screenRatio
                 }
+
+                rect = VNImageRectForNormalizedRect(rect, Int(screenWidth), Int(newHeight))
+                print("rect: \(rect)")
+                recognitions.append(recognition(detection, rect: rect))
             }
         } catch {
             print(error)
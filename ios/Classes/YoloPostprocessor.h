@@ -0,0 +1,39 @@
+#import <CoreML/CoreML.h>
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Decodes the raw output of a detection model exported without the NMS
+/// pipeline, with the native core shared with the Android plugin: decoding,
+/// non maximum suppression and tracking.
+@interface YoloPostprocessor : NSObject
+
+/// A model with a [1, 4 + numClasses, numAnchors] output whose boxes are
+/// centers and sizes in pixels of its input.
+- (instancetype)initWithNumClasses:(NSInteger)numClasses
+                        numAnchors:(NSInteger)numAnchors
+                        inputWidth:(NSInteger)inputWidth
+                       inputHeight:(NSInteger)inputHeight;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@property(nonatomic) float confidenceThreshold;
+@property(nonatomic) float iouThreshold;
+@property(nonatomic) NSInteger maxDetections;
+
+/// One Euro smoothing of the tracked boxes, off by default. The cutoffs are
+/// in Hz, beta in normalized units per second, as on Android.
+@property(nonatomic) BOOL smoothingEnabled;
+@property(nonatomic) float smoothingMinCutoff;
+@property(nonatomic) float smoothingBeta;
+@property(nonatomic) float smoothingDerivativeCutoff;
+
+/// Returns 7 floats per detection, most confident first: x, y, width and
+/// height normalized to the input with the origin top left, confidence,
+/// class index and track id. Track ids are -1 unless `track` is set, which
+/// live frames do with their presentation time in nanoseconds.
+- (NSData *)process:(MLMultiArray *)output timestamp:(int64_t)timestamp track:(BOOL)track;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,162 @@
+#import "YoloPostprocessor.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "detections.h"
+#include "predictor.h"
+#include "smoothing.h"
+#include "tracker.h"
+
+// Float16 to float, the format of outputs computed on the Neural Engine
+static float half_to_float(uint16_t half) {
+    uint32_t sign = (uint32_t) (half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // subnormal, normalized for the wider exponent
+        exponent = 127 - 15 + 1;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Copies a strided [rows][cols] view into contiguous floats, scaling the four box rows.
+template<typename T, typename Convert>
+static void gather_rows(const T *src, int rows, int cols, NSInteger row_stride, NSInteger col_stride,
+                        const float *box_scale, Convert convert, float *dst) {
+    for (int r = 0; r < rows; r++) {
+        const T *row = src + r * row_stride;
+        const float scale = r < 4 ? box_scale[r] : 1.f;
+        float *out = dst + (size_t) r * cols;
+        for (int c = 0; c < cols; c++)
+            out[c] = convert(row[c * col_stride]) * scale;
+    }
+}
+
+@implementation YoloPostprocessor {
+    std::mutex _lock;
+    std::unique_ptr<Detector> _detector;
+    Tracker _tracker;
+    Smoother _smoother;
+    PostprocessConfig _config;
+    Detections _proposals;
+    // the output as the core reads it, contiguous with normalized boxes
+    std::vector<float> _output;
+    std::vector<DetectedObject> _objects;
+    // x, y, width and height to the input size
+    float _boxScale[4];
+}
+
+- (instancetype)initWithNumClasses:(NSInteger)numClasses
+                        numAnchors:(NSInteger)numAnchors
+                        inputWidth:(NSInteger)inputWidth
+                       inputHeight:(NSInteger)inputHeight {
+    if (self = [super init]) {
+        _detector = std::make_unique<Detector>((int) MAX(inputWidth, inputHeight), (int) numClasses,
+                                               (int) numAnchors);
+        _output.resize(_detector->output_length());
+        _boxScale[0] = _boxScale[2] = 1.f / inputWidth;
+        _boxScale[1] = _boxScale[3] = 1.f / inputHeight;
+        _confidenceThreshold = _config.confidence_threshold;
+        _iouThreshold = _config.iou_threshold;
+        _maxDetections = _config.max_detections;
+        _smoothingEnabled = _smoother.enabled;
+        _smoothingMinCutoff = _smoother.min_cutoff;
+        _smoothingBeta = _smoother.beta;
+        _smoothingDerivativeCutoff = _smoother.derivative_cutoff;
+    }
+    return self;
+}
+
+// Brings the output into _output, false when its shape does not match the model.
+- (BOOL)copyOutput:(MLMultiArray *)output {
+    NSArray<NSNumber *> *shape = output.shape;
+    NSArray<NSNumber *> *strides = output.strides;
+    const NSUInteger n = shape.count;
+    const int rows = 4 + _detector->num_classes();
+    const int cols = _detector->num_anchors();
+    if (n < 2 || shape[n - 2].intValue != rows || shape[n - 1].intValue != cols)
+        return NO;
+
+    const NSInteger row_stride = strides[n - 2].integerValue;
+    const NSInteger col_stride = strides[n - 1].integerValue;
+    float *dst = _output.data();
+
+    switch (output.dataType) {
+        case MLMultiArrayDataTypeFloat32:
+            gather_rows((const float *) output.dataPointer, rows, cols, row_stride, col_stride, _boxScale,
+                        [](float v) { return v; }, dst);
+            return YES;
+        case MLMultiArrayDataTypeDouble:
+            gather_rows((const double *) output.dataPointer, rows, cols, row_stride, col_stride, _boxScale,
+                        [](double v) { return (float) v; }, dst);
+            return YES;
+        default:
+            break;
+    }
+    if (@available(iOS 16.0, *)) {
+        if (output.dataType == MLMultiArrayDataTypeFloat16) {
+            gather_rows((const uint16_t *) output.dataPointer, rows, cols, row_stride, col_stride, _boxScale,
+                        half_to_float, dst);
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (NSData *)process:(MLMultiArray *)output timestamp:(int64_t)timestamp track:(BOOL)track {
+    std::lock_guard<std::mutex> guard(_lock);
+    _config.confidence_threshold = _confidenceThreshold;
+    _config.iou_threshold = _iouThreshold;
+    _config.max_detections = (int) _maxDetections;
+    if (_smoother.enabled && !_smoothingEnabled)
+        _smoother.reset();
+    _smoother.enabled = _smoothingEnabled;
+    _smoother.min_cutoff = _smoothingMinCutoff;
+    _smoother.beta = _smoothingBeta;
+    _smoother.derivative_cutoff = _smoothingDerivativeCutoff;
+
+    _objects.clear();
+    if ([self copyOutput:output]) {
+        _proposals.clear();
+        _detector->decode(_output.data(), _config.confidence_threshold, nullptr, _proposals);
+        _detector->select(_proposals, _config, Box(0.f, 0.f, 1.f, 1.f), _objects);
+        if (track) {
+            _tracker.update(_objects, timestamp);
+            _smoother.smooth(_objects, timestamp);
+        }
+    }
+
+    // [detected_box][7(x, y, width, height, conf, class, track id)], as on Android
+    NSMutableData *packed = [NSMutableData dataWithLength:_objects.size() * 7 * sizeof(float)];
+    float *row = (float *) packed.mutableBytes;
+    for (const DetectedObject &obj: _objects) {
+        row[0] = obj.rect.x;
+        row[1] = obj.rect.y;
+        row[2] = obj.rect.width;
+        row[3] = obj.rect.height;
+        row[4] = obj.confidence;
+        row[5] = (float) obj.index;
+        row[6] = (float) obj.track_id;
+        row += 7;
+    }
+    return packed;
+}
+
+@end
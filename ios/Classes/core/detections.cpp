@@ -0,0 +1,2 @@
+// The portable native core, shared with the Android plugin
+#include "../../../android/src/main/cpp/detections.cpp"
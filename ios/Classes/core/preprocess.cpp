@@ -0,0 +1,4 @@
+// The portable native core, shared with the Android plugin. Built without fused multiply-add like
+// on Android, so the YUV conversion kernels round like their scalar reference
+#pragma clang fp contract(off)
+#include "../../../android/src/main/cpp/preprocess.cpp"
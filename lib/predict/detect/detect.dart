@@ -1,3 +1,10 @@
 export 'detected_object.dart';
+export 'detection_log.dart';
+export 'detection_rule.dart';
+export 'heatmap_snapshot.dart';
+export 'memory_stats.dart';
 export 'object_detector.dart';
 export 'object_detector_painter.dart';
+export 'raw_output.dart';
+export 'rule_event.dart';
+export 'trajectory.dart';
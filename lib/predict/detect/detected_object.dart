@@ -8,6 +8,7 @@ class DetectedObject {
     required this.boundingBox,
     required this.index,
     required this.label,
+    this.trackId,
   });
 
   /// Creates a [DetectedObject] from a [json] object.
@@ -22,6 +23,7 @@ class DetectedObject {
       ),
       index: json['index'] as int,
       label: json['label'] as String,
+      trackId: json['trackId'] as int?,
     );
   }
 
@@ -36,4 +38,7 @@ class DetectedObject {
 
   /// The label of the detection.
   final String label;
+
+  /// The id of the track this detection belongs to, live stream only.
+  final int? trackId;
 }
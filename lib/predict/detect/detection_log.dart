@@ -0,0 +1,86 @@
+import 'dart:typed_data';
+
+/// A detection read back from a segment of the native detection log.
+///
+/// See `ObjectDetector.setDetectionLog`.
+class DetectionLogRecord {
+  /// Creates a [DetectionLogRecord].
+  DetectionLogRecord({
+    required this.timestamp,
+    required this.frameId,
+    required this.trackId,
+    required this.index,
+    required this.confidence,
+    required this.x,
+    required this.y,
+    required this.width,
+    required this.height,
+  });
+
+  static const int _magic = 0x474f4c55;
+  static const int _version = 1;
+  static const int _headerSize = 32;
+  static const int _recordSize = 32;
+  static const double _scale = 1 / 65535;
+
+  /// Reads the records of one log segment file's [bytes].
+  ///
+  /// Returns an empty list if [bytes] is not a detection log segment.
+  static List<DetectionLogRecord> readSegment(Uint8List bytes) {
+    final data = ByteData.sublistView(bytes);
+    if (data.lengthInBytes < _headerSize ||
+        data.getUint32(0, Endian.little) != _magic ||
+        data.getUint32(4, Endian.little) != _version ||
+        data.getUint32(8, Endian.little) != _recordSize) {
+      return [];
+    }
+
+    final stored = (data.lengthInBytes - _headerSize) ~/ _recordSize;
+    final written = data.getUint64(16, Endian.little);
+    final count = written < stored ? written : stored;
+
+    return List.generate(count, (i) {
+      final offset = _headerSize + i * _recordSize;
+      return DetectionLogRecord(
+        timestamp: Duration(
+          microseconds: data.getInt64(offset, Endian.little) ~/ 1000,
+        ),
+        frameId: data.getUint32(offset + 8, Endian.little),
+        trackId: data.getInt32(offset + 12, Endian.little),
+        x: data.getUint16(offset + 16, Endian.little) * _scale,
+        y: data.getUint16(offset + 18, Endian.little) * _scale,
+        width: data.getUint16(offset + 20, Endian.little) * _scale,
+        height: data.getUint16(offset + 22, Endian.little) * _scale,
+        index: data.getUint16(offset + 24, Endian.little),
+        confidence: data.getUint16(offset + 26, Endian.little) * _scale,
+      );
+    });
+  }
+
+  /// The monotonic timestamp of the frame.
+  final Duration timestamp;
+
+  /// The number of the live frame, counted from when the model was loaded.
+  final int frameId;
+
+  /// The track id of the object, or -1 if it is not tracked.
+  final int trackId;
+
+  /// The class index of the object.
+  final int index;
+
+  /// The confidence of the detection.
+  final double confidence;
+
+  /// The normalized left edge of the box.
+  final double x;
+
+  /// The normalized top edge of the box.
+  final double y;
+
+  /// The normalized width of the box.
+  final double width;
+
+  /// The normalized height of the box.
+  final double height;
+}
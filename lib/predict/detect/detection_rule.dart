@@ -0,0 +1,66 @@
+import 'dart:ui';
+
+/// The kind of a [DetectionRule].
+enum DetectionRuleType {
+  /// A polygon zone, emits enter, exit and dwell events.
+  zone,
+
+  /// A directed line, emits crossing events.
+  line,
+}
+
+/// A rule evaluated natively on the tracked objects.
+///
+/// Points are normalized to the detection frame, (0, 0) being the top left
+/// corner and (1, 1) the bottom right corner.
+class DetectionRule {
+  /// Creates a polygon zone rule with at least three [points].
+  ///
+  /// When [dwellTime] is set, a dwell event is emitted once an object stays
+  /// inside the zone for longer than it.
+  DetectionRule.zone({
+    required this.id,
+    required this.points,
+    this.classIndex,
+    this.dwellTime,
+  }) : type = DetectionRuleType.zone;
+
+  /// Creates a line rule going from [start] to [end].
+  ///
+  /// Crossing from the left side of the line to its right side, looking
+  /// along its direction, is reported as a forward crossing.
+  DetectionRule.line({
+    required this.id,
+    required Offset start,
+    required Offset end,
+    this.classIndex,
+  })  : type = DetectionRuleType.line,
+        points = [start, end],
+        dwellTime = null;
+
+  /// The identifier reported back in every [RuleEvent] of this rule.
+  final int id;
+
+  /// The kind of rule.
+  final DetectionRuleType type;
+
+  /// The vertices of the zone or the two ends of the line.
+  final List<Offset> points;
+
+  /// The class index this rule applies to, or all classes when null.
+  final int? classIndex;
+
+  /// The minimum time inside the zone before a dwell event is emitted.
+  final Duration? dwellTime;
+
+  /// Converts this rule to the map sent to the platform.
+  Map<String, dynamic> toJson() => {
+        'id': id,
+        'type': type.index,
+        'classIndex': classIndex ?? -1,
+        'dwellMs': dwellTime?.inMilliseconds ?? 0,
+        'points': [
+          for (final point in points) ...[point.dx, point.dy],
+        ],
+      };
+}
@@ -0,0 +1,37 @@
+import 'dart:typed_data';
+
+/// A snapshot of the occupancy heatmap accumulated natively.
+class HeatmapSnapshot {
+  /// Creates a [HeatmapSnapshot].
+  HeatmapSnapshot({
+    required this.cells,
+    required this.width,
+    required this.height,
+    required this.peakSeconds,
+  });
+
+  /// Creates a [HeatmapSnapshot] from a [json] object.
+  factory HeatmapSnapshot.fromJson(Map<dynamic, dynamic> json) {
+    return HeatmapSnapshot(
+      cells: json['cells'] as Uint8List,
+      width: json['width'] as int,
+      height: json['height'] as int,
+      peakSeconds: (json['peakSeconds'] as num).toDouble(),
+    );
+  }
+
+  /// The heat of every cell row by row, scaled so the hottest cell is 255.
+  final Uint8List cells;
+
+  /// The number of cells in a row.
+  final int width;
+
+  /// The number of rows.
+  final int height;
+
+  /// The decayed time objects spent on the hottest cell, in seconds.
+  final double peakSeconds;
+
+  /// The heat of the cell at column [x] and row [y], from 0 to 1.
+  double valueAt(int x, int y) => cells[y * width + x] / 255;
+}
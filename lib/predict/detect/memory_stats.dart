@@ -0,0 +1,54 @@
+/// Native memory held by each subsystem of the detectors, in bytes.
+class MemoryStats {
+  /// Creates a [MemoryStats].
+  MemoryStats({
+    required this.frames,
+    required this.tensors,
+    required this.scratch,
+    required this.tracker,
+    required this.history,
+    required this.caches,
+    required this.total,
+    required this.budget,
+  });
+
+  /// Creates a [MemoryStats] from a [json] object.
+  factory MemoryStats.fromJson(Map<dynamic, dynamic> json) {
+    return MemoryStats(
+      frames: json['frames'] as int,
+      tensors: json['tensors'] as int,
+      scratch: json['scratch'] as int,
+      tracker: json['tracker'] as int,
+      history: json['history'] as int,
+      caches: json['caches'] as int,
+      total: json['total'] as int,
+      budget: json['budget'] as int,
+    );
+  }
+
+  /// The evidence frame buffer and the frames staged for recording.
+  final int frames;
+
+  /// The raw model outputs shared with Dart, see
+  /// [ObjectDetector.setRawOutputEnabled].
+  final int tensors;
+
+  /// The per-frame scratch memory, also used by custom postprocessors.
+  final int scratch;
+
+  /// The live and lost tracks.
+  final int tracker;
+
+  /// The track trajectories.
+  final int history;
+
+  /// The re-identification galleries.
+  final int caches;
+
+  /// All subsystems together.
+  final int total;
+
+  /// The budget the subsystems shed memory to stay under, 0 when there is
+  /// none.
+  final int budget;
+}
@@ -1,4 +1,14 @@
+import 'dart:typed_data';
+import 'dart:ui';
+
 import 'package:ultralytics_yolo/predict/detect/detected_object.dart';
+import 'package:ultralytics_yolo/predict/detect/detection_log.dart';
+import 'package:ultralytics_yolo/predict/detect/detection_rule.dart';
+import 'package:ultralytics_yolo/predict/detect/heatmap_snapshot.dart';
+import 'package:ultralytics_yolo/predict/detect/memory_stats.dart';
+import 'package:ultralytics_yolo/predict/detect/raw_output.dart';
+import 'package:ultralytics_yolo/predict/detect/rule_event.dart';
+import 'package:ultralytics_yolo/predict/detect/trajectory.dart';
 import 'package:ultralytics_yolo/predict/predictor.dart';
 import 'package:ultralytics_yolo/yolo_model.dart';
 
@@ -26,6 +36,300 @@ class ObjectDetector extends Predictor {
     super.ultralyticsYoloPlatform.setNumItemsThreshold(numItems);
   }
 
+  /// Sets how the model output is filtered into detections.
+  ///
+  /// With [perClassNms] boxes only suppress overlapping boxes of their own
+  /// class. [maxProposals] keeps only that many of the most confident
+  /// candidates for NMS, all when 0. When [classes] is given only those class
+  /// indices are reported.
+  ///
+  /// Like the thresholds, the options apply from the next frame on, and a
+  /// frame never mixes old and new settings.
+  void setPostprocessOptions({
+    bool perClassNms = false,
+    int maxProposals = 0,
+    List<int>? classes,
+  }) {
+    super.ultralyticsYoloPlatform.setPostprocessOptions(
+          perClassNms: perClassNms,
+          maxProposals: maxProposals,
+          classes: classes,
+        );
+  }
+
+  /// The stream of events emitted by the detection rules.
+  Stream<List<RuleEvent>>? get ruleEventStream =>
+      super.ultralyticsYoloPlatform.ruleEventStream;
+
+  /// The occupancy heatmap snapshots configured with [setHeatmap].
+  Stream<HeatmapSnapshot>? get heatmapStream =>
+      super.ultralyticsYoloPlatform.heatmapStream;
+
+  /// The native memory stats configured with [setMemoryBudget].
+  Stream<MemoryStats>? get memoryStatsStream =>
+      super.ultralyticsYoloPlatform.memoryStatsStream;
+
+  /// Replaces the rules evaluated natively on the tracked objects.
+  void setRules(List<DetectionRule> rules) {
+    super.ultralyticsYoloPlatform.setRules([
+      for (final rule in rules) rule.toJson(),
+    ]);
+  }
+
+  /// Restricts detection to the given polygon [regions].
+  ///
+  /// Points are normalized to the detection frame. Anchors whose center
+  /// falls outside every region are skipped before decoding. An empty list
+  /// removes the restriction.
+  void setRegionsOfInterest(List<List<Offset>> regions) {
+    super.ultralyticsYoloPlatform.setRegionsOfInterest([
+      for (final region in regions)
+        [
+          for (final point in region) ...[point.dx, point.dy],
+        ],
+    ]);
+  }
+
+  /// Enables or disables the tracking-driven digital zoom.
+  ///
+  /// When enabled, each frame is cropped around the currently tracked objects
+  /// before inference, which gives small distant objects more model pixels.
+  /// The crop never gets smaller than [minScale] of the visible frame, and
+  /// every [refreshInterval] frames the whole frame is used to pick up new
+  /// objects. Boxes are always reported in full frame coordinates.
+  void setAutoCrop({
+    required bool enabled,
+    double minScale = 0.25,
+    int refreshInterval = 10,
+  }) {
+    super.ultralyticsYoloPlatform.setAutoCrop(
+          enabled: enabled,
+          minScale: minScale,
+          refreshInterval: refreshInterval,
+        );
+  }
+
+  /// Enables or disables display latency compensation.
+  ///
+  /// When enabled, every box in [detectionResultStream] is extrapolated from
+  /// its track's motion to [presentDelay] after it is emitted, roughly the
+  /// time it takes to reach the screen. With [refreshAtDisplayRate],
+  /// extrapolated boxes are also emitted on every display frame between
+  /// inference results.
+  void setLatencyCompensation({
+    required bool enabled,
+    Duration presentDelay = const Duration(milliseconds: 33),
+    bool refreshAtDisplayRate = false,
+  }) {
+    super.ultralyticsYoloPlatform.setLatencyCompensation(
+          enabled: enabled,
+          presentDelay: presentDelay,
+          refreshAtDisplayRate: refreshAtDisplayRate,
+        );
+  }
+
+  /// Returns the tracked objects extrapolated to [presentDelay] from now.
+  Future<List<DetectedObject?>?> extrapolateDetections({
+    Duration presentDelay = Duration.zero,
+  }) =>
+      super.ultralyticsYoloPlatform.extrapolateDetections(presentDelay);
+
+  /// Loads a TFLite appearance embedding model to re-identify tracks lost
+  /// after an occlusion, or disables re-identification when [modelPath] is
+  /// null.
+  ///
+  /// Confirmed tracks are embedded natively at a throttled rate and kept in
+  /// a gallery of up to [capacity] embeddings. A new track takes over the id
+  /// of a lost track when their cosine similarity reaches [threshold].
+  Future<String?> setReidModel({
+    String? modelPath,
+    double threshold = 0.7,
+    int capacity = 8192,
+  }) =>
+      super.ultralyticsYoloPlatform.setReidModel(
+            modelPath: modelPath,
+            threshold: threshold,
+            capacity: capacity,
+          );
+
+  /// Keeps the recent path of every tracked object within [memoryBudget]
+  /// bytes, at most [pointsPerTrack] points each.
+  ///
+  /// Points closer than [epsilon] (normalized) to the simplified path are
+  /// dropped. Pass a [memoryBudget] of 0 to disable the history.
+  Future<String?> setTrackHistory({
+    int memoryBudget = 1 << 20,
+    int pointsPerTrack = 256,
+    double epsilon = 0.002,
+  }) =>
+      super.ultralyticsYoloPlatform.setTrackHistory(
+            memoryBudget: memoryBudget,
+            pointsPerTrack: pointsPerTrack,
+            epsilon: epsilon,
+          );
+
+  /// Smooths the reported boxes natively with a One Euro filter per
+  /// coordinate, following each object by its track id.
+  ///
+  /// [minCutoff] in Hz sets the smoothing at rest, lower is steadier.
+  /// [beta] sets how fast it gives way to movement, in normalized units per
+  /// second, higher lags less. [derivativeCutoff] in Hz filters the speed
+  /// estimate.
+  Future<String?> setSmoothing({
+    bool enabled = true,
+    double minCutoff = 1,
+    double beta = 10,
+    double derivativeCutoff = 1,
+  }) =>
+      super.ultralyticsYoloPlatform.setSmoothing(
+            enabled: enabled,
+            minCutoff: minCutoff,
+            beta: beta,
+            derivativeCutoff: derivativeCutoff,
+          );
+
+  /// Returns the path of the track [trackId] over the last [window].
+  Future<Trajectory> getTrajectory({
+    required int trackId,
+    Duration window = const Duration(seconds: 10),
+  }) async {
+    final bytes = await super.ultralyticsYoloPlatform.getTrajectory(
+          trackId: trackId,
+          windowMs: window.inMilliseconds,
+        );
+    return Trajectory(bytes ?? Uint8List(0));
+  }
+
+  /// Accumulates natively how long objects stand on each cell of a
+  /// [width] x [height] grid over the frame.
+  ///
+  /// The heat halves every [halfLife], and a snapshot is sent on
+  /// [heatmapStream] every [snapshotInterval]. Pass a [width] of 0 to disable
+  /// the heatmap.
+  Future<String?> setHeatmap({
+    int width = 64,
+    int height = 64,
+    Duration halfLife = const Duration(minutes: 5),
+    Duration snapshotInterval = const Duration(seconds: 1),
+  }) =>
+      super.ultralyticsYoloPlatform.setHeatmap(
+            width: width,
+            height: height,
+            halfLifeMs: halfLife.inMilliseconds,
+            snapshotIntervalMs: snapshotInterval.inMilliseconds,
+          );
+
+  /// Limits the native memory of all detectors together to [bytes].
+  ///
+  /// Above the budget the detectors shed memory between frames: the
+  /// re-identification gallery first, then older buffered frames, then track
+  /// history and the spare capacity of the tracker and the scratch memory.
+  /// The bytes held by each subsystem are sent on [memoryStatsStream] every
+  /// [statsInterval]. Pass [bytes] of 0 for no limit.
+  Future<String?> setMemoryBudget({
+    required int bytes,
+    Duration statsInterval = const Duration(seconds: 1),
+  }) =>
+      super.ultralyticsYoloPlatform.setMemoryBudget(
+            bytes: bytes,
+            statsIntervalMs: statsInterval.inMilliseconds,
+          );
+
+  /// Keeps the recent camera frames natively so they can be saved with
+  /// [saveFrames], for example when a rule fires.
+  ///
+  /// Frames are scaled to at most [maxSide] pixels and JPEG encoded with
+  /// [quality] in the background until they take up [memoryBudget] bytes.
+  /// Pass a [memoryBudget] of 0 to disable the buffer.
+  Future<String?> setFrameBuffer({
+    int memoryBudget = 8 << 20,
+    int maxSide = 320,
+    int quality = 75,
+  }) =>
+      super.ultralyticsYoloPlatform.setFrameBuffer(
+            memoryBudget: memoryBudget,
+            maxSide: maxSide,
+            quality: quality,
+          );
+
+  /// Writes the buffered frames from the last [window] into [directory] as
+  /// JPEG files, along with a detections.csv of their detections.
+  ///
+  /// Files are written in the background. Returns the number of frames that
+  /// will be written.
+  Future<int?> saveFrames({
+    required String directory,
+    Duration window = const Duration(seconds: 5),
+  }) =>
+      super.ultralyticsYoloPlatform.saveFrames(
+            directory: directory,
+            windowMs: window.inMilliseconds,
+          );
+
+  /// Records the raw camera frames to the file at [path], or stops recording
+  /// when [path] is null.
+  ///
+  /// Recordings hold uncompressed YUV420 frames with their timestamps and can
+  /// be replayed through the native pipeline on a host with
+  /// `ultralytics_replay`, together with a detection log recorded at the same
+  /// time. Frames are dropped rather than delaying the camera when storage
+  /// cannot keep up.
+  Future<String?> setFrameRecording({String? path}) =>
+      super.ultralyticsYoloPlatform.setFrameRecording(path: path);
+
+  /// Appends every live detection natively to a binary log in [directory],
+  /// or closes the log when [directory] is null.
+  ///
+  /// The log is split into segment files of [recordsPerSegment] records, and
+  /// only the newest [maxSegments] are kept, all of them when it is 0. Read
+  /// the segments with [DetectionLogRecord.readSegment].
+  Future<String?> setDetectionLog({
+    String? directory,
+    int recordsPerSegment = 65536,
+    int maxSegments = 0,
+  }) =>
+      super.ultralyticsYoloPlatform.setDetectionLog(
+            directory: directory,
+            recordsPerSegment: recordsPerSegment,
+            maxSegments: maxSegments,
+          );
+
+  /// Decodes the model output with the native postprocessor registered as
+  /// [name], or with the built-in decoding when [name] is null.
+  ///
+  /// Postprocessors implement the C interface of
+  /// `ultralytics_postprocessor.h` and run inside the native pipeline, sharing
+  /// its scratch memory and thread pool. When [library] is given, that shared
+  /// library is loaded first and its `ultralytics_get_postprocessor` entry
+  /// point registered.
+  Future<String?> setPostprocessor({String? name, String? library}) =>
+      super.ultralyticsYoloPlatform.setPostprocessor(
+            name: name,
+            library: library,
+          );
+
+  /// Exposes the raw output tensor of live frames for custom decoding, or
+  /// stops exposing it when [enabled] is false.
+  ///
+  /// The model writes its output into native memory that the returned reader
+  /// maps without copying, so heads the built-in postprocessing does not
+  /// understand can be decoded in Dart. Android only, returns null when the
+  /// raw output is disabled or unavailable.
+  Future<RawOutputReader?> setRawOutputEnabled({bool enabled = true}) async {
+    final exchangeId = await super
+        .ultralyticsYoloPlatform
+        .setRawOutputEnabled(enabled: enabled);
+    if (exchangeId == null || exchangeId == 0) return null;
+    return RawOutputReader(exchangeId);
+  }
+
+  /// Enables or disables the per-frame [detectionResultStream].
+  ///
+  /// Rule events keep flowing on [ruleEventStream] while it is disabled.
+  void setResultStreamEnabled({required bool enabled}) {
+    super.ultralyticsYoloPlatform.setResultStreamEnabled(enabled: enabled);
+  }
+
   /// Detects objects from the given [imagePath].
   Future<List<DetectedObject?>?> detect({required String imagePath}) =>
       super.ultralyticsYoloPlatform.detectImage(imagePath);
@@ -0,0 +1,96 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+/// The raw output tensor of one live frame, viewed in place in native memory.
+///
+/// [data] is only valid until [release] is called. Release every output as
+/// soon as it is decoded, the detector skips slots that are still held.
+class RawOutput {
+  RawOutput._(this.data, this.frameId, this.timestamp, this.rows, this.cols,
+      this._token);
+
+  /// The [rows] x [cols] values of the output row by row, for YOLO detection
+  /// heads `4 + classes` rows of one value per anchor.
+  final Float32List data;
+
+  /// The id of the frame, as in the detection log.
+  final int frameId;
+
+  /// The frame timestamp in nanoseconds of the monotonic clock.
+  final int timestamp;
+
+  /// The number of rows of the output tensor.
+  final int rows;
+
+  /// The number of columns of the output tensor.
+  final int cols;
+
+  final int _token;
+  bool _released = false;
+
+  /// The value at [row], [col].
+  double at(int row, int col) => data[row * cols + col];
+
+  /// Hands the memory back to the detector. [data] must not be used after.
+  void release() {
+    if (_released) return;
+    _released = true;
+    RawOutputReader._release(_token);
+  }
+}
+
+/// Acquires the raw outputs exposed by `ObjectDetector.setRawOutputEnabled`.
+class RawOutputReader {
+  /// Creates a [RawOutputReader] for the native output exchange [exchangeId].
+  RawOutputReader(this.exchangeId);
+
+  /// The id of the native output exchange of the detector.
+  final int exchangeId;
+
+  static final DynamicLibrary _library =
+      DynamicLibrary.open('libultralytics.so');
+
+  static final _NativeOutput Function(int) _acquire = _library.lookupFunction<
+      _NativeOutput Function(Int64), _NativeOutput Function(int)>(
+    'ultralytics_output_acquire',
+  );
+
+  static final void Function(int) _release =
+      _library.lookupFunction<Void Function(Int64), void Function(int)>(
+    'ultralytics_output_release',
+  );
+
+  /// Takes the latest output published since the previous call, or returns
+  /// null if there is none.
+  RawOutput? acquire() {
+    final output = _acquire(exchangeId);
+    if (output.data == nullptr) return null;
+    return RawOutput._(
+      output.data.asTypedList(output.rows * output.cols),
+      output.frameId,
+      output.timestamp,
+      output.rows,
+      output.cols,
+      output.token,
+    );
+  }
+}
+
+final class _NativeOutput extends Struct {
+  external Pointer<Float> data;
+
+  @Int64()
+  external int token;
+
+  @Int64()
+  external int frameId;
+
+  @Int64()
+  external int timestamp;
+
+  @Int32()
+  external int rows;
+
+  @Int32()
+  external int cols;
+}
@@ -0,0 +1,72 @@
+import 'dart:ui';
+
+/// The kind of a [RuleEvent].
+enum RuleEventType {
+  /// An object entered a zone.
+  enter,
+
+  /// An object left a zone, or was lost while inside it.
+  exit,
+
+  /// An object stayed inside a zone for longer than its dwell time.
+  dwell,
+
+  /// An object crossed a line from its left side to its right side.
+  crossForward,
+
+  /// An object crossed a line from its right side to its left side.
+  crossBackward,
+}
+
+/// An event emitted when a tracked object triggers a detection rule.
+class RuleEvent {
+  /// Creates a [RuleEvent].
+  RuleEvent({
+    required this.ruleId,
+    required this.type,
+    required this.trackId,
+    required this.index,
+    required this.label,
+    required this.timestamp,
+    required this.position,
+  });
+
+  /// Creates a [RuleEvent] from a [json] object.
+  factory RuleEvent.fromJson(Map<dynamic, dynamic> json) {
+    return RuleEvent(
+      ruleId: json['ruleId'] as int,
+      type: RuleEventType.values[json['type'] as int],
+      trackId: json['trackId'] as int,
+      index: json['index'] as int,
+      label: json['label'] as String,
+      timestamp: Duration(
+        microseconds: ((json['timestamp'] as num) * 1000).round(),
+      ),
+      position: Offset(
+        (json['x'] as num).toDouble(),
+        (json['y'] as num).toDouble(),
+      ),
+    );
+  }
+
+  /// The id of the rule that was triggered.
+  final int ruleId;
+
+  /// The kind of event.
+  final RuleEventType type;
+
+  /// The id of the track that triggered the rule.
+  final int trackId;
+
+  /// The class index of the tracked object.
+  final int index;
+
+  /// The label of the tracked object.
+  final String label;
+
+  /// The monotonic timestamp of the frame the event was detected in.
+  final Duration timestamp;
+
+  /// The normalized center of the object when the event was detected.
+  final Offset position;
+}
@@ -0,0 +1,33 @@
+import 'dart:typed_data';
+import 'dart:ui';
+
+/// The recent path of a tracked object, oldest point first.
+///
+/// Points are kept in the packed form produced by the native track history,
+/// one 8 byte record per point, and decoded on access.
+class Trajectory {
+  /// Creates a [Trajectory] from packed [bytes].
+  Trajectory(Uint8List bytes) : _data = ByteData.sublistView(bytes);
+
+  static const int _recordSize = 8;
+  static const double _scale = 32767;
+
+  final ByteData _data;
+
+  /// The number of points.
+  int get length => _data.lengthInBytes ~/ _recordSize;
+
+  /// The normalized center of the object at point [i].
+  Offset pointAt(int i) => Offset(
+        _data.getInt16(i * _recordSize, Endian.host) / _scale,
+        _data.getInt16(i * _recordSize + 2, Endian.host) / _scale,
+      );
+
+  /// How long before the latest frame point [i] was recorded.
+  Duration ageAt(int i) => Duration(
+        milliseconds: _data.getUint32(i * _recordSize + 4, Endian.host),
+      );
+
+  /// All normalized points, oldest first.
+  List<Offset> get points => List.generate(length, pointAt);
+}
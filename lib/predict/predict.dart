@@ -1 +1,2 @@
 export 'predictor.dart';
+export 'startup_timings.dart';
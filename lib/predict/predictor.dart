@@ -1,3 +1,4 @@
+import 'package:ultralytics_yolo/predict/startup_timings.dart';
 import 'package:ultralytics_yolo/ultralytics_yolo_platform_interface.dart';
 import 'package:ultralytics_yolo/yolo_model.dart';
 
@@ -19,6 +20,12 @@ abstract class Predictor {
   /// The stream of the frames per second (FPS) rate.
   Stream<double>? get fpsRate => ultralyticsYoloPlatform.fpsRateStream;
 
+  /// The startup timings, sent with the first result once the camera is
+  /// bound and the model is loaded, which happen concurrently. Only sent on
+  /// Android.
+  Stream<StartupTimings>? get pipelineReady =>
+      ultralyticsYoloPlatform.pipelineReadyStream;
+
   /// Loads the model.
   Future<String?> loadModel({bool useGpu = false}) =>
       ultralyticsYoloPlatform.loadModel(model.toJson(), useGpu: useGpu);
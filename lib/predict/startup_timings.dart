@@ -0,0 +1,64 @@
+/// How long the live pipeline took to start, in milliseconds. The camera and
+/// the model come up concurrently, so the steps overlap and add up to more
+/// than [firstDetection].
+class StartupTimings {
+  /// Creates a [StartupTimings].
+  StartupTimings({
+    required this.firstDetection,
+    this.cameraReady,
+    this.modelReady,
+    this.cameraProvider,
+    this.cameraBind,
+    this.labels,
+    this.modelMap,
+    this.interpreter,
+    this.warmUp,
+  });
+
+  /// Creates a [StartupTimings] from a [json] object.
+  factory StartupTimings.fromJson(Map<dynamic, dynamic> json) {
+    double? value(String key) => (json[key] as num?)?.toDouble();
+
+    return StartupTimings(
+      firstDetection: value('firstDetection')!,
+      cameraReady: value('cameraReady'),
+      modelReady: value('modelReady'),
+      cameraProvider: value('cameraProvider'),
+      cameraBind: value('cameraBind'),
+      labels: value('labels'),
+      modelMap: value('modelMap'),
+      interpreter: value('interpreter'),
+      warmUp: value('warmUp'),
+    );
+  }
+
+  /// From the start to the first result, the time to first detection.
+  final double firstDetection;
+
+  /// From the start to the camera being bound, null when only the model was
+  /// reloaded.
+  final double? cameraReady;
+
+  /// From the start to the model being loaded and warmed up, null when only
+  /// the camera was reopened.
+  final double? modelReady;
+
+  /// Waiting for the camera provider, initialized in the background since the
+  /// plugin was attached.
+  final double? cameraProvider;
+
+  /// Binding the preview and the analysis to the camera.
+  final double? cameraBind;
+
+  /// Parsing the model metadata.
+  final double? labels;
+
+  /// Mapping the model file.
+  final double? modelMap;
+
+  /// Building the interpreter and its delegate.
+  final double? interpreter;
+
+  /// The first inference, on a blank input.
+  final double? warmUp;
+}
@@ -2,6 +2,10 @@ import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 import 'package:ultralytics_yolo/predict/classify/classification_result.dart';
 import 'package:ultralytics_yolo/predict/detect/detected_object.dart';
+import 'package:ultralytics_yolo/predict/detect/heatmap_snapshot.dart';
+import 'package:ultralytics_yolo/predict/detect/memory_stats.dart';
+import 'package:ultralytics_yolo/predict/detect/rule_event.dart';
+import 'package:ultralytics_yolo/predict/startup_timings.dart';
 
 import 'package:ultralytics_yolo/ultralytics_yolo_platform_interface.dart';
 
@@ -25,6 +29,24 @@ class PlatformChannelUltralyticsYolo implements UltralyticsYoloPlatform {
   @visibleForTesting
   final fpsRateEventChannel = const EventChannel('ultralytics_yolo_fps_rate');
 
+  /// The event channel used to stream the detection rule events
+  @visibleForTesting
+  final ruleEventChannel = const EventChannel('ultralytics_yolo_rule_events');
+
+  /// The event channel used to stream the occupancy heatmap snapshots
+  @visibleForTesting
+  final heatmapEventChannel = const EventChannel('ultralytics_yolo_heatmap');
+
+  /// The event channel used to stream the native memory stats
+  @visibleForTesting
+  final memoryStatsEventChannel =
+      const EventChannel('ultralytics_yolo_memory_stats');
+
+  /// The event channel used to stream the pipeline startup timings
+  @visibleForTesting
+  final pipelineReadyEventChannel =
+      const EventChannel('ultralytics_yolo_pipeline_ready');
+
   @override
   Future<String?> loadModel(
     Map<String, dynamic> model, {
@@ -50,6 +72,202 @@ class PlatformChannelUltralyticsYolo implements UltralyticsYoloPlatform {
   Future<String?> setNumItemsThreshold(int numItems) => methodChannel
       .invokeMethod<String>('setNumItemsThreshold', {'numItems': numItems});
 
+  @override
+  Future<String?> setRules(List<Map<String, dynamic>> rules) =>
+      methodChannel.invokeMethod<String>('setRules', {'rules': rules});
+
+  @override
+  Future<String?> setRegionsOfInterest(List<List<double>> regions) =>
+      methodChannel.invokeMethod<String>(
+        'setRegionsOfInterest',
+        {'regions': regions},
+      );
+
+  @override
+  Future<String?> setAutoCrop({
+    required bool enabled,
+    required double minScale,
+    required int refreshInterval,
+  }) =>
+      methodChannel.invokeMethod<String>('setAutoCrop', {
+        'enabled': enabled,
+        'minScale': minScale,
+        'refreshInterval': refreshInterval,
+      });
+
+  @override
+  Future<String?> setLatencyCompensation({
+    required bool enabled,
+    required Duration presentDelay,
+    required bool refreshAtDisplayRate,
+  }) =>
+      methodChannel.invokeMethod<String>('setLatencyCompensation', {
+        'enabled': enabled,
+        'presentDelayUs': presentDelay.inMicroseconds,
+        'refreshAtDisplayRate': refreshAtDisplayRate,
+      });
+
+  @override
+  Future<List<DetectedObject?>?> extrapolateDetections(
+    Duration presentDelay,
+  ) async {
+    final result = await methodChannel.invokeMethod<List<Object?>>(
+      'extrapolateDetections',
+      {'presentDelayUs': presentDelay.inMicroseconds},
+    ).catchError((_) {
+      return <DetectedObject?>[];
+    });
+
+    return [
+      for (final json in result ?? <Object?>[])
+        DetectedObject.fromJson(json! as Map),
+    ];
+  }
+
+  @override
+  Future<String?> setReidModel({
+    required String? modelPath,
+    required double threshold,
+    required int capacity,
+  }) =>
+      methodChannel.invokeMethod<String>('setReidModel', {
+        'modelPath': modelPath,
+        'threshold': threshold,
+        'capacity': capacity,
+      }).catchError((dynamic e) => e.toString());
+
+  @override
+  Future<String?> setTrackHistory({
+    required int memoryBudget,
+    required int pointsPerTrack,
+    required double epsilon,
+  }) =>
+      methodChannel.invokeMethod<String>('setTrackHistory', {
+        'memoryBudget': memoryBudget,
+        'pointsPerTrack': pointsPerTrack,
+        'epsilon': epsilon,
+      });
+
+  @override
+  Future<String?> setSmoothing({
+    required bool enabled,
+    required double minCutoff,
+    required double beta,
+    required double derivativeCutoff,
+  }) =>
+      methodChannel.invokeMethod<String>('setSmoothing', {
+        'enabled': enabled,
+        'minCutoff': minCutoff,
+        'beta': beta,
+        'derivativeCutoff': derivativeCutoff,
+      });
+
+  @override
+  Future<Uint8List?> getTrajectory({
+    required int trackId,
+    required int windowMs,
+  }) =>
+      methodChannel.invokeMethod<Uint8List>('getTrajectory', {
+        'trackId': trackId,
+        'windowMs': windowMs,
+      });
+
+  @override
+  Future<String?> setHeatmap({
+    required int width,
+    required int height,
+    required int halfLifeMs,
+    required int snapshotIntervalMs,
+  }) =>
+      methodChannel.invokeMethod<String>('setHeatmap', {
+        'width': width,
+        'height': height,
+        'halfLifeMs': halfLifeMs,
+        'snapshotIntervalMs': snapshotIntervalMs,
+      });
+
+  @override
+  Future<String?> setMemoryBudget({
+    required int bytes,
+    required int statsIntervalMs,
+  }) =>
+      methodChannel.invokeMethod<String>('setMemoryBudget', {
+        'bytes': bytes,
+        'statsIntervalMs': statsIntervalMs,
+      });
+
+  @override
+  Future<String?> setFrameBuffer({
+    required int memoryBudget,
+    required int maxSide,
+    required int quality,
+  }) =>
+      methodChannel.invokeMethod<String>('setFrameBuffer', {
+        'memoryBudget': memoryBudget,
+        'maxSide': maxSide,
+        'quality': quality,
+      });
+
+  @override
+  Future<int?> saveFrames({
+    required String directory,
+    required int windowMs,
+  }) =>
+      methodChannel.invokeMethod<int>('saveFrames', {
+        'directory': directory,
+        'windowMs': windowMs,
+      });
+
+  @override
+  Future<String?> setFrameRecording({required String? path}) => methodChannel
+      .invokeMethod<String>('setFrameRecording', {'path': path})
+      .catchError((dynamic e) => e.toString());
+
+  @override
+  Future<String?> setDetectionLog({
+    required String? directory,
+    required int recordsPerSegment,
+    required int maxSegments,
+  }) =>
+      methodChannel.invokeMethod<String>('setDetectionLog', {
+        'directory': directory,
+        'recordsPerSegment': recordsPerSegment,
+        'maxSegments': maxSegments,
+      }).catchError((dynamic e) => e.toString());
+
+  @override
+  Future<String?> setPostprocessOptions({
+    required bool perClassNms,
+    required int maxProposals,
+    required List<int>? classes,
+  }) =>
+      methodChannel.invokeMethod<String>('setPostprocessOptions', {
+        'perClassNms': perClassNms,
+        'maxProposals': maxProposals,
+        'classes': classes,
+      });
+
+  @override
+  Future<String?> setPostprocessor({String? name, String? library}) =>
+      methodChannel.invokeMethod<String>('setPostprocessor', {
+        'name': name,
+        'library': library,
+      }).catchError((dynamic e) => e.toString());
+
+  @override
+  Future<int?> setRawOutputEnabled({required bool enabled}) =>
+      methodChannel.invokeMethod<int>(
+        'setRawOutputEnabled',
+        {'enabled': enabled},
+      );
+
+  @override
+  Future<String?> setResultStreamEnabled({required bool enabled}) =>
+      methodChannel.invokeMethod<String>(
+        'setResultStreamEnabled',
+        {'enabled': enabled},
+      );
+
   @override
   Future<String?> setZoomRatio(double ratio) =>
       methodChannel.invokeMethod<String>('setZoomRatio', {'ratio': ratio});
@@ -109,6 +327,29 @@ class PlatformChannelUltralyticsYolo implements UltralyticsYoloPlatform {
         },
       );
 
+  @override
+  Stream<List<RuleEvent>>? get ruleEventStream =>
+      ruleEventChannel.receiveBroadcastStream().map(
+        (result) => [
+          for (final json in result as List) RuleEvent.fromJson(json as Map),
+        ],
+      );
+
+  @override
+  Stream<HeatmapSnapshot>? get heatmapStream => heatmapEventChannel
+      .receiveBroadcastStream()
+      .map((snapshot) => HeatmapSnapshot.fromJson(snapshot as Map));
+
+  @override
+  Stream<MemoryStats>? get memoryStatsStream => memoryStatsEventChannel
+      .receiveBroadcastStream()
+      .map((stats) => MemoryStats.fromJson(stats as Map));
+
+  @override
+  Stream<StartupTimings>? get pipelineReadyStream => pipelineReadyEventChannel
+      .receiveBroadcastStream()
+      .map((timings) => StartupTimings.fromJson(timings as Map));
+
   @override
   Stream<double>? get inferenceTimeStream => inferenceTimeEventChannel
       .receiveBroadcastStream()
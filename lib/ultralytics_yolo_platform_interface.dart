@@ -1,6 +1,12 @@
+import 'dart:typed_data';
+
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 import 'package:ultralytics_yolo/predict/classify/classification_result.dart';
 import 'package:ultralytics_yolo/predict/detect/detected_object.dart';
+import 'package:ultralytics_yolo/predict/detect/heatmap_snapshot.dart';
+import 'package:ultralytics_yolo/predict/detect/memory_stats.dart';
+import 'package:ultralytics_yolo/predict/detect/rule_event.dart';
+import 'package:ultralytics_yolo/predict/startup_timings.dart';
 import 'package:ultralytics_yolo/ultralytics_yolo_platform_channel.dart';
 
 /// The interface that implementations of ultralytics_yolo must implement.
@@ -47,6 +53,156 @@ abstract class UltralyticsYoloPlatform extends PlatformInterface {
     throw UnimplementedError('setNumItemsThreshold has not been implemented.');
   }
 
+  /// Replace the detection rules evaluated on the tracked objects.
+  Future<String?> setRules(List<Map<String, dynamic>> rules) {
+    throw UnimplementedError('setRules has not been implemented.');
+  }
+
+  /// Restrict detection to the given polygon [regions].
+  Future<String?> setRegionsOfInterest(List<List<double>> regions) {
+    throw UnimplementedError('setRegionsOfInterest has not been implemented.');
+  }
+
+  /// Enable or disable running inference on a window around tracked objects.
+  Future<String?> setAutoCrop({
+    required bool enabled,
+    required double minScale,
+    required int refreshInterval,
+  }) {
+    throw UnimplementedError('setAutoCrop has not been implemented.');
+  }
+
+  /// Enable or disable extrapolating boxes to their expected display time.
+  Future<String?> setLatencyCompensation({
+    required bool enabled,
+    required Duration presentDelay,
+    required bool refreshAtDisplayRate,
+  }) {
+    throw UnimplementedError(
+      'setLatencyCompensation has not been implemented.',
+    );
+  }
+
+  /// Get the tracked objects extrapolated to [presentDelay] from now.
+  Future<List<DetectedObject?>?> extrapolateDetections(Duration presentDelay) {
+    throw UnimplementedError(
+      'extrapolateDetections has not been implemented.',
+    );
+  }
+
+  /// Load the appearance embedding model used to re-identify tracks.
+  Future<String?> setReidModel({
+    required String? modelPath,
+    required double threshold,
+    required int capacity,
+  }) {
+    throw UnimplementedError('setReidModel has not been implemented.');
+  }
+
+  /// Configure the memory budget and simplification of the track history.
+  Future<String?> setTrackHistory({
+    required int memoryBudget,
+    required int pointsPerTrack,
+    required double epsilon,
+  }) {
+    throw UnimplementedError('setTrackHistory has not been implemented.');
+  }
+
+  /// Configure the One Euro smoothing of the reported boxes.
+  Future<String?> setSmoothing({
+    required bool enabled,
+    required double minCutoff,
+    required double beta,
+    required double derivativeCutoff,
+  }) {
+    throw UnimplementedError('setSmoothing has not been implemented.');
+  }
+
+  /// Get the packed trajectory of a track over the last [windowMs].
+  Future<Uint8List?> getTrajectory({
+    required int trackId,
+    required int windowMs,
+  }) {
+    throw UnimplementedError('getTrajectory has not been implemented.');
+  }
+
+  /// Configure the occupancy heatmap accumulated from the detections.
+  Future<String?> setHeatmap({
+    required int width,
+    required int height,
+    required int halfLifeMs,
+    required int snapshotIntervalMs,
+  }) {
+    throw UnimplementedError('setHeatmap has not been implemented.');
+  }
+
+  /// Configure the native memory budget and the memory stats interval.
+  Future<String?> setMemoryBudget({
+    required int bytes,
+    required int statsIntervalMs,
+  }) {
+    throw UnimplementedError('setMemoryBudget has not been implemented.');
+  }
+
+  /// Configure the buffer of recent camera frames kept for evidence.
+  Future<String?> setFrameBuffer({
+    required int memoryBudget,
+    required int maxSide,
+    required int quality,
+  }) {
+    throw UnimplementedError('setFrameBuffer has not been implemented.');
+  }
+
+  /// Save the buffered frames from the last [windowMs] into [directory].
+  Future<int?> saveFrames({
+    required String directory,
+    required int windowMs,
+  }) {
+    throw UnimplementedError('saveFrames has not been implemented.');
+  }
+
+  /// Start recording the raw camera frames to [path], or stop with null.
+  Future<String?> setFrameRecording({required String? path}) {
+    throw UnimplementedError('setFrameRecording has not been implemented.');
+  }
+
+  /// Open, or close with a null [directory], the native detection log.
+  Future<String?> setDetectionLog({
+    required String? directory,
+    required int recordsPerSegment,
+    required int maxSegments,
+  }) {
+    throw UnimplementedError('setDetectionLog has not been implemented.');
+  }
+
+  /// Set the NMS mode, pre-NMS proposal cap and reported classes.
+  Future<String?> setPostprocessOptions({
+    required bool perClassNms,
+    required int maxProposals,
+    required List<int>? classes,
+  }) {
+    throw UnimplementedError(
+      'setPostprocessOptions has not been implemented.',
+    );
+  }
+
+  /// Select the native postprocessor that decodes the model output.
+  Future<String?> setPostprocessor({String? name, String? library}) {
+    throw UnimplementedError('setPostprocessor has not been implemented.');
+  }
+
+  /// Enable or disable the raw output tensor exposed through dart:ffi.
+  Future<int?> setRawOutputEnabled({required bool enabled}) {
+    throw UnimplementedError('setRawOutputEnabled has not been implemented.');
+  }
+
+  /// Enable or disable the per-frame detection result stream.
+  Future<String?> setResultStreamEnabled({required bool enabled}) {
+    throw UnimplementedError(
+      'setResultStreamEnabled has not been implemented.',
+    );
+  }
+
   /// Set the zoom ratio for the camera preview.
   Future<String?> setZoomRatio(double ratio) {
     throw UnimplementedError('setZoomRatio has not been implemented.');
@@ -82,6 +238,26 @@ abstract class UltralyticsYoloPlatform extends PlatformInterface {
     throw UnimplementedError('detectionResultStream has not been implemented.');
   }
 
+  /// Stream of detection rule events.
+  Stream<List<RuleEvent>>? get ruleEventStream {
+    throw UnimplementedError('ruleEventStream has not been implemented.');
+  }
+
+  /// Stream of occupancy heatmap snapshots.
+  Stream<HeatmapSnapshot>? get heatmapStream {
+    throw UnimplementedError('heatmapStream has not been implemented.');
+  }
+
+  /// Stream of native memory stats.
+  Stream<MemoryStats>? get memoryStatsStream {
+    throw UnimplementedError('memoryStatsStream has not been implemented.');
+  }
+
+  /// Stream of the startup timings, sent once the live pipeline is ready.
+  Stream<StartupTimings>? get pipelineReadyStream {
+    throw UnimplementedError('pipelineReadyStream has not been implemented.');
+  }
+
   /// Detect objects in the given [imagePath].
   Future<List<DetectedObject?>?> detectImage(String imagePath) {
     throw UnimplementedError('detectImage has not been implemented.');